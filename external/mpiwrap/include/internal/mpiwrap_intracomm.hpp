@@ -66,6 +66,12 @@ class Intracomm : protected internal::Comm<Intracomm>
         using internal::Comm<Intracomm>::operator MPI_Comm*;
         using internal::Comm<Intracomm>::operator const MPI_Comm*;
 
+#if MPIWRAP_HAVE_MPI_WIN
+
+        using internal::Comm<Intracomm>::window;
+
+#endif
+
 #if MPIWRAP_HAVE_MPI_MESSAGE
 
         using internal::Comm<Intracomm>::Mprobe;
@@ -69,6 +69,17 @@ template<typename T> class global_ptr
             *ptr_ = p;
         }
 
+        /*
+         * Replace the pointee of all copies with p without deleting it, and
+         * return the previous pointee
+         */
+        T* exchange(T* p)
+        {
+            T* old = get();
+            *ptr_ = p;
+            return old;
+        }
+
         T* get()
         {
             return (ptr_ ? *ptr_ : nullptr);
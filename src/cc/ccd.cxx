@@ -129,8 +129,7 @@ void CCD<U>::iterate(const Arena& arena)
     /*
      *************************************************************************/
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     this->energy() = 0.25*real(scalar(H.getABIJ()*T(2)));
     this->conv() = Z.norm(00);
@@ -158,7 +157,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
@@ -13,7 +13,7 @@ namespace cc
 
 template <typename U>
 CCSD<U>::CCSD(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis"))
+: Iterative<U>(name, config), diis(config.get("diis")), diis_single(config.get("diis"))
 {
     vector<Requirement> reqs;
     reqs.push_back(Requirement("moints", "H"));
@@ -26,6 +26,33 @@ CCSD<U>::CCSD(const string& name, Config& config)
     this->addProduct(Product("ccsd.Hbar", "Hbar", reqs));
 }
 
+/*
+ * Allocate the temporaries used in iterate, in the precision of H. The
+ * single precision copies used in a mixed precision solve are told apart
+ * from the double precision ones by tag.
+ */
+template <typename U>
+template <typename V>
+void CCSD<U>::initialize(const TwoElectronOperator<V>& H, const string& tag)
+{
+    const Arena& arena = H.arena;
+
+    const Space& occ = H.occ;
+    const Space& vrt = H.vrt;
+
+    this->puttmp(  "Z"+tag, new ExcitationOperator<V,2>("Z", arena, occ, vrt));
+    this->puttmp("Tau"+tag, new SpinorbitalTensor <V  >("Tau", H.getABIJ()));
+    this->puttmp(  "D"+tag, new Denominator       <V  >(H));
+
+    this->puttmp(  "FAE"+tag, new SpinorbitalTensor<V>(    "F(ae)",   H.getAB()));
+    this->puttmp(  "FMI"+tag, new SpinorbitalTensor<V>(    "F(mi)",   H.getIJ()));
+    this->puttmp(  "FME"+tag, new SpinorbitalTensor<V>(    "F(me)",   H.getIA()));
+    this->puttmp("WMNIJ"+tag, new SpinorbitalTensor<V>( "W(mn,ij)", H.getIJKL()));
+    this->puttmp("WMNEJ"+tag, new SpinorbitalTensor<V>( "W(mn,ej)", H.getIJAK()));
+    this->puttmp("WAMIJ"+tag, new SpinorbitalTensor<V>("W~(am,ij)", H.getAIJK()));
+    this->puttmp("WAMEI"+tag, new SpinorbitalTensor<V>("W~(am,ei)", H.getAIBJ()));
+}
+
 template <typename U>
 bool CCSD<U>::run(TaskDAG& dag, const Arena& arena)
 {
@@ -34,18 +61,13 @@ bool CCSD<U>::run(TaskDAG& dag, const Arena& arena)
     const Space& occ = H.occ;
     const Space& vrt = H.vrt;
 
-    auto& T   = this->put   (  "T", new ExcitationOperator<U,2>("T", arena, occ, vrt));
-    auto& Z   = this->puttmp(  "Z", new ExcitationOperator<U,2>("Z", arena, occ, vrt));
-    auto& Tau = this->puttmp("Tau", new SpinorbitalTensor <U  >("Tau", H.getABIJ()));
-    auto& D   = this->puttmp(  "D", new Denominator       <U  >(H));
+    auto& T = this->put("T", new ExcitationOperator<U,2>("T", arena, occ, vrt));
+
+    initialize(H, "");
 
-    this->puttmp(  "FAE", new SpinorbitalTensor<U>(    "F(ae)",   H.getAB()));
-    this->puttmp(  "FMI", new SpinorbitalTensor<U>(    "F(mi)",   H.getIJ()));
-    this->puttmp(  "FME", new SpinorbitalTensor<U>(    "F(me)",   H.getIA()));
-    this->puttmp("WMNIJ", new SpinorbitalTensor<U>( "W(mn,ij)", H.getIJKL()));
-    this->puttmp("WMNEJ", new SpinorbitalTensor<U>( "W(mn,ej)", H.getIJAK()));
-    this->puttmp("WAMIJ", new SpinorbitalTensor<U>("W~(am,ij)", H.getAIJK()));
-    this->puttmp("WAMEI", new SpinorbitalTensor<U>("W~(am,ei)", H.getAIBJ()));
+    auto& Z   = this->template gettmp<ExcitationOperator<U,2>>(  "Z");
+    auto& Tau = this->template gettmp<SpinorbitalTensor <U  >>("Tau");
+    auto& D   = this->template gettmp<Denominator       <U  >>(  "D");
 
     Z(0) = (U)0.0;
     T(0) = (U)0.0;
@@ -91,34 +113,75 @@ bool CCSD<U>::run(TaskDAG& dag, const Arena& arena)
 template <typename U>
 void CCSD<U>::iterate(const Arena& arena)
 {
-    const auto& H = this->template get<TwoElectronOperator<U>>("H");
-
-    const SpinorbitalTensor<U>&   fAI =   H.getAI();
-    const SpinorbitalTensor<U>&   fME =   H.getIA();
-    const SpinorbitalTensor<U>&   fAE =   H.getAB();
-    const SpinorbitalTensor<U>&   fMI =   H.getIJ();
-    const SpinorbitalTensor<U>& VABIJ = H.getABIJ();
-    const SpinorbitalTensor<U>& VMNEF = H.getIJAB();
-    const SpinorbitalTensor<U>& VAMEF = H.getAIBC();
-    const SpinorbitalTensor<U>& VABEJ = H.getABCI();
-    const SpinorbitalTensor<U>& VABEF = H.getABCD();
-    const SpinorbitalTensor<U>& VMNIJ = H.getIJKL();
-    const SpinorbitalTensor<U>& VMNEJ = H.getIJAK();
-    const SpinorbitalTensor<U>& VAMIJ = H.getAIJK();
-    const SpinorbitalTensor<U>& VAMEI = H.getAIBJ();
-
-    auto& T   = this->template get   <ExcitationOperator<U,2>>(  "T");
-    auto& D   = this->template gettmp<Denominator       <U  >>(  "D");
-    auto& Z   = this->template gettmp<ExcitationOperator<U,2>>(  "Z");
-    auto& Tau = this->template gettmp<SpinorbitalTensor <U  >>("Tau");
+    if (this->isSinglePrecision())
+    {
+        /*
+         * The single precision copies are made on the first single
+         * precision iteration, so never when resuming in double precision
+         */
+        if (!this->hastmp("T (single)"))
+        {
+            auto& H = this->template get<TwoElectronOperator<U>>("H");
+            auto& T = this->template get<ExcitationOperator<U,2>>("T");
+
+            auto& Hs = this->puttmp("H (single)", new TwoElectronOperator<float>("H", arena, H.occ, H.vrt));
+            auto& Ts = this->puttmp("T (single)", new ExcitationOperator<float,2>("T", arena, H.occ, H.vrt));
+            Hs.convert(H);
+            Ts.convert(T);
+
+            /*
+             * The double precision operator and amplitudes are not used
+             * again until switchPrecision, so they are kept on disk until
+             * then rather than alongside the single precision copies
+             */
+            H.setStorage(ON_DISK);
+            T.setStorage(ON_DISK);
+
+            initialize(Hs, " (single)");
+        }
+
+        iterate(this->template gettmp<TwoElectronOperator<float>>("H (single)"),
+                this->template gettmp<ExcitationOperator<float,2>>("T (single)"),
+                diis_single, " (single)");
+    }
+    else
+    {
+        iterate(this->template get<TwoElectronOperator<U>>("H"),
+                this->template get<ExcitationOperator<U,2>>("T"),
+                diis, "");
+    }
+}
 
-    auto&   FME = this->template gettmp<SpinorbitalTensor<U>>(  "FME");
-    auto&   FAE = this->template gettmp<SpinorbitalTensor<U>>(  "FAE");
-    auto&   FMI = this->template gettmp<SpinorbitalTensor<U>>(  "FMI");
-    auto& WMNIJ = this->template gettmp<SpinorbitalTensor<U>>("WMNIJ");
-    auto& WMNEJ = this->template gettmp<SpinorbitalTensor<U>>("WMNEJ");
-    auto& WAMIJ = this->template gettmp<SpinorbitalTensor<U>>("WAMIJ");
-    auto& WAMEI = this->template gettmp<SpinorbitalTensor<U>>("WAMEI");
+template <typename U>
+template <typename V>
+void CCSD<U>::iterate(const TwoElectronOperator<V>& H, ExcitationOperator<V,2>& T,
+                      convergence::DIIS<ExcitationOperator<V,2>>& diis, const string& tag)
+{
+    const SpinorbitalTensor<V>&   fAI =   H.getAI();
+    const SpinorbitalTensor<V>&   fME =   H.getIA();
+    const SpinorbitalTensor<V>&   fAE =   H.getAB();
+    const SpinorbitalTensor<V>&   fMI =   H.getIJ();
+    const SpinorbitalTensor<V>& VABIJ = H.getABIJ();
+    const SpinorbitalTensor<V>& VMNEF = H.getIJAB();
+    const SpinorbitalTensor<V>& VAMEF = H.getAIBC();
+    const SpinorbitalTensor<V>& VABEJ = H.getABCI();
+    const SpinorbitalTensor<V>& VABEF = H.getABCD();
+    const SpinorbitalTensor<V>& VMNIJ = H.getIJKL();
+    const SpinorbitalTensor<V>& VMNEJ = H.getIJAK();
+    const SpinorbitalTensor<V>& VAMIJ = H.getAIJK();
+    const SpinorbitalTensor<V>& VAMEI = H.getAIBJ();
+
+    auto& D   = this->template gettmp<Denominator       <V  >>(  "D"+tag);
+    auto& Z   = this->template gettmp<ExcitationOperator<V,2>>(  "Z"+tag);
+    auto& Tau = this->template gettmp<SpinorbitalTensor <V  >>("Tau"+tag);
+
+    auto&   FME = this->template gettmp<SpinorbitalTensor<V>>(  "FME"+tag);
+    auto&   FAE = this->template gettmp<SpinorbitalTensor<V>>(  "FAE"+tag);
+    auto&   FMI = this->template gettmp<SpinorbitalTensor<V>>(  "FMI"+tag);
+    auto& WMNIJ = this->template gettmp<SpinorbitalTensor<V>>("WMNIJ"+tag);
+    auto& WMNEJ = this->template gettmp<SpinorbitalTensor<V>>("WMNEJ"+tag);
+    auto& WAMIJ = this->template gettmp<SpinorbitalTensor<V>>("WAMIJ"+tag);
+    auto& WAMEI = this->template gettmp<SpinorbitalTensor<V>>("WAMEI"+tag);
 
     Tau["abij"]  = T(2)["abij"];
     Tau["abij"] += 0.5*T(1)["ai"]*T(1)["bj"];
@@ -162,27 +225,30 @@ void CCSD<U>::iterate(const Arena& arena)
      *
      * CCSD Iteration
      */
-    Z(1)[  "ai"]  =       fAI[  "ai"];
-    Z(1)[  "ai"] +=       fAE[  "ae"]*T(1)[  "ei"];
-    Z(1)[  "ai"] -=       FMI[  "mi"]*T(1)[  "am"];
-    Z(1)[  "ai"] -=     VAMEI["amei"]*T(1)[  "em"];
-    Z(1)[  "ai"] +=       FME[  "me"]*T(2)["aeim"];
-    Z(1)[  "ai"] += 0.5*VAMEF["amef"]* Tau["efim"];
-    Z(1)[  "ai"] -= 0.5*WMNEJ["mnei"]*T(2)["eamn"];
-
-    Z(2)["abij"]  =     VABIJ["abij"];
-    Z(2)["abij"] +=     VABEJ["abej"]*T(1)[  "ei"];
-    Z(2)["abij"] -=     WAMIJ["amij"]*T(1)[  "bm"];
-    Z(2)["abij"] +=       FAE[  "ae"]*T(2)["ebij"];
-    Z(2)["abij"] -=       FMI[  "mi"]*T(2)["abmj"];
-    Z(2)["abij"] += 0.5*VABEF["abef"]* Tau["efij"];
-    Z(2)["abij"] += 0.5*WMNIJ["mnij"]* Tau["abmn"];
-    Z(2)["abij"] +=     WAMEI["amei"]*T(2)["ebjm"];
+    TensorExpression<SpinorbitalTensor<V>,V> residual;
+
+    residual(Z(1)[  "ai"])  =       fAI[  "ai"];
+    residual(Z(1)[  "ai"]) +=       fAE[  "ae"]*T(1)[  "ei"];
+    residual(Z(1)[  "ai"]) -=       FMI[  "mi"]*T(1)[  "am"];
+    residual(Z(1)[  "ai"]) -=     VAMEI["amei"]*T(1)[  "em"];
+    residual(Z(1)[  "ai"]) +=       FME[  "me"]*T(2)["aeim"];
+    residual(Z(1)[  "ai"]) += 0.5*VAMEF["amef"]* Tau["efim"];
+    residual(Z(1)[  "ai"]) -= 0.5*WMNEJ["mnei"]*T(2)["eamn"];
+
+    residual(Z(2)["abij"])  =     VABIJ["abij"];
+    residual(Z(2)["abij"]) +=     VABEJ["abej"]*T(1)[  "ei"];
+    residual(Z(2)["abij"]) -=     WAMIJ["amij"]*T(1)[  "bm"];
+    residual(Z(2)["abij"]) +=       FAE[  "ae"]*T(2)["ebij"];
+    residual(Z(2)["abij"]) -=       FMI[  "mi"]*T(2)["abmj"];
+    residual(Z(2)["abij"]) += 0.5*VABEF["abef"]* Tau["efij"];
+    residual(Z(2)["abij"]) += 0.5*WMNIJ["mnij"]* Tau["abmn"];
+    residual(Z(2)["abij"]) +=     WAMEI["amei"]*T(2)["ebjm"];
+
+    residual.evaluate();
     /*
      *************************************************************************/
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     Tau["abij"]  = T(2)["abij"];
     Tau["abij"] += 0.5*T(1)["ai"]*T(1)["bj"];
@@ -192,6 +258,64 @@ void CCSD<U>::iterate(const Arena& arena)
     diis.extrapolate(T, Z);
 }
 
+template <typename U>
+void CCSD<U>::switchPrecision(const Arena& arena)
+{
+    if (!this->hastmp("T (single)")) return;
+
+    auto& T = this->template get<ExcitationOperator<U,2>>("T");
+
+    this->template get<TwoElectronOperator<U>>("H").setStorage(IN_CORE);
+    T.setStorage(IN_CORE);
+
+    T.convert(this->template gettmp<ExcitationOperator<float,2>>("T (single)"));
+
+    this->releasetmp(" (single)");
+    diis_single.clear();
+}
+
+template <typename U>
+bool CCSD<U>::checkpoint(const string& path, const Arena& arena)
+{
+    this->template get<ExcitationOperator<U,2>>("T").save(path + ".T");
+    this->saveScalars(path, arena);
+    return true;
+}
+
+template <typename U>
+bool CCSD<U>::restore(const string& path, const Arena& arena)
+{
+    const auto& H = this->template get<TwoElectronOperator<U>>("H");
+
+    auto& T = this->put("T", new ExcitationOperator<U,2>("T", arena, H.occ, H.vrt));
+
+    if (!T.load(path + ".T") || !this->loadScalars(path, arena)) return false;
+
+    if (this->isUsed("Hbar"))
+    {
+        this->put("Hbar", new STTwoElectronOperator<U>("Hbar", H, T, true));
+    }
+
+    return true;
+}
+
+template <typename U>
+bool CCSD<U>::saveState(const string& path, const Arena& arena)
+{
+    this->template get<ExcitationOperator<U,2>>("T").save(path + ".T");
+    diis.save(path + ".diis", arena);
+    return true;
+}
+
+template <typename U>
+bool CCSD<U>::loadState(const string& path, const Arena& arena)
+{
+    auto& T = this->template get   <ExcitationOperator<U,2>>("T");
+    auto& Z = this->template gettmp<ExcitationOperator<U,2>>("Z");
+
+    return T.load(path + ".T") && diis.load(path + ".diis", arena, T, Z);
+}
+
 /*
 template <typename U>
 double CCSD<U>::getProjectedS2(const MOSpace<U>& occ, const MOSpace<U>& vrt,
@@ -272,6 +396,10 @@ max_iterations?
     int 50,
 conv_type?
     enum { MAXE, RMSE, MAE },
+mixed_precision?
+    bool false,
+single_convergence?
+    double 1e-5,
 diis?
 {
     damping?
@@ -281,7 +409,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
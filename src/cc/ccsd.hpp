@@ -22,6 +22,14 @@ class CCSD : public Iterative<U>
 {
     protected:
         convergence::DIIS<op::ExcitationOperator<U,2>> diis;
+        convergence::DIIS<op::ExcitationOperator<float,2>> diis_single;
+
+        template <typename V>
+        void initialize(const op::TwoElectronOperator<V>& H, const string& tag);
+
+        template <typename V>
+        void iterate(const op::TwoElectronOperator<V>& H, op::ExcitationOperator<V,2>& T,
+                     convergence::DIIS<op::ExcitationOperator<V,2>>& diis, const string& tag);
 
     public:
         CCSD(const string& name, input::Config& config);
@@ -30,6 +38,19 @@ class CCSD : public Iterative<U>
 
         void iterate(const Arena& arena);
 
+        bool checkpoint(const string& path, const Arena& arena);
+
+        bool restore(const string& path, const Arena& arena);
+
+    protected:
+        bool saveState(const string& path, const Arena& arena);
+
+        bool loadState(const string& path, const Arena& arena);
+
+        void switchPrecision(const Arena& arena);
+
+    public:
+
         /*
         static double getProjectedS2(const op::MOSpace<U>& occ, const op::MOSpace<U>& vrt,
                                      const tensor::SpinorbitalTensor<U>& T1,
@@ -76,14 +76,22 @@ bool CCSDIPGF<U>::run(TaskDAG& dag, const Arena& arena)
         }
     }
 
-    auto& Rr = this->puttmp("Rr", new ExcitationOperator  <U,1,2>("Rr", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& Ri = this->puttmp("Ri", new ExcitationOperator  <U,1,2>("Ri", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& Zr = this->puttmp("Zr", new ExcitationOperator  <U,1,2>("Zr", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& Zi = this->puttmp("Zi", new ExcitationOperator  <U,1,2>("Zi", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& b  = this->puttmp("b",  new ExcitationOperator  <U,1,2>("b",  arena, occ, vrt, isalpha ? -1 : 1));
-    auto& e  = this->puttmp("e",  new DeexcitationOperator<U,1,2>("e",  arena, occ, vrt, isalpha ? 1 : -1));
+    auto& R  = this->puttmp("R",  new ExcitationOperator  <CU,1,2>("R",  arena, occ, vrt, isalpha ? -1 : 1));
+    auto& Z  = this->puttmp("Z",  new ExcitationOperator  <CU,1,2>("Z",  arena, occ, vrt, isalpha ? -1 : 1));
+    auto& bc = this->puttmp("b",  new ExcitationOperator  <CU,1,2>("b",  arena, occ, vrt, isalpha ? -1 : 1));
+    auto& ec = this->puttmp("e",  new DeexcitationOperator<CU,1,2>("e",  arena, occ, vrt, isalpha ? 1 : -1));
 
-    auto& XE = this->puttmp("XE", new SpinorbitalTensor<U>("X(e)", arena, group, {vrt,occ}, {0,0}, {1,0}, isalpha ? -1 : 1));
+    this->puttmp("XE", new SpinorbitalTensor<CU>("X(e)", arena, group, {vrt,occ}, {0,0}, {1,0}, isalpha ? -1 : 1));
+
+    /*
+     * The solve is done entirely in complex arithmetic, so keep complex
+     * copies of Hbar and T
+     */
+    this->puttmp("Hbar (complex)", new TwoElectronOperator<CU>("Hbar", arena, occ, vrt)).convert(H);
+    this->puttmp("T (complex)", new ExcitationOperator<CU,2>("T", arena, occ, vrt)).convert(T);
+
+    ExcitationOperator  <U,1,2> b("b", arena, occ, vrt, isalpha ? -1 : 1);
+    DeexcitationOperator<U,1,2> e("e", arena, occ, vrt, isalpha ? 1 : -1);
 
     SpinorbitalTensor<U> Dij("D(ij)", arena, group, {vrt,occ}, {0,1}, {0,1});
     SpinorbitalTensor<U> Gijak("G(ij,ak)", arena, group, {vrt,occ}, {0,2}, {1,1});
@@ -151,23 +159,23 @@ bool CCSDIPGF<U>::run(TaskDAG& dag, const Arena& arena)
     //printf("<B|B>: %.15f\n", scalar(b*b));
     //printf("<E|B>: %.15f\n", scalar(e(1)["m"]*b(1)["m"])+0.5*scalar(e(2)["mne"]*b(2)["emn"]));
 
+    bc.convert(b);
+    ec.convert(e);
+
     auto& D = this->puttmp("D", new ComplexDenominator<U>(H));
 
     for (auto& o : omegas)
     {
-        this->puttmp("krylov", new ComplexLinearKrylov<ExcitationOperator<U,1,2>>(krylov_config, b));
+        this->puttmp("krylov", new ComplexLinearKrylov<ExcitationOperator<CU,1,2>>(krylov_config, bc));
         omega.real(-o.real());
         omega.imag( o.imag());
 
         this->log(arena) << "Computing Green's function at " << fixed << setprecision(6) << o << endl;
 
-        Rr = b;
-        Ri = 0;
-        D.weight(Rr, Ri, omega);
-        U norm = sqrt(aquarius::abs(scalar(Rr*Rr)) +
-                      aquarius::abs(scalar(Ri*Ri)));
-        Rr /= norm;
-        Ri /= norm;
+        R = bc;
+        D.weight(R, omega);
+        U norm = sqrt(aquarius::abs(R.dots(true, {&R}, false)[0]));
+        R /= (CU)norm;
 
         Iterative<CU>::run(dag, arena);
     }
@@ -178,85 +186,54 @@ bool CCSDIPGF<U>::run(TaskDAG& dag, const Arena& arena)
 template <typename U>
 void CCSDIPGF<U>::iterate(const Arena& arena)
 {
-    const auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
+    const auto& H = this->template gettmp<TwoElectronOperator<CU>>("Hbar (complex)");
 
-    const SpinorbitalTensor<U>&   FME =   H.getIA();
-    const SpinorbitalTensor<U>&   FAE =   H.getAB();
-    const SpinorbitalTensor<U>&   FMI =   H.getIJ();
-    const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
-    const SpinorbitalTensor<U>& WMNIJ = H.getIJKL();
-    const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
-    const SpinorbitalTensor<U>& WAMIJ = H.getAIJK();
-    const SpinorbitalTensor<U>& WAMEI = H.getAIBJ();
+    const SpinorbitalTensor<CU>&   FME =   H.getIA();
+    const SpinorbitalTensor<CU>&   FAE =   H.getAB();
+    const SpinorbitalTensor<CU>&   FMI =   H.getIJ();
+    const SpinorbitalTensor<CU>& WMNEF = H.getIJAB();
+    const SpinorbitalTensor<CU>& WMNIJ = H.getIJKL();
+    const SpinorbitalTensor<CU>& WMNEJ = H.getIJAK();
+    const SpinorbitalTensor<CU>& WAMIJ = H.getAIJK();
+    const SpinorbitalTensor<CU>& WAMEI = H.getAIBJ();
 
-    auto& T = this->template get<ExcitationOperator<U,2>>("T");
+    auto& T = this->template gettmp<ExcitationOperator<CU,2>>("T (complex)");
 
-    auto& XE = this->template gettmp<SpinorbitalTensor<U>>("XE");
+    auto& XE = this->template gettmp<SpinorbitalTensor<CU>>("XE");
 
     auto& D = this->template gettmp<ComplexDenominator<U>>("D");
-    auto& krylov = this->template gettmp<ComplexLinearKrylov<ExcitationOperator<U,1,2>>>("krylov");
-
-    auto& Rr = this->template gettmp<  ExcitationOperator<U,1,2>>("Rr");
-    auto& Ri = this->template gettmp<  ExcitationOperator<U,1,2>>("Ri");
-    auto& Zr = this->template gettmp<  ExcitationOperator<U,1,2>>("Zr");
-    auto& Zi = this->template gettmp<  ExcitationOperator<U,1,2>>("Zi");
-    auto& b  = this->template gettmp<  ExcitationOperator<U,1,2>>("b");
-    auto& e  = this->template gettmp<DeexcitationOperator<U,1,2>>("e");
+    auto& krylov = this->template gettmp<ComplexLinearKrylov<ExcitationOperator<CU,1,2>>>("krylov");
 
-    //printf("<Rr|Rr>: %.15f\n", scalar(Rr*Rr));
-    //printf("<Ri|Ri>: %.15f\n", scalar(Ri*Ri));
-    //printf("<Rr|Ri>: %.15f\n", scalar(Rr*Ri));
+    auto& R = this->template gettmp<  ExcitationOperator<CU,1,2>>("R");
+    auto& Z = this->template gettmp<  ExcitationOperator<CU,1,2>>("Z");
+    auto& e = this->template gettmp<DeexcitationOperator<CU,1,2>>("e");
 
-    //printf("<B|Rr>: %.15f\n", scalar(b*Rr));
-    //printf("<B|Ri>: %.15f\n", scalar(b*Ri));
+      XE[  "e"]  = -0.5*WMNEF["mnfe"]*R(2)[ "fmn"];
 
-    for (int ri: {0,1})
-    {
-        ExcitationOperator<U,1,2>& R = (ri == 0 ? Rr : Ri);
-        ExcitationOperator<U,1,2>& Z = (ri == 0 ? Zr : Zi);
-
-          XE[  "e"]  = -0.5*WMNEF["mnfe"]*R(2)[ "fmn"];
-
-        Z(1)[  "i"]  =       -FMI[  "mi"]*R(1)[   "m"];
-        Z(1)[  "i"] +=        FME[  "me"]*R(2)[ "emi"];
-        Z(1)[  "i"] -=  0.5*WMNEJ["mnei"]*R(2)[ "emn"];
+    Z(1)[  "i"]  =       -FMI[  "mi"]*R(1)[   "m"];
+    Z(1)[  "i"] +=        FME[  "me"]*R(2)[ "emi"];
+    Z(1)[  "i"] -=  0.5*WMNEJ["mnei"]*R(2)[ "emn"];
 
-        Z(2)["aij"]  =     -WAMIJ["amij"]*R(1)[   "m"];
-        Z(2)["aij"] +=        FAE[  "ae"]*R(2)[ "eij"];
-        Z(2)["aij"] -=        FMI[  "mi"]*R(2)[ "amj"];
-        Z(2)["aij"] +=         XE[   "e"]*T(2)["aeij"];
-        Z(2)["aij"] +=  0.5*WMNIJ["mnij"]*R(2)[ "amn"];
-        Z(2)["aij"] -=      WAMEI["amei"]*R(2)[ "emj"];
-    }
-
-    //printf("<Z1|Z1>: %.15f\n", scalar(Zr(1)*Zr(1)));
-    //printf("<Z2|Z2>: %.15f\n", 0.5*scalar(Zr(2)*Zr(2)));
-    //printf("<Zr|Zr>: %.15f\n", scalar(Zr*Zr));
-    //printf("<Zi|Zi>: %.15f\n", scalar(Zi*Zi));
+    Z(2)["aij"]  =     -WAMIJ["amij"]*R(1)[   "m"];
+    Z(2)["aij"] +=        FAE[  "ae"]*R(2)[ "eij"];
+    Z(2)["aij"] -=        FMI[  "mi"]*R(2)[ "amj"];
+    Z(2)["aij"] +=         XE[   "e"]*T(2)["aeij"];
+    Z(2)["aij"] +=  0.5*WMNIJ["mnij"]*R(2)[ "amn"];
+    Z(2)["aij"] -=      WAMEI["amei"]*R(2)[ "emj"];
 
     /*
      * Convert H*r to (H-w)*r
      */
-    Zr -= omega.real()*Rr;
-    Zr += omega.imag()*Ri;
-    Zi -= omega.real()*Ri;
-    Zi -= omega.imag()*Rr;
-    //Zr *= -1;
-    //Zi *= -1;
-
-    //printf("<Ur|Ur>: %.15f\n", scalar(Zr*Zr));
-    //printf("<Ui|Ui>: %.15f\n", scalar(Zi*Zi));
+    Z -= omega*R;
 
-    krylov.extrapolate(Rr, Ri, Zr, Zi, D, omega);
+    krylov.extrapolate(R, Z, D, omega);
 
-    this->conv() = max(Zr.norm(00), Zi.norm(00));
+    this->conv() = Z.norm(00);
 
-    krylov.getSolution(Zr, Zi);
+    krylov.getSolution(Z);
 
-    this->energy() = CU(    scalar(e(1)[  "m"]*Zr(1)[  "m"]) +
-                        0.5*scalar(e(2)["mne"]*Zr(2)["emn"]),
-                            scalar(e(1)[  "m"]*Zi(1)[  "m"]) +
-                        0.5*scalar(e(2)["mne"]*Zi(2)["emn"]));
+    this->energy() =     scalar(e(1)[  "m"]*Z(1)[  "m"]) +
+                     0.5*scalar(e(2)["mne"]*Z(2)["emn"]);
 }
 
 }
@@ -13,7 +13,7 @@ namespace cc
 
 template <typename U>
 CCSDT<U>::CCSDT(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis")), guess(config.get<string>("guess"))
+: Iterative<U>(name, config), diis(config.get("diis")), diis_single(config.get("diis")), guess(config.get<string>("guess"))
 {
     vector<Requirement> reqs;
     reqs.emplace_back("moints", "H");
@@ -27,6 +27,35 @@ CCSDT<U>::CCSDT(const string& name, Config& config)
     this->addProduct("ccsdt.Hbar", "Hbar", reqs);
 }
 
+/*
+ * Allocate the temporaries used in iterate, in the precision of H (see
+ * CCSD::initialize)
+ */
+template <typename U>
+template <typename V>
+void CCSDT<U>::initialize(const TwoElectronOperator<V>& H, const string& tag)
+{
+    const Arena& arena = H.arena;
+
+    const Space& occ = H.occ;
+    const Space& vrt = H.vrt;
+
+    this->puttmp(  "Z"+tag, new ExcitationOperator<V,3>("Z", arena, occ, vrt));
+    this->puttmp("Tau"+tag, new SpinorbitalTensor <V  >("Tau", H.getABIJ()));
+    this->puttmp(  "D"+tag, new Denominator       <V  >(H));
+
+    this->puttmp(  "FAE"+tag, new SpinorbitalTensor<V>(    "F(ae)",   H.getAB()));
+    this->puttmp(  "FMI"+tag, new SpinorbitalTensor<V>(    "F(mi)",   H.getIJ()));
+    this->puttmp(  "FME"+tag, new SpinorbitalTensor<V>(    "F(me)",   H.getIA()));
+    this->puttmp("WMNIJ"+tag, new SpinorbitalTensor<V>( "W(mn,ij)", H.getIJKL()));
+    this->puttmp("WMNEJ"+tag, new SpinorbitalTensor<V>( "W(mn,ej)", H.getIJAK()));
+    this->puttmp("WAMIJ"+tag, new SpinorbitalTensor<V>( "W(am,ij)", H.getAIJK()));
+    this->puttmp("WAMEI"+tag, new SpinorbitalTensor<V>( "W(am,ei)", H.getAIBJ()));
+    this->puttmp("WABEF"+tag, new SpinorbitalTensor<V>( "W(ab,ef)", H.getABCD()));
+    this->puttmp("WABEJ"+tag, new SpinorbitalTensor<V>("W~(ab,ej)", H.getABCI()));
+    this->puttmp("WAMEF"+tag, new SpinorbitalTensor<V>( "W(am,ef)", H.getAIBC()));
+}
+
 template <typename U>
 bool CCSDT<U>::run(task::TaskDAG& dag, const Arena& arena)
 {
@@ -35,21 +64,13 @@ bool CCSDT<U>::run(task::TaskDAG& dag, const Arena& arena)
     const Space& occ = H.occ;
     const Space& vrt = H.vrt;
 
-    auto& T   = this->put   (  "T", new ExcitationOperator<U,3>("T", arena, occ, vrt));
-    auto& Z   = this->puttmp(  "Z", new ExcitationOperator<U,3>("Z", arena, occ, vrt));
-    auto& Tau = this->puttmp("Tau", new SpinorbitalTensor <U  >("Tau", H.getABIJ()));
-    auto& D   = this->puttmp(  "D", new Denominator       <U  >(H));
-
-    this->puttmp(  "FAE", new SpinorbitalTensor<U>(    "F(ae)",   H.getAB()));
-    this->puttmp(  "FMI", new SpinorbitalTensor<U>(    "F(mi)",   H.getIJ()));
-    this->puttmp(  "FME", new SpinorbitalTensor<U>(    "F(me)",   H.getIA()));
-    this->puttmp("WMNIJ", new SpinorbitalTensor<U>( "W(mn,ij)", H.getIJKL()));
-    this->puttmp("WMNEJ", new SpinorbitalTensor<U>( "W(mn,ej)", H.getIJAK()));
-    this->puttmp("WAMIJ", new SpinorbitalTensor<U>( "W(am,ij)", H.getAIJK()));
-    this->puttmp("WAMEI", new SpinorbitalTensor<U>( "W(am,ei)", H.getAIBJ()));
-    this->puttmp("WABEF", new SpinorbitalTensor<U>( "W(ab,ef)", H.getABCD()));
-    this->puttmp("WABEJ", new SpinorbitalTensor<U>("W~(ab,ej)", H.getABCI()));
-    this->puttmp("WAMEF", new SpinorbitalTensor<U>( "W(am,ef)", H.getAIBC()));
+    auto& T = this->put("T", new ExcitationOperator<U,3>("T", arena, occ, vrt));
+
+    initialize(H, "");
+
+    auto& Z   = this->template gettmp<ExcitationOperator<U,3>>(  "Z");
+    auto& Tau = this->template gettmp<SpinorbitalTensor <U  >>("Tau");
+    auto& D   = this->template gettmp<Denominator       <U  >>(  "D");
 
     Z(0) = (U)0.0;
     T(0) = (U)0.0;
@@ -103,37 +124,78 @@ bool CCSDT<U>::run(task::TaskDAG& dag, const Arena& arena)
 template <typename U>
 void CCSDT<U>::iterate(const Arena& arena)
 {
-    const auto& H = this->template get<TwoElectronOperator<U>>("H");
-
-    const SpinorbitalTensor<U>&   fAI =   H.getAI();
-    const SpinorbitalTensor<U>&   fME =   H.getIA();
-    const SpinorbitalTensor<U>&   fAE =   H.getAB();
-    const SpinorbitalTensor<U>&   fMI =   H.getIJ();
-    const SpinorbitalTensor<U>& VABIJ = H.getABIJ();
-    const SpinorbitalTensor<U>& VMNEF = H.getIJAB();
-    const SpinorbitalTensor<U>& VAMEF = H.getAIBC();
-    const SpinorbitalTensor<U>& VABEJ = H.getABCI();
-    const SpinorbitalTensor<U>& VABEF = H.getABCD();
-    const SpinorbitalTensor<U>& VMNIJ = H.getIJKL();
-    const SpinorbitalTensor<U>& VMNEJ = H.getIJAK();
-    const SpinorbitalTensor<U>& VAMIJ = H.getAIJK();
-    const SpinorbitalTensor<U>& VAMEI = H.getAIBJ();
-
-    auto& T   = this->template get   <ExcitationOperator<U,3>>(  "T");
-    auto& D   = this->template gettmp<Denominator       <U  >>(  "D");
-    auto& Z   = this->template gettmp<ExcitationOperator<U,3>>(  "Z");
-    auto& Tau = this->template gettmp<SpinorbitalTensor <U  >>("Tau");
+    if (this->isSinglePrecision())
+    {
+        /*
+         * The single precision copies are made on the first single
+         * precision iteration, so never when resuming in double precision
+         */
+        if (!this->hastmp("T (single)"))
+        {
+            auto& H = this->template get<TwoElectronOperator<U>>("H");
+            auto& T = this->template get<ExcitationOperator<U,3>>("T");
+
+            auto& Hs = this->puttmp("H (single)", new TwoElectronOperator<float>("H", arena, H.occ, H.vrt));
+            auto& Ts = this->puttmp("T (single)", new ExcitationOperator<float,3>("T", arena, H.occ, H.vrt));
+            Hs.convert(H);
+            Ts.convert(T);
+
+            /*
+             * The double precision operator and amplitudes are not used
+             * again until switchPrecision, so they are kept on disk until
+             * then rather than alongside the single precision copies
+             */
+            H.setStorage(ON_DISK);
+            T.setStorage(ON_DISK);
+
+            initialize(Hs, " (single)");
+        }
+
+        iterate(this->template gettmp<TwoElectronOperator<float>>("H (single)"),
+                this->template gettmp<ExcitationOperator<float,3>>("T (single)"),
+                diis_single, " (single)");
+    }
+    else
+    {
+        iterate(this->template get<TwoElectronOperator<U>>("H"),
+                this->template get<ExcitationOperator<U,3>>("T"),
+                diis, "");
+    }
+}
 
-    auto&   FME = this->template gettmp<SpinorbitalTensor<U>>(  "FME");
-    auto&   FAE = this->template gettmp<SpinorbitalTensor<U>>(  "FAE");
-    auto&   FMI = this->template gettmp<SpinorbitalTensor<U>>(  "FMI");
-    auto& WMNIJ = this->template gettmp<SpinorbitalTensor<U>>("WMNIJ");
-    auto& WMNEJ = this->template gettmp<SpinorbitalTensor<U>>("WMNEJ");
-    auto& WAMIJ = this->template gettmp<SpinorbitalTensor<U>>("WAMIJ");
-    auto& WAMEI = this->template gettmp<SpinorbitalTensor<U>>("WAMEI");
-    auto& WABEF = this->template gettmp<SpinorbitalTensor<U>>("WABEF");
-    auto& WABEJ = this->template gettmp<SpinorbitalTensor<U>>("WABEJ");
-    auto& WAMEF = this->template gettmp<SpinorbitalTensor<U>>("WAMEF");
+template <typename U>
+template <typename V>
+void CCSDT<U>::iterate(const TwoElectronOperator<V>& H, ExcitationOperator<V,3>& T,
+                       convergence::DIIS<ExcitationOperator<V,3>>& diis, const string& tag)
+{
+    const SpinorbitalTensor<V>&   fAI =   H.getAI();
+    const SpinorbitalTensor<V>&   fME =   H.getIA();
+    const SpinorbitalTensor<V>&   fAE =   H.getAB();
+    const SpinorbitalTensor<V>&   fMI =   H.getIJ();
+    const SpinorbitalTensor<V>& VABIJ = H.getABIJ();
+    const SpinorbitalTensor<V>& VMNEF = H.getIJAB();
+    const SpinorbitalTensor<V>& VAMEF = H.getAIBC();
+    const SpinorbitalTensor<V>& VABEJ = H.getABCI();
+    const SpinorbitalTensor<V>& VABEF = H.getABCD();
+    const SpinorbitalTensor<V>& VMNIJ = H.getIJKL();
+    const SpinorbitalTensor<V>& VMNEJ = H.getIJAK();
+    const SpinorbitalTensor<V>& VAMIJ = H.getAIJK();
+    const SpinorbitalTensor<V>& VAMEI = H.getAIBJ();
+
+    auto& D   = this->template gettmp<Denominator       <V  >>(  "D");
+    auto& Z   = this->template gettmp<ExcitationOperator<V,3>>(  "Z");
+    auto& Tau = this->template gettmp<SpinorbitalTensor <V  >>("Tau"+tag);
+
+    auto&   FME = this->template gettmp<SpinorbitalTensor<V>>(  "FME");
+    auto&   FAE = this->template gettmp<SpinorbitalTensor<V>>(  "FAE");
+    auto&   FMI = this->template gettmp<SpinorbitalTensor<V>>(  "FMI");
+    auto& WMNIJ = this->template gettmp<SpinorbitalTensor<V>>("WMNIJ"+tag);
+    auto& WMNEJ = this->template gettmp<SpinorbitalTensor<V>>("WMNEJ"+tag);
+    auto& WAMIJ = this->template gettmp<SpinorbitalTensor<V>>("WAMIJ"+tag);
+    auto& WAMEI = this->template gettmp<SpinorbitalTensor<V>>("WAMEI"+tag);
+    auto& WABEF = this->template gettmp<SpinorbitalTensor<V>>("WABEF"+tag);
+    auto& WABEJ = this->template gettmp<SpinorbitalTensor<V>>("WABEJ"+tag);
+    auto& WAMEF = this->template gettmp<SpinorbitalTensor<V>>("WAMEF"+tag);
 
     Tau["abij"]  = T(2)["abij"];
     Tau["abij"] += 0.5*T(1)["ai"]*T(1)["bj"];
@@ -246,8 +308,7 @@ void CCSDT<U>::iterate(const Arena& arena)
     /*
      **************************************************************************/
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     Tau["abij"]  = T(2)["abij"];
     Tau["abij"] += 0.5*T(1)["ai"]*T(1)["bj"];
@@ -257,6 +318,22 @@ void CCSDT<U>::iterate(const Arena& arena)
     diis.extrapolate(T, Z);
 }
 
+template <typename U>
+void CCSDT<U>::switchPrecision(const Arena& arena)
+{
+    if (!this->hastmp("T (single)")) return;
+
+    auto& T = this->template get<ExcitationOperator<U,3>>("T");
+
+    this->template get<TwoElectronOperator<U>>("H").setStorage(IN_CORE);
+    T.setStorage(IN_CORE);
+
+    T.convert(this->template gettmp<ExcitationOperator<float,3>>("T (single)"));
+
+    this->releasetmp(" (single)");
+    diis_single.clear();
+}
+
 /*
 template <typename U>
 double CCSDT<U>::getProjectedS2() const
@@ -284,6 +361,10 @@ conv_type?
     enum { MAXE, RMSE, MAE },
 guess?
     enum { mp2, ccsd },
+mixed_precision?
+    bool false,
+single_convergence?
+    double 1e-5,
 diis?
 {
     damping?
@@ -293,7 +374,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
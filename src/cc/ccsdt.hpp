@@ -22,8 +22,18 @@ class CCSDT : public Iterative<U>
 {
     protected:
         convergence::DIIS<op::ExcitationOperator<U,3>> diis;
+        convergence::DIIS<op::ExcitationOperator<float,3>> diis_single;
         string guess;
 
+        template <typename V>
+        void initialize(const op::TwoElectronOperator<V>& H, const string& tag);
+
+        template <typename V>
+        void iterate(const op::TwoElectronOperator<V>& H, op::ExcitationOperator<V,3>& T,
+                     convergence::DIIS<op::ExcitationOperator<V,3>>& diis, const string& tag);
+
+        void switchPrecision(const Arena& arena);
+
     public:
         CCSDT(const string& name, input::Config& config);
 
@@ -76,18 +76,26 @@ bool CCSDTIPGF<U>::run(TaskDAG& dag, const Arena& arena)
         }
     }
 
-    auto& Rr = this->puttmp("Rr", new ExcitationOperator  <U,2,3>("Rr", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& Ri = this->puttmp("Ri", new ExcitationOperator  <U,2,3>("Ri", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& Zr = this->puttmp("Zr", new ExcitationOperator  <U,2,3>("Zr", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& Zi = this->puttmp("Zi", new ExcitationOperator  <U,2,3>("Zi", arena, occ, vrt, isalpha ? -1 : 1));
-    auto& b  = this->puttmp("b",  new ExcitationOperator  <U,2,3>("b",  arena, occ, vrt, isalpha ? -1 : 1));
-    auto& e  = this->puttmp("e",  new DeexcitationOperator<U,2,3>("e",  arena, occ, vrt, isalpha ? 1 : -1));
-
-    auto& XE   = this->puttmp("XE",   new SpinorbitalTensor<U>("X(e)",    arena, group, {vrt,occ}, {0,0}, {1,0}, isalpha ? -1 : 1));
-    auto& XMIJ = this->puttmp("XMIJ", new SpinorbitalTensor<U>("X(m,ij)", arena, group, {vrt,occ}, {0,1}, {0,2}, isalpha ? -1 : 1));
-    auto& XAEI = this->puttmp("XAEI", new SpinorbitalTensor<U>("X(a,ei)", arena, group, {vrt,occ}, {1,0}, {1,1}, isalpha ? -1 : 1));
-    auto& XMEI = this->puttmp("XMEI", new SpinorbitalTensor<U>("X(m,ei)", arena, group, {vrt,occ}, {0,1}, {1,1}, isalpha ? -1 : 1));
-    auto& XAEF = this->puttmp("XAEF", new SpinorbitalTensor<U>("X(a,ef)", arena, group, {vrt,occ}, {1,0}, {2,0}, isalpha ? -1 : 1));
+    auto& R  = this->puttmp("R",  new ExcitationOperator  <CU,2,3>("R",  arena, occ, vrt, isalpha ? -1 : 1));
+    auto& Z  = this->puttmp("Z",  new ExcitationOperator  <CU,2,3>("Z",  arena, occ, vrt, isalpha ? -1 : 1));
+    auto& bc = this->puttmp("b",  new ExcitationOperator  <CU,2,3>("b",  arena, occ, vrt, isalpha ? -1 : 1));
+    auto& ec = this->puttmp("e",  new DeexcitationOperator<CU,2,3>("e",  arena, occ, vrt, isalpha ? 1 : -1));
+
+    this->puttmp("XE",   new SpinorbitalTensor<CU>("X(e)",    arena, group, {vrt,occ}, {0,0}, {1,0}, isalpha ? -1 : 1));
+    this->puttmp("XMIJ", new SpinorbitalTensor<CU>("X(m,ij)", arena, group, {vrt,occ}, {0,1}, {0,2}, isalpha ? -1 : 1));
+    this->puttmp("XAEI", new SpinorbitalTensor<CU>("X(a,ei)", arena, group, {vrt,occ}, {1,0}, {1,1}, isalpha ? -1 : 1));
+    this->puttmp("XMEI", new SpinorbitalTensor<CU>("X(m,ei)", arena, group, {vrt,occ}, {0,1}, {1,1}, isalpha ? -1 : 1));
+    this->puttmp("XAEF", new SpinorbitalTensor<CU>("X(a,ef)", arena, group, {vrt,occ}, {1,0}, {2,0}, isalpha ? -1 : 1));
+
+    /*
+     * The solve is done entirely in complex arithmetic, so keep complex
+     * copies of Hbar and T
+     */
+    this->puttmp("Hbar (complex)", new TwoElectronOperator<CU>("Hbar", arena, occ, vrt)).convert(H);
+    this->puttmp("T (complex)", new ExcitationOperator<CU,3>("T", arena, occ, vrt)).convert(T);
+
+    ExcitationOperator  <U,2,3> b("b", arena, occ, vrt, isalpha ? -1 : 1);
+    DeexcitationOperator<U,2,3> e("e", arena, occ, vrt, isalpha ? 1 : -1);
 
     SpinorbitalTensor<U> Dij    ("D(ij)",      arena, group, {vrt,occ}, {0,1}, {0,1});
     SpinorbitalTensor<U> Gijak  ("G(ij,ak)",   arena, group, {vrt,occ}, {0,2}, {1,1});
@@ -169,23 +177,23 @@ bool CCSDTIPGF<U>::run(TaskDAG& dag, const Arena& arena)
     //                         (1.0/ 2.0)*scalar(e(2)[  "mne"]*b(2)[  "emn"]) +
     //                         (1.0/12.0)*scalar(e(3)["mnoef"]*b(3)["efmno"]));
 
+    bc.convert(b);
+    ec.convert(e);
+
     auto& D = this->puttmp("D", new ComplexDenominator<U>(H));
 
     for (auto& o : omegas)
     {
-        this->puttmp("krylov", new ComplexLinearKrylov<ExcitationOperator<U,2,3>>(krylov_config, b));
+        this->puttmp("krylov", new ComplexLinearKrylov<ExcitationOperator<CU,2,3>>(krylov_config, bc));
         omega.real(-o.real());
         omega.imag( o.imag());
 
         this->log(arena) << "Computing Green's function at " << fixed << setprecision(6) << o << endl;
 
-        Rr = b;
-        Ri = 0;
-        D.weight(Rr, Ri, omega);
-        U norm = sqrt(aquarius::abs(scalar(Rr*Rr)) +
-                      aquarius::abs(scalar(Ri*Ri)));
-        Rr /= norm;
-        Ri /= norm;
+        R = bc;
+        D.weight(R, omega);
+        U norm = sqrt(aquarius::abs(R.dots(true, {&R}, false)[0]));
+        R /= (CU)norm;
 
         Iterative<CU>::run(dag, arena);
     }
@@ -196,126 +204,94 @@ bool CCSDTIPGF<U>::run(TaskDAG& dag, const Arena& arena)
 template <typename U>
 void CCSDTIPGF<U>::iterate(const Arena& arena)
 {
-    const auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
-
-    const SpinorbitalTensor<U>&   FME =   H.getIA();
-    const SpinorbitalTensor<U>&   FAE =   H.getAB();
-    const SpinorbitalTensor<U>&   FMI =   H.getIJ();
-    const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
-    const SpinorbitalTensor<U>& WAMEF = H.getAIBC();
-    const SpinorbitalTensor<U>& WABEJ = H.getABCI();
-    const SpinorbitalTensor<U>& WABEF = H.getABCD();
-    const SpinorbitalTensor<U>& WMNIJ = H.getIJKL();
-    const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
-    const SpinorbitalTensor<U>& WAMIJ = H.getAIJK();
-    const SpinorbitalTensor<U>& WAMEI = H.getAIBJ();
-
-    auto& T = this->template get<ExcitationOperator<U,3>>("T");
-
-    auto& XE   = this->template gettmp<SpinorbitalTensor<U>>("XE");
-    auto& XMIJ = this->template gettmp<SpinorbitalTensor<U>>("XMIJ");
-    auto& XAEI = this->template gettmp<SpinorbitalTensor<U>>("XAEI");
-    auto& XMEI = this->template gettmp<SpinorbitalTensor<U>>("XMEI");
-    auto& XAEF = this->template gettmp<SpinorbitalTensor<U>>("XAEF");
+    const auto& H = this->template gettmp<TwoElectronOperator<CU>>("Hbar (complex)");
+
+    const SpinorbitalTensor<CU>&   FME =   H.getIA();
+    const SpinorbitalTensor<CU>&   FAE =   H.getAB();
+    const SpinorbitalTensor<CU>&   FMI =   H.getIJ();
+    const SpinorbitalTensor<CU>& WMNEF = H.getIJAB();
+    const SpinorbitalTensor<CU>& WAMEF = H.getAIBC();
+    const SpinorbitalTensor<CU>& WABEJ = H.getABCI();
+    const SpinorbitalTensor<CU>& WABEF = H.getABCD();
+    const SpinorbitalTensor<CU>& WMNIJ = H.getIJKL();
+    const SpinorbitalTensor<CU>& WMNEJ = H.getIJAK();
+    const SpinorbitalTensor<CU>& WAMIJ = H.getAIJK();
+    const SpinorbitalTensor<CU>& WAMEI = H.getAIBJ();
+
+    auto& T = this->template gettmp<ExcitationOperator<CU,3>>("T (complex)");
+
+    auto& XE   = this->template gettmp<SpinorbitalTensor<CU>>("XE");
+    auto& XMIJ = this->template gettmp<SpinorbitalTensor<CU>>("XMIJ");
+    auto& XAEI = this->template gettmp<SpinorbitalTensor<CU>>("XAEI");
+    auto& XMEI = this->template gettmp<SpinorbitalTensor<CU>>("XMEI");
+    auto& XAEF = this->template gettmp<SpinorbitalTensor<CU>>("XAEF");
 
     auto& D = this->template gettmp<ComplexDenominator<U>>("D");
-    auto& krylov = this->template gettmp<ComplexLinearKrylov<ExcitationOperator<U,2,3>>>("krylov");
-
-    auto& Rr = this->template gettmp<  ExcitationOperator<U,2,3>>("Rr");
-    auto& Ri = this->template gettmp<  ExcitationOperator<U,2,3>>("Ri");
-    auto& Zr = this->template gettmp<  ExcitationOperator<U,2,3>>("Zr");
-    auto& Zi = this->template gettmp<  ExcitationOperator<U,2,3>>("Zi");
-    auto& b  = this->template gettmp<  ExcitationOperator<U,2,3>>("b");
-    auto& e  = this->template gettmp<DeexcitationOperator<U,2,3>>("e");
-
-    //printf("<Rr|Rr>: %.15f\n", scalar(Rr*Rr));
-    //printf("<Ri|Ri>: %.15f\n", scalar(Ri*Ri));
-    //printf("<Rr|Ri>: %.15f\n", scalar(Rr*Ri));
-
-    //printf("<B|Rr>: %.15f\n", scalar(b*Rr));
-    //printf("<B|Ri>: %.15f\n", scalar(b*Ri));
-
-    for (int ri: {0,1})
-    {
-        ExcitationOperator<U,2,3>& R = (ri == 0 ? Rr : Ri);
-        ExcitationOperator<U,2,3>& Z = (ri == 0 ? Zr : Zi);
-
-          XE[    "e"]  = -0.5*WMNEF["mnfe"]*R(2)[   "fmn"];
-
-        XMIJ[  "mij"]  =     -WMNIJ["mnij"]*R(1)[     "n"];
-        XMIJ[  "mij"] +=      WMNEJ["nmei"]*R(2)[   "enj"];
-        XMIJ[  "mij"] +=  0.5*WMNEF["mnef"]*R(3)[ "efinj"];
-
-        XAEI[  "aei"]  =     -WAMEI["amei"]*R(1)[     "m"];
-        XAEI[  "aei"] +=      WAMEF["amef"]*R(2)[   "fmi"];
-        XAEI[  "aei"] +=  0.5*WMNEJ["mnei"]*R(2)[   "amn"];
-        XAEI[  "aei"] -=  0.5*WMNEF["mnef"]*R(3)[ "afmni"];
-
-        XMEI[  "mei"]  =     -WMNEJ["mnei"]*R(1)[     "n"];
-        XMEI[  "mei"] +=      WMNEF["mnef"]*R(2)[   "fni"];
-
-        XAEF[  "aef"]  =     -WAMEF["amef"]*R(1)[     "m"];
-        XAEF[  "aef"] +=  0.5*WMNEF["mnef"]*R(2)[   "amn"];
-
-        Z(1)[    "i"]  =       -FMI[  "mi"]*R(1)[     "m"];
-        Z(1)[    "i"] +=        FME[  "me"]*R(2)[   "emi"];
-        Z(1)[    "i"] -=  0.5*WMNEJ["mnei"]*R(2)[   "emn"];
-        Z(1)[    "i"] += 0.25*WMNEF["mnef"]*R(3)[ "efmni"];
-
-        Z(2)[  "aij"]  =     -WAMIJ["amij"]*R(1)[     "m"];
-        Z(2)[  "aij"] +=        FAE[  "ae"]*R(2)[   "eij"];
-        Z(2)[  "aij"] -=        FMI[  "mi"]*R(2)[   "amj"];
-        Z(2)[  "aij"] +=  0.5*WMNIJ["mnij"]*R(2)[   "amn"];
-        Z(2)[  "aij"] -=      WAMEI["amei"]*R(2)[   "emj"];
-        Z(2)[  "aij"] +=         XE[   "e"]*T(2)[  "aeij"];
-        Z(2)[  "aij"] +=        FME[  "me"]*R(3)[ "eamij"];
-        Z(2)[  "aij"] +=  0.5*WAMEF["amef"]*R(3)[ "efimj"];
-        Z(2)[  "aij"] -=  0.5*WMNEJ["mnej"]*R(3)[ "aeimn"];
-
-        Z(3)["abijk"]  =      WABEJ["abej"]*R(2)[   "eik"];
-        Z(3)["abijk"] -=      WAMIJ["amij"]*R(2)[   "bmk"];
-        Z(3)["abijk"] -=       XMIJ[ "mik"]*T(2)[  "abmj"];
-        Z(3)["abijk"] -=       XAEI[ "aei"]*T(2)[  "bejk"];
-        Z(3)["abijk"] +=        FAE[  "ae"]*R(3)[ "ebijk"];
-        Z(3)["abijk"] -=        FMI[  "mi"]*R(3)[ "abmjk"];
-        Z(3)["abijk"] -=      WAMEI["amei"]*R(3)[ "ebmjk"];
-        Z(3)["abijk"] +=  0.5*WABEF["abef"]*R(3)[ "efijk"];
-        Z(3)["abijk"] +=  0.5*WMNIJ["mnij"]*R(3)[ "abmnk"];
-        Z(3)["abijk"] +=         XE[   "e"]*T(3)["abeijk"];
-        Z(3)["abijk"] +=       XMEI[ "mek"]*T(3)["abeijm"];
-        Z(3)["abijk"] +=   0.5*XAEF[ "bef"]*T(3)["aefijk"];
-    }
-
-    //printf("<Z1|Z1>: %.15f\n", scalar(Zr(1)*Zr(1)));
-    //printf("<Z2|Z2>: %.15f\n", 0.5*scalar(Zr(2)*Zr(2)));
-    //printf("<Zr|Zr>: %.15f\n", scalar(Zr*Zr));
-    //printf("<Zi|Zi>: %.15f\n", scalar(Zi*Zi));
+    auto& krylov = this->template gettmp<ComplexLinearKrylov<ExcitationOperator<CU,2,3>>>("krylov");
+
+    auto& R = this->template gettmp<  ExcitationOperator<CU,2,3>>("R");
+    auto& Z = this->template gettmp<  ExcitationOperator<CU,2,3>>("Z");
+    auto& e = this->template gettmp<DeexcitationOperator<CU,2,3>>("e");
+
+      XE[    "e"]  = -0.5*WMNEF["mnfe"]*R(2)[   "fmn"];
+
+    XMIJ[  "mij"]  =     -WMNIJ["mnij"]*R(1)[     "n"];
+    XMIJ[  "mij"] +=      WMNEJ["nmei"]*R(2)[   "enj"];
+    XMIJ[  "mij"] +=  0.5*WMNEF["mnef"]*R(3)[ "efinj"];
+
+    XAEI[  "aei"]  =     -WAMEI["amei"]*R(1)[     "m"];
+    XAEI[  "aei"] +=      WAMEF["amef"]*R(2)[   "fmi"];
+    XAEI[  "aei"] +=  0.5*WMNEJ["mnei"]*R(2)[   "amn"];
+    XAEI[  "aei"] -=  0.5*WMNEF["mnef"]*R(3)[ "afmni"];
+
+    XMEI[  "mei"]  =     -WMNEJ["mnei"]*R(1)[     "n"];
+    XMEI[  "mei"] +=      WMNEF["mnef"]*R(2)[   "fni"];
+
+    XAEF[  "aef"]  =     -WAMEF["amef"]*R(1)[     "m"];
+    XAEF[  "aef"] +=  0.5*WMNEF["mnef"]*R(2)[   "amn"];
+
+    Z(1)[    "i"]  =       -FMI[  "mi"]*R(1)[     "m"];
+    Z(1)[    "i"] +=        FME[  "me"]*R(2)[   "emi"];
+    Z(1)[    "i"] -=  0.5*WMNEJ["mnei"]*R(2)[   "emn"];
+    Z(1)[    "i"] += 0.25*WMNEF["mnef"]*R(3)[ "efmni"];
+
+    Z(2)[  "aij"]  =     -WAMIJ["amij"]*R(1)[     "m"];
+    Z(2)[  "aij"] +=        FAE[  "ae"]*R(2)[   "eij"];
+    Z(2)[  "aij"] -=        FMI[  "mi"]*R(2)[   "amj"];
+    Z(2)[  "aij"] +=  0.5*WMNIJ["mnij"]*R(2)[   "amn"];
+    Z(2)[  "aij"] -=      WAMEI["amei"]*R(2)[   "emj"];
+    Z(2)[  "aij"] +=         XE[   "e"]*T(2)[  "aeij"];
+    Z(2)[  "aij"] +=        FME[  "me"]*R(3)[ "eamij"];
+    Z(2)[  "aij"] +=  0.5*WAMEF["amef"]*R(3)[ "efimj"];
+    Z(2)[  "aij"] -=  0.5*WMNEJ["mnej"]*R(3)[ "aeimn"];
+
+    Z(3)["abijk"]  =      WABEJ["abej"]*R(2)[   "eik"];
+    Z(3)["abijk"] -=      WAMIJ["amij"]*R(2)[   "bmk"];
+    Z(3)["abijk"] -=       XMIJ[ "mik"]*T(2)[  "abmj"];
+    Z(3)["abijk"] -=       XAEI[ "aei"]*T(2)[  "bejk"];
+    Z(3)["abijk"] +=        FAE[  "ae"]*R(3)[ "ebijk"];
+    Z(3)["abijk"] -=        FMI[  "mi"]*R(3)[ "abmjk"];
+    Z(3)["abijk"] -=      WAMEI["amei"]*R(3)[ "ebmjk"];
+    Z(3)["abijk"] +=  0.5*WABEF["abef"]*R(3)[ "efijk"];
+    Z(3)["abijk"] +=  0.5*WMNIJ["mnij"]*R(3)[ "abmnk"];
+    Z(3)["abijk"] +=         XE[   "e"]*T(3)["abeijk"];
+    Z(3)["abijk"] +=       XMEI[ "mek"]*T(3)["abeijm"];
+    Z(3)["abijk"] +=   0.5*XAEF[ "bef"]*T(3)["aefijk"];
 
     /*
      * Convert H*r to (H-w)*r
      */
-    Zr -= omega.real()*Rr;
-    Zr += omega.imag()*Ri;
-    Zi -= omega.real()*Ri;
-    Zi -= omega.imag()*Rr;
-    //Zr *= -1;
-    //Zi *= -1;
-
-    //printf("<Ur|Ur>: %.15f\n", scalar(Zr*Zr));
-    //printf("<Ui|Ui>: %.15f\n", scalar(Zi*Zi));
+    Z -= omega*R;
 
-    krylov.extrapolate(Rr, Ri, Zr, Zi, D, omega);
+    krylov.extrapolate(R, Z, D, omega);
 
-    this->conv() = max(Zr.norm(00), Zi.norm(00));
+    this->conv() = Z.norm(00);
 
-    krylov.getSolution(Zr, Zi);
+    krylov.getSolution(Z);
 
-    this->energy() = CU(           scalar(e(1)[    "m"]*Zr(1)[    "m"]) +
-                        (1.0/ 2.0)*scalar(e(2)[  "mne"]*Zr(2)[  "emn"]) +
-                        (1.0/12.0)*scalar(e(3)["mnoef"]*Zr(3)["efmno"]),
-                                   scalar(e(1)[    "m"]*Zi(1)[    "m"]) +
-                        (1.0/ 2.0)*scalar(e(2)[  "mne"]*Zi(2)[  "emn"]) +
-                        (1.0/12.0)*scalar(e(3)["mnoef"]*Zi(3)["efmno"]));
+    this->energy() =            scalar(e(1)[    "m"]*Z(1)[    "m"]) +
+                     (1.0/ 2.0)*scalar(e(2)[  "mne"]*Z(2)[  "emn"]) +
+                     (1.0/12.0)*scalar(e(3)["mnoef"]*Z(3)["efmno"]);
 }
 
 }
@@ -323,8 +323,7 @@ void CCSDTQ<U>::iterate(const Arena& arena)
     /*
      **************************************************************************/
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     Tau["abij"]  = T(2)["abij"];
     Tau["abij"] += 0.5*T(1)["ai"]*T(1)["bj"];
@@ -370,7 +369,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
@@ -1110,7 +1110,9 @@ scf?
         order?
             int 6,
         jacobi?
-            bool false
+            bool false,
+        history?
+            enum { memory, single, disk }
     }
 },
 *+
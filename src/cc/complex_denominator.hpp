@@ -31,33 +31,30 @@ class ComplexDenominator : op::Denominator<T>
         : op::Denominator<T>(F) {}
 
         template <int np, int nh>
-        void weight(op::ExcitationOperator<T,np,nh>& R,
-                    op::ExcitationOperator<T,np,nh>& I, const complex<T>& omega) const
+        void weight(op::ExcitationOperator<complex<T>,np,nh>& R, const complex<T>& omega) const
         {
             for (int ex = abs(np-nh);ex <= max(np,nh);ex++)
             {
-                weight(R(ex), I(ex), omega);
+                weight(R(ex), omega);
             }
         }
 
         template <int np, int nh>
-        void weight(op::DeexcitationOperator<T,np,nh>& R,
-                    op::DeexcitationOperator<T,np,nh>& I, const complex<T>& omega) const
+        void weight(op::DeexcitationOperator<complex<T>,np,nh>& R, const complex<T>& omega) const
         {
             for (int ex = abs(np-nh);ex <= max(np,nh);ex++)
             {
-                weight(R(ex), I(ex), omega);
+                weight(R(ex), omega);
             }
         }
 
-        void weight(tensor::SpinorbitalTensor<T>& R,
-                    tensor::SpinorbitalTensor<T>& I, const complex<T>& omega) const
+        /*
+         * Divide each element of R by D+omega
+         */
+        void weight(tensor::SpinorbitalTensor<complex<T>>& R, const complex<T>& omega) const
         {
             using namespace tensor;
 
-            T omega2 = omega.real()*omega.real() +
-                       omega.imag()+omega.imag();
-
             const vector<int>& nout = R.getNumOut();
             const vector<int>& nin = R.getNumIn();
             int spin = R.getSpin();
@@ -92,23 +89,16 @@ class ComplexDenominator : op::Denominator<T>
                         for (int i = 0;i <  nin[1]-nJ;i++) dens.push_back(&di);
 
                         vector<int> sym(ndim);
-                        vector<tkv_pair<T>> pairsr;
-                        vector<tkv_pair<T>> pairsi;
+                        vector<tkv_pair<complex<T>>> pairs;
                         for (bool done = false;!done;)
                         {
                             if (R({nA,nI},{nB,nJ}).exists(sym))
                             {
-                                R({nA,nI},{nB,nJ})(sym).getLocalData(pairsr);
-                                I({nA,nI},{nB,nJ})(sym).getLocalData(pairsi);
-                                assert(pairsr.size() == pairsi.size());
-
-                                sort(pairsr);
-                                sort(pairsi);
+                                R({nA,nI},{nB,nJ})(sym).getLocalData(pairs);
 
-                                for (int64_t i = 0;i < pairsr.size();i++)
+                                for (int64_t i = 0;i < pairs.size();i++)
                                 {
-                                    int64_t k = pairsr[i].k;
-                                    assert(k == pairsi[i].k);
+                                    int64_t k = pairs[i].k;
 
                                     T den = T();
                                     for (int j = 0;j < ndim;j++)
@@ -119,16 +109,10 @@ class ComplexDenominator : op::Denominator<T>
                                         den += dens[j][sym[j]][idx];
                                     }
 
-                                    T num = den+omega.real();
-                                    den = num*num+omega.imag()*omega.imag();
-                                    T re = pairsr[i].d;
-                                    T im = pairsi[i].d;
-                                    pairsr[i].d = (num*re+omega.imag()*im)/den;
-                                    pairsi[i].d = (num*im-omega.imag()*re)/den;
+                                    pairs[i].d /= den+omega;
                                 }
 
-                                R({nA,nI},{nB,nJ})(sym).writeRemoteData(pairsr);
-                                I({nA,nI},{nB,nJ})(sym).writeRemoteData(pairsi);
+                                R({nA,nI},{nB,nJ})(sym).writeRemoteData(pairs);
                             }
 
                             for (int i = 0;i < ndim;i++)
@@ -149,39 +149,75 @@ bool EOMEECCSD<U>::run(TaskDAG& dag, const Arena& arena)
             if (multiroot)
             {
                 /*
-                for (int j = 0;j < root_idx[i].size();j++)
+                 * Solve for all of the roots of this irrep and spin together,
+                 * so that the sigma vectors are built in one batch per
+                 * iteration and the corrections are orthogonalized together
+                 */
+                vector<int> which;
+                for (auto& root : roots)
+                {
+                    if (spin != get<1>(root)) continue;
+                    if (irrep != get<2>(root)) continue;
+
+                    Logger::log(arena) << "Starting root number " << (idx+which.size()) << endl;
+                    Logger::log(arena) << "Guess energy: " << fixed << setprecision(12) << get<0>(root) << endl;
+
+                    which.push_back(get<3>(root));
+                }
+
+                if (which.empty()) continue;
+
+                if (triplet)
                 {
-                    Rs.emplace_back("R", arena, occ, vrt, group.getIrrep(i));
-                    Zs.emplace_back("Z", arena, occ, vrt, group.getIrrep(i));
+                    Logger::log(arena) << "Triplet initial guesses" << endl;
+                }
+                else
+                {
+                    Logger::log(arena)<< "Singlet initial guesses" << endl;
+                }
+
+                this->puttmp("XMI", new SpinorbitalTensor<U>("X(mi)", arena, group, group.getIrrep(irrep), {vrt,occ}, {0,1}, {0,1}));
+                this->puttmp("XAE", new SpinorbitalTensor<U>("X(ae)", arena, group, group.getIrrep(irrep), {vrt,occ}, {1,0}, {1,0}));
+
+                for (int j : which)
+                {
+                    Rs.emplace_back("R", arena, occ, vrt, group.getIrrep(irrep));
+                    Zs.emplace_back("Z", arena, occ, vrt, group.getIrrep(irrep));
+
                     ExcitationOperator<U,2>& R = Rs.back();
                     R(0) = 0;
-                    R(1) = TDAevecs[i][root_idx[i][j]];
+                    R(1) = TDAevecs[irrep][j];
                     R(2) = 0;
                 }
 
                 auto& davidson = this->puttmp("Davidson",
-                    new Davidson<ExcitationOperator<U,2>>(davidson_config, (int)root_idx[i].size()));
-
-                previous.assign(root_idx[i].size(), numeric_limits<U>::max());
+                    new Davidson<ExcitationOperator<U,2>>(davidson_config, (int)which.size()));
 
-                Iterative<U>::run(dag, arena, root_idx[i].size());
-                */
+                previous.assign(which.size(), numeric_limits<U>::max());
 
-                //TODO: cleanup and retest
-                assert(0);
+                Iterative<U>::run(dag, arena, which.size());
 
-                /*
-                for (int j = 0;j < root_idx[i].size();j++)
+                for (int j = 0;j < which.size();j++)
                 {
-                    if (this->isConverged(j))
+                    if (!this->isConverged(j))
                     {
-                        Vs.emplace_back("V", arena, occ, vrt, group.getIrrep(i));
-                        ExcitationOperator<U,2>& V = Vs.back();
-                        davidson.getSolution(j, V);
-                        V /= sqrt(aquarius::abs(scalar(conj(V)*V)));
+                        this->error(arena) << "Root " << idx << " did not converge." << endl;
                     }
+
+                    ExcitationOperator<U,2>& R = Rs[j];
+                    davidson.getSolution(j, R);
+                    bool temp = scalar(R(1)({1,0},{0,1})*R(1)({0,0},{0,0})) < 0;
+                    if (temp)
+                        this->log(arena) << "triplet solution found!" << endl;
+                    else
+                        this->log(arena) << "singlet solution found!" << endl;
+                    if (triplet != temp)
+                    {
+                        this->log(arena) << "WARNING: Spin character different from initial guess!" << endl;
+                    }
+
+                    idx++;
                 }
-                */
             }
             else
             {
@@ -357,20 +393,35 @@ void EOMEECCSD<U>::iterate(const Arena& arena)
         Z(1)[  "ai"] -=       FMI[  "mi"]*R(1)[  "am"];
         Z(1)[  "ai"] -=     WAMEI["amei"]*R(1)[  "em"];
         Z(1)[  "ai"] +=       FME[  "me"]*R(2)["aeim"];
-        Z(1)[  "ai"] += 0.5*WAMEF["amef"]*R(2)["efim"];
         Z(1)[  "ai"] -= 0.5*WMNEJ["mnei"]*R(2)["eamn"];
 
-        Z(2)["abij"]  =     WABEJ["abej"]*R(1)[  "ei"];
+        Z(2)["abij"]  =       FAE[  "ae"]*R(2)["ebij"];
         Z(2)["abij"] -=     WAMIJ["amij"]*R(1)[  "bm"];
-        Z(2)["abij"] +=       FAE[  "ae"]*R(2)["ebij"];
         Z(2)["abij"] -=       FMI[  "mi"]*R(2)["abmj"];
         Z(2)["abij"] +=       XAE[  "ae"]*T(2)["ebij"];
         Z(2)["abij"] -=       XMI[  "mi"]*T(2)["abmj"];
         Z(2)["abij"] += 0.5*WMNIJ["mnij"]*R(2)["abmn"];
-        Z(2)["abij"] += 0.5*WABEF["abef"]*R(2)["efij"];
         Z(2)["abij"] -=     WAMEI["amei"]*R(2)["ebmj"];
     }
 
+    /*
+     * The terms with three or four virtual indices on Hbar are done for all
+     * roots at once, so that each of these is only read once per iteration
+     */
+    vector<const SpinorbitalTensor<U>*> R1s, R2s;
+    vector<SpinorbitalTensor<U>*> Z1s, Z2s;
+    for (int root = 0;root < this->nsolution();root++)
+    {
+        R1s.push_back(&Rs[root](1));
+        R2s.push_back(&Rs[root](2));
+        Z1s.push_back(&Zs[root](1));
+        Z2s.push_back(&Zs[root](2));
+    }
+
+    SpinorbitalTensor<U>::multMany(0.5, false, WAMEF, "amef", false, R2s, "efim", 1.0, Z1s,   "ai");
+    SpinorbitalTensor<U>::multMany(1.0, false, WABEJ, "abej", false, R1s,   "ei", 1.0, Z2s, "abij");
+    SpinorbitalTensor<U>::multMany(0.5, false, WABEF, "abef", false, R2s, "efij", 1.0, Z2s, "abij");
+
     vector<U> energies = davidson.extrapolate(Rs, Zs, D);
 
     for (int i = 0;i < this->nsolution();i++)
@@ -340,8 +340,7 @@ void LambdaCC4<U>::iterate(const Arena& arena)
     /*
      **************************************************************************/
 
-    Z.weight(D);
-    L += Z;
+    Z.weightAndAdd(D, L);
 
     this->energy() = 0.25*real(scalar(conj(WMNEF)*L(2)));
     this->conv() = Z.norm(00);
@@ -369,7 +368,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
@@ -13,7 +13,7 @@ namespace cc
 
 template <typename U>
 LambdaCCSD<U>::LambdaCCSD(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis"))
+: Iterative<U>(name, config), diis(config.get("diis")), diis_single(config.get("diis"))
 {
     vector<Requirement> reqs;
     reqs.push_back(Requirement("ccsd.Hbar", "Hbar"));
@@ -23,6 +23,23 @@ LambdaCCSD<U>::LambdaCCSD(const string& name, Config& config)
     this->addProduct(Product("ccsd.L", "L", reqs));
 }
 
+template <typename U>
+template <typename V>
+void LambdaCCSD<U>::initialize(const TwoElectronOperator<V>& H, const string& tag)
+{
+    const Arena& arena = H.arena;
+
+    const Space& occ = H.occ;
+    const Space& vrt = H.vrt;
+
+    this->puttmp(  "D"+tag, new Denominator         <V  >(H));
+    this->puttmp(  "Z"+tag, new DeexcitationOperator<V,2>("Z", arena, occ, vrt));
+    this->puttmp("GIM"+tag, new SpinorbitalTensor   <V  >("G(im)", H.getIJ()));
+    this->puttmp("GEA"+tag, new SpinorbitalTensor   <V  >("G(ea)", H.getAB()));
+
+    this->template gettmp<DeexcitationOperator<V,2>>("Z"+tag)(0) = 0;
+}
+
 template <typename U>
 bool LambdaCCSD<U>::run(TaskDAG& dag, const Arena& arena)
 {
@@ -31,18 +48,13 @@ bool LambdaCCSD<U>::run(TaskDAG& dag, const Arena& arena)
     const Space& occ = H.occ;
     const Space& vrt = H.vrt;
 
-    this->put   (  "L", new DeexcitationOperator<U,2>("L", arena, occ, vrt));
-    this->puttmp(  "D", new Denominator         <U  >(H));
-    this->puttmp(  "Z", new DeexcitationOperator<U,2>("Z", arena, occ, vrt));
-    this->puttmp("GIM", new SpinorbitalTensor   <U  >("G(im)", H.getIJ()));
-    this->puttmp("GEA", new SpinorbitalTensor   <U  >("G(ea)", H.getAB()));
+    this->put("L", new DeexcitationOperator<U,2>("L", arena, occ, vrt));
 
-    auto& T = this->template get   <ExcitationOperator  <U,2>>("T");
-    auto& L = this->template get   <DeexcitationOperator<U,2>>("L");
-    auto& Z = this->template gettmp<DeexcitationOperator<U,2>>("Z");
-    auto& D = this->template gettmp<Denominator         <U  >>("D");
+    initialize(H, "");
+
+    auto& T = this->template get<ExcitationOperator  <U,2>>("T");
+    auto& L = this->template get<DeexcitationOperator<U,2>>("L");
 
-    Z(0) = 0;
     L(0) = 1;
     L(1)[  "ia"] = T(1)[  "ai"];
     L(2)["ijab"] = T(2)["abij"];
@@ -58,27 +70,73 @@ bool LambdaCCSD<U>::run(TaskDAG& dag, const Arena& arena)
 template <typename U>
 void LambdaCCSD<U>::iterate(const Arena& arena)
 {
-    const auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
+    if (this->isSinglePrecision())
+    {
+        /*
+         * The single precision copies are made on the first single
+         * precision iteration, so never when resuming in double precision
+         */
+        if (!this->hastmp("L (single)"))
+        {
+            auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
+            const auto& T = this->template get<ExcitationOperator<U,2>>("T");
+            auto& L = this->template get<DeexcitationOperator<U,2>>("L");
+
+            auto& Hs = this->puttmp("Hbar (single)", new TwoElectronOperator<float>("Hbar", arena, H.occ, H.vrt));
+            auto& Ts = this->puttmp(   "T (single)", new ExcitationOperator<float,2>("T", arena, H.occ, H.vrt));
+            auto& Ls = this->puttmp(   "L (single)", new DeexcitationOperator<float,2>("L", arena, H.occ, H.vrt));
+            Hs.convert(H);
+            Ts.convert(T);
+            Ls.convert(L);
+
+            /*
+             * The double precision Hbar and lambda amplitudes are not used
+             * again until switchPrecision, so they are kept on disk until
+             * then rather than alongside the single precision copies
+             */
+            H.setStorage(ON_DISK);
+            L.setStorage(ON_DISK);
+
+            initialize(Hs, " (single)");
+        }
+
+        iterate(this->template gettmp<TwoElectronOperator<float>>("Hbar (single)"),
+                this->template gettmp<ExcitationOperator<float,2>>("T (single)"),
+                this->template gettmp<DeexcitationOperator<float,2>>("L (single)"),
+                diis_single, " (single)");
+    }
+    else
+    {
+        iterate(this->template get<STTwoElectronOperator<U>>("Hbar"),
+                this->template get<ExcitationOperator<U,2>>("T"),
+                this->template get<DeexcitationOperator<U,2>>("L"),
+                diis, "");
+    }
+}
 
-    const SpinorbitalTensor<U>&   FME =   H.getIA();
-    const SpinorbitalTensor<U>&   FAE =   H.getAB();
-    const SpinorbitalTensor<U>&   FMI =   H.getIJ();
-    const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
-    const SpinorbitalTensor<U>& WAMEF = H.getAIBC();
-    const SpinorbitalTensor<U>& WABEJ = H.getABCI();
-    const SpinorbitalTensor<U>& WABEF = H.getABCD();
-    const SpinorbitalTensor<U>& WMNIJ = H.getIJKL();
-    const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
-    const SpinorbitalTensor<U>& WAMIJ = H.getAIJK();
-    const SpinorbitalTensor<U>& WAMEI = H.getAIBJ();
-
-    auto& T = this->template get   <ExcitationOperator  <U,2>>("T");
-    auto& L = this->template get   <DeexcitationOperator<U,2>>("L");
-    auto& D = this->template gettmp<Denominator         <U  >>("D");
-    auto& Z = this->template gettmp<DeexcitationOperator<U,2>>("Z");
-
-    auto& GIM = this->template gettmp<SpinorbitalTensor<U>>("GIM");
-    auto& GEA = this->template gettmp<SpinorbitalTensor<U>>("GEA");
+template <typename U>
+template <typename V>
+void LambdaCCSD<U>::iterate(const TwoElectronOperator<V>& H, const ExcitationOperator<V,2>& T,
+                            DeexcitationOperator<V,2>& L,
+                            convergence::DIIS<DeexcitationOperator<V,2>>& diis, const string& tag)
+{
+    const SpinorbitalTensor<V>&   FME =   H.getIA();
+    const SpinorbitalTensor<V>&   FAE =   H.getAB();
+    const SpinorbitalTensor<V>&   FMI =   H.getIJ();
+    const SpinorbitalTensor<V>& WMNEF = H.getIJAB();
+    const SpinorbitalTensor<V>& WAMEF = H.getAIBC();
+    const SpinorbitalTensor<V>& WABEJ = H.getABCI();
+    const SpinorbitalTensor<V>& WABEF = H.getABCD();
+    const SpinorbitalTensor<V>& WMNIJ = H.getIJKL();
+    const SpinorbitalTensor<V>& WMNEJ = H.getIJAK();
+    const SpinorbitalTensor<V>& WAMIJ = H.getAIJK();
+    const SpinorbitalTensor<V>& WAMEI = H.getAIBJ();
+
+    auto& D = this->template gettmp<Denominator         <V  >>("D"+tag);
+    auto& Z = this->template gettmp<DeexcitationOperator<V,2>>("Z"+tag);
+
+    auto& GIM = this->template gettmp<SpinorbitalTensor<V>>("GIM"+tag);
+    auto& GEA = this->template gettmp<SpinorbitalTensor<V>>("GEA"+tag);
 
     /***************************************************************************
      *
@@ -116,8 +174,7 @@ void LambdaCCSD<U>::iterate(const Arena& arena)
     /*
      **************************************************************************/
 
-    Z.weight(D);
-    L += Z;
+    Z.weightAndAdd(D, L);
 
     this->energy() = 0.25*real(scalar(conj(WMNEF)*L(2)));
     this->conv() = Z.norm(00);
@@ -125,6 +182,22 @@ void LambdaCCSD<U>::iterate(const Arena& arena)
     diis.extrapolate(L, Z);
 }
 
+template <typename U>
+void LambdaCCSD<U>::switchPrecision(const Arena& arena)
+{
+    if (!this->hastmp("L (single)")) return;
+
+    auto& L = this->template get<DeexcitationOperator<U,2>>("L");
+
+    this->template get<STTwoElectronOperator<U>>("Hbar").setStorage(IN_CORE);
+    L.setStorage(IN_CORE);
+
+    L.convert(this->template gettmp<DeexcitationOperator<float,2>>("L (single)"));
+
+    this->releasetmp(" (single)");
+    diis_single.clear();
+}
+
 }
 }
 
@@ -136,6 +209,10 @@ max_iterations?
     int 50,
 conv_type?
     enum { MAXE, RMSE, MAE },
+mixed_precision?
+    bool false,
+single_convergence?
+    double 1e-5,
 diis?
 {
     damping?
@@ -145,7 +222,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
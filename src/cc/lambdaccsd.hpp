@@ -31,6 +31,17 @@ class LambdaCCSD : public Iterative<U>
 {
     protected:
         convergence::DIIS<op::DeexcitationOperator<U,2>> diis;
+        convergence::DIIS<op::DeexcitationOperator<float,2>> diis_single;
+
+        template <typename V>
+        void initialize(const op::TwoElectronOperator<V>& H, const string& tag);
+
+        template <typename V>
+        void iterate(const op::TwoElectronOperator<V>& H, const op::ExcitationOperator<V,2>& T,
+                     op::DeexcitationOperator<V,2>& L,
+                     convergence::DIIS<op::DeexcitationOperator<V,2>>& diis, const string& tag);
+
+        void switchPrecision(const Arena& arena);
 
     public:
         LambdaCCSD(const string& name, input::Config& config);
@@ -245,8 +245,7 @@ void LambdaCCSDT_Q<U>::iterate(const Arena& arena)
     Z(2)[  "ijab"] += Q(2)[  "abij"];
     Z(3)["ijkabc"] += Q(3)["abcijk"];
 
-    Z.weight(D);
-    L += Z;
+    Z.weightAndAdd(D, L);
 
     this->energy() = 0.25*real(scalar(conj(WMNEF)*L(2)));
     this->conv() = Z.norm(00);
@@ -274,7 +273,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
@@ -100,8 +100,7 @@ void LCCD<U>::iterate(const Arena& arena)
     /*
      *************************************************************************/
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     this->energy() = 0.25*real(scalar(H.getABIJ()*T(2)));
     this->conv() = Z.norm(00);
@@ -129,7 +128,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
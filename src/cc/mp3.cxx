@@ -70,8 +70,7 @@ bool MP3<U>::run(TaskDAG& dag, const Arena& arena)
     Z(2)["abij"] += 0.5*WMNIJ["mnij"]*T(2)["abmn"];
     Z(2)["abij"] -= WAMEI["amei"]*T(2)["ebmj"];
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     energy = 0.25*real(scalar(H.getABIJ()*T(2)));
 
@@ -144,8 +143,7 @@ void MP3<U>::iterate(const Arena& arena)
     /*
      *************************************************************************/
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     energy = 0.25*real(scalar(H.getABIJ()*T(2)));
 
@@ -72,8 +72,7 @@ bool MP4DQ<U>::run(TaskDAG& dag, const Arena& arena)
     Z(2)["abij"] += 0.5*WMNIJ["mnij"]*T(2)["abmn"];
     Z(2)["abij"] -= WAMEI["amei"]*T(2)["ebmj"];
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     energy = 0.25*real(scalar(H.getABIJ()*T(2)));
     double mp3energy = energy;
@@ -91,8 +90,7 @@ bool MP4DQ<U>::run(TaskDAG& dag, const Arena& arena)
     Znew(2)["abij"] += 0.5*WMNIJ["mnij"]*T(2)["abmn"];
     Znew(2)["abij"] -= WAMEI["amei"]*T(2)["ebmj"];
 
-    Znew.weight(D);
-    T += Znew;
+    Znew.weightAndAdd(D, T);
 
     energy = 0.25*real(scalar(H.getABIJ()*T(2)));
     double mp4denergy = energy - mp3energy;
@@ -123,8 +121,7 @@ bool MP4DQ<U>::run(TaskDAG& dag, const Arena& arena)
     Z(2)["abij"] += 0.5*WMNIJ["mnij"]*T(2)["abmn"];
     Z(2)["abij"] -= WAMEI["amei"]*T(2)["ebmj"];
 
-    Z.weight(D);
-    T += Z;
+    Z.weightAndAdd(D, T);
 
     energy = 0.25*real(scalar(H.getABIJ()*T(2)));
     double mp4qenergy = energy - mp3energy;
@@ -258,8 +258,7 @@ void PiCCSD<U>::iterate(const Arena& arena)
     /*
      **************************************************************************/
 
-    Z.weight(D);
-    P += Z;
+    Z.weightAndAdd(D, P);
 
     this->conv() = Z.norm(00);
 
@@ -286,7 +285,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
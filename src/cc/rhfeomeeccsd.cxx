@@ -32,6 +32,22 @@ struct RHFInnerProd
                      scalar(a[1]["abij"]*b[1]["abji"]);
         }
     }
+
+    template <typename a_container, typename b_container>
+    vector<U> operator()(const a_container& a, const vector<const b_container*>& b) const
+    {
+        vector<U> p;
+        for (auto bk : b) p.push_back((*this)(a, *bk));
+        return p;
+    }
+
+    template <typename a_container, typename b_container>
+    vector<U> operator()(const vector<const a_container*>& a, const vector<const b_container*>& b) const
+    {
+        vector<U> p;
+        for (auto ak : a) for (auto bk : b) p.push_back((*this)(*ak, *bk));
+        return p;
+    }
 };
 
 template <typename U>
@@ -53,7 +69,8 @@ RHFEOMEECCSD<U>::RHFEOMEECCSD(const string& name, Config& config)
   davidson_config(config.get("davidson")),
   nroot(config.get<int>("nroot")),
   nsinglet(config.get<int>("nsinglet")),
-  ntriplet(config.get<int>("ntriplet"))
+  ntriplet(config.get<int>("ntriplet")),
+  multiroot(config.get<bool>("multiroot"))
 {
     vector<Requirement> reqs;
     reqs.emplace_back("molecule", "molecule");
@@ -207,10 +224,30 @@ bool RHFEOMEECCSD<U>::run(TaskDAG& dag, const Arena& arena)
             quintet = false;
             triplet = spin == 1;
 
-            auto& davidson = this->puttmp("Davidson", new RHFDavidson<U>(davidson_config, 1, 2, RHFInnerProd<U>{triplet}));
+            /*
+             * With multiroot, all of the roots of this irrep and spin are
+             * solved for together, so that the sigma vectors are built in one
+             * batch per iteration and the corrections are orthogonalized
+             * together. Otherwise, each root is solved for separately.
+             */
+            vector<vector<tuple<U,int,int,int>>> batches;
+            for (auto& root : roots)
+            {
+                if (spin != get<1>(root)) continue;
+                if (irrep != get<2>(root)) continue;
+
+                if (batches.empty() || !multiroot) batches.emplace_back();
+                batches.back().push_back(root);
+            }
+
+            if (batches.empty()) continue;
+
+            auto& davidson = this->puttmp("Davidson", new RHFDavidson<U>(davidson_config, (int)batches[0].size(), 2, RHFInnerProd<U>{triplet}));
 
-            auto& R1 = this->puttmp("R1", new SymmetryBlockedTensor<U>("R1", arena, group, group.getIrrep(irrep), 2,       {nA,nI},       {NS,NS}, false));
-            auto& R2 = this->puttmp("R2", new SymmetryBlockedTensor<U>("R2", arena, group, group.getIrrep(irrep), 4, {nA,nA,nI,nI}, {NS,NS,NS,NS}, false));
+            auto& R1 = this->puttmp("R1", new unique_vector<SymmetryBlockedTensor<U>>());
+            auto& R2 = this->puttmp("R2", new unique_vector<SymmetryBlockedTensor<U>>());
+            auto& Z1 = this->puttmp("Z1", new unique_vector<SymmetryBlockedTensor<U>>());
+            auto& Z2 = this->puttmp("Z2", new unique_vector<SymmetryBlockedTensor<U>>());
 
             this->puttmp(  "XMI", new SymmetryBlockedTensor<U>(   "X(MI)", arena, group, group.getIrrep(irrep), 2,       {nI,nI},       {NS,NS}, false));
             this->puttmp(  "XAE", new SymmetryBlockedTensor<U>(   "X(AE)", arena, group, group.getIrrep(irrep), 2,       {nA,nA},       {NS,NS}, false));
@@ -219,51 +256,64 @@ bool RHFEOMEECCSD<U>::run(TaskDAG& dag, const Arena& arena)
             this->puttmp("XBMJI", new SymmetryBlockedTensor<U>("X(bM,jI)", arena, group, group.getIrrep(irrep), 4, {nA,nI,nI,nI}, {NS,NS,NS,NS}, false));
             this->puttmp("XMNIJ", new SymmetryBlockedTensor<U>("X(Mn,Ij)", arena, group, group.getIrrep(irrep), 4, {nI,nI,nI,nI}, {NS,NS,NS,NS}, false));
             this->puttmp( "R2SA", new SymmetryBlockedTensor<U>(    "R2SA", arena, group, group.getIrrep(irrep), 4, {nA,nA,nI,nI}, {NS,NS,NS,NS}, false));
-            this->puttmp(   "Z1", new SymmetryBlockedTensor<U>(      "Z1", arena, group, group.getIrrep(irrep), 2,       {nA,nI},       {NS,NS}, false));
-            this->puttmp(   "Z2", new SymmetryBlockedTensor<U>(      "Z2", arena, group, group.getIrrep(irrep), 4, {nA,nA,nI,nI}, {NS,NS,NS,NS}, false));
 
-            for (auto& root : roots)
+            for (int batch = 0;batch < batches.size();batch++)
             {
-                if (spin != get<1>(root)) continue;
-                if (irrep != get<2>(root)) continue;
-
-                int which = get<3>(root);
-
-                Logger::log(arena) << "Starting root number " << idx << endl;
-                Logger::log(arena) << "Guess energy: " << fixed << setprecision(12) << get<0>(root) << endl;
+                R1.clear();
+                R2.clear();
+                Z1.clear();
+                Z2.clear();
 
-                if (quintet)
+                for (auto& root : batches[batch])
                 {
-                    Logger::log(arena) << "Quintet initial guess" << endl;
+                    int which = get<3>(root);
+
+                    Logger::log(arena) << "Starting root number " << (idx+R1.size()) << endl;
+                    Logger::log(arena) << "Guess energy: " << fixed << setprecision(12) << get<0>(root) << endl;
+
+                    if (quintet)
+                    {
+                        Logger::log(arena) << "Quintet initial guess" << endl;
+                    }
+                    else if (triplet)
+                    {
+                        Logger::log(arena) << "Triplet initial guess" << endl;
+                    }
+                    else
+                    {
+                        Logger::log(arena)<< "Singlet initial guess" << endl;
+                    }
+
+                    R1.push_back(new SymmetryBlockedTensor<U>("R1", arena, group, group.getIrrep(irrep), 2,       {nA,nI},       {NS,NS}, false));
+                    R2.push_back(new SymmetryBlockedTensor<U>("R2", arena, group, group.getIrrep(irrep), 4, {nA,nA,nI,nI}, {NS,NS,NS,NS}, false));
+                    Z1.push_back(new SymmetryBlockedTensor<U>("Z1", arena, group, group.getIrrep(irrep), 2,       {nA,nI},       {NS,NS}, false));
+                    Z2.push_back(new SymmetryBlockedTensor<U>("Z2", arena, group, group.getIrrep(irrep), 4, {nA,nA,nI,nI}, {NS,NS,NS,NS}, false));
+
+                    if (triplet) R1.back() = evecs_trip[irrep][which];
+                    else         R1.back() = evecs_sing[irrep][which];
+                    R2.back() = 0;
                 }
-                else if (triplet)
-                {
-                    Logger::log(arena) << "Triplet initial guess" << endl;
-                }
-                else
-                {
-                    Logger::log(arena)<< "Singlet initial guess" << endl;
-                }
-
-                if (triplet) R1 = evecs_trip[irrep][which];
-                else         R1 = evecs_sing[irrep][which];
-                R2 = 0;
 
-                Iterative<U>::run(dag, arena);
+                Iterative<U>::run(dag, arena, R1.size());
 
-                if (!this->isConverged())
+                for (int j = 0;j < R1.size();j++)
                 {
-                    this->error(arena) << "Root " << idx << " did not converge." << endl;
+                    if (!this->isConverged(j))
+                    {
+                        this->error(arena) << "Root " << idx << " did not converge." << endl;
+                    }
+
+                    davidson.getSolution(j, ptr_vector<SymmetryBlockedTensor<U>>{&R1[j], &R2[j]});
+                    idx++;
+
+                    Es[irrep][spin].push_back(this->energy(j));
+                    convs[irrep][spin].push_back(this->conv(j));
+                    R1s[irrep][spin].emplace_back(R1[j]);
+                    R2s[irrep][spin].emplace_back(R2[j]);
                 }
 
-                davidson.getSolution(0, ptr_vector<SymmetryBlockedTensor<U>>{&R1, &R2});
-                davidson.nextRoot(1, 2, RHFInnerProd<U>{triplet});
-                idx++;
-
-                Es[irrep][spin].push_back(this->energy());
-                convs[irrep][spin].push_back(this->conv());
-                R1s[irrep][spin].emplace_back(R1);
-                R2s[irrep][spin].emplace_back(R2);
+                if (batch+1 < batches.size())
+                    davidson.nextRoot((int)batches[batch+1].size(), 2, RHFInnerProd<U>{triplet});
             }
         }
     }
@@ -290,10 +340,10 @@ void RHFEOMEECCSD<U>::iterate(const Arena& arena)
     auto&    T1 = this->template get   <SymmetryBlockedTensor<U>>(   "T1");
     auto&    T2 = this->template get   <SymmetryBlockedTensor<U>>(   "T2");
     auto&   Tau = this->template gettmp<SymmetryBlockedTensor<U>>(  "Tau");
-    auto&    R1 = this->template gettmp<SymmetryBlockedTensor<U>>(   "R1");
-    auto&    R2 = this->template gettmp<SymmetryBlockedTensor<U>>(   "R2");
-    auto&    Z1 = this->template gettmp<SymmetryBlockedTensor<U>>(   "Z1");
-    auto&    Z2 = this->template gettmp<SymmetryBlockedTensor<U>>(   "Z2");
+    auto&   R1s = this->template gettmp<unique_vector<SymmetryBlockedTensor<U>>>("R1");
+    auto&   R2s = this->template gettmp<unique_vector<SymmetryBlockedTensor<U>>>("R2");
+    auto&   Z1s = this->template gettmp<unique_vector<SymmetryBlockedTensor<U>>>("Z1");
+    auto&   Z2s = this->template gettmp<unique_vector<SymmetryBlockedTensor<U>>>("Z2");
     auto&  R2SA = this->template gettmp<SymmetryBlockedTensor<U>>( "R2SA");
     auto& WAMIE = this->template gettmp<SymmetryBlockedTensor<U>>("WAMIE");
 
@@ -307,125 +357,156 @@ void RHFEOMEECCSD<U>::iterate(const Arena& arena)
     auto& D = this->template gettmp<Denominator<U>>("D");
     auto& davidson = this->template gettmp<RHFDavidson<U>>("Davidson");
 
-    if (quintet)
+    /*
+     * The particle-particle ladder term is done for all roots at once, so
+     * that <ab|ef> is only read once per iteration
+     */
+    vector<const SymmetryBlockedTensor<U>*> R2ptrs;
+    vector<SymmetryBlockedTensor<U>*> Z2ptrs;
+    for (int vec = 0;vec < this->nsolution();vec++)
     {
-        XAMIJ["amij"]  =      VABCI["efam"]*  R2["efij"];
-        XMNIJ["mnij"]  =      VABIJ["efmn"]*  R2["efij"];
-
-           Z2["abij"]  = -0.5*XAMIJ["amij"]*  T1[  "bm"];
-           Z2["abij"] +=  0.5*  FAE[  "ae"]*  R2["ebij"];
-           Z2["abij"] -=  0.5*  FMI[  "mi"]*  R2["abmj"];
-           Z2["abij"] += 0.25*WMNIJ["mnij"]*  R2["abmn"];
-           Z2["abij"] += 0.25*XMNIJ["mnij"]* Tau["abmn"];
-           Z2["abij"] += 0.25*VABCD["abef"]*  R2["efij"];
-           Z2["abij"] -=      WAMEI["amei"]*  R2["ebmj"];
-
-           Z2["abij"] -= Z2["abji"];
-           Z2["abij"] -= Z2["baij"];
+        R2ptrs.push_back(&R2s[vec]);
+        Z2ptrs.push_back(&Z2s[vec]);
     }
-    else if (triplet)
+
+    SymmetryBlockedTensor<U>::multMany(quintet ? 0.25 : triplet ? 1.0 : 0.5,
+                                       false, VABCD, "abef", false, R2ptrs, "efij", 0.0, Z2ptrs, "abij");
+
+    for (int vec = 0;vec < this->nsolution();vec++)
     {
-          XMI[  "mi"]  =     VABIJ["efmn"]*  R2["efin"];
-
-           Z1[  "ai"]  =       FAE[  "ae"]*  R1[  "ei"];
-           Z1[  "ai"] -=       FMI[  "mi"]*  R1[  "am"];
-           Z1[  "ai"] -=       XMI[  "mi"]*  T1[  "am"];
-           Z1[  "ai"] -=     WAMEI["amei"]*  R1[  "em"];
-           Z1[  "ai"] +=       FME[  "me"]*  R2["aeim"];
-           Z1[  "ai"] +=     VABCI["efam"]*  R2["efim"];
-           Z1[  "ai"] -=     WMNEJ["mnei"]*  R2["aenm"];
-
-          XMI[  "mi"] -=     WMNEJ["mnei"]*  R1[  "en"];
-
-          XME[  "me"]  =  -  VABIJ["efnm"]*  R1[  "fn"];
-
-          XAE[  "ae"]  =  -  VABCI["feam"]*  R1[  "fm"];
-          XAE[  "ae"] -=       XME[  "me"]*  T1[  "am"];
-          XAE[  "ae"] -=     VABIJ["efmn"]*  R2["afmn"];
-
-        XAMIJ["amij"]  =     VABCI["efam"]*  R2["efij"];
-        XBMJI["bmji"]  =     VABCI["febm"]*  R2["efij"];
-
-        XMNIJ["mnij"]  =     VABIJ["efmn"]*  R2["efij"];
-
-           Z2["abij"]  = 2*  WABEJ["abej"]*  R1[  "ei"];
-           Z2["abij"] -=     WABEJ["baej"]*  R1[  "ei"];
-           Z2["abij"] -=     WABEJ["abei"]*  R1[  "ej"];
-           Z2["abij"] -= 2*  WAMIJ["bmji"]*  R1[  "am"];
-           Z2["abij"] +=     WAMIJ["bmij"]*  R1[  "am"];
-           Z2["abij"] +=     WAMIJ["amji"]*  R1[  "bm"];
-           Z2["abij"] -=     XBMJI["bmji"]*  T1[  "am"];
-           Z2["abij"] -=     XAMIJ["amij"]*  T1[  "bm"];
-           Z2["abij"] +=       FAE[  "ae"]*  R2["ebij"];
-           Z2["abij"] +=       FAE[  "be"]*  R2["aeij"];
-           Z2["abij"] -=       FMI[  "mi"]*  R2["abmj"];
-           Z2["abij"] -=       FMI[  "mj"]*  R2["abim"];
-           Z2["abij"] += 2*    XAE[  "ae"]*  T2["ebij"];
-           Z2["abij"] -=       XAE[  "ae"]*  T2["beij"];
-           Z2["abij"] -=       XAE[  "be"]*  T2["eaij"];
-           Z2["abij"] -= 2*    XMI[  "mi"]*  T2["abmj"];
-           Z2["abij"] +=       XMI[  "mi"]*  T2["abjm"];
-           Z2["abij"] +=       XMI[  "mj"]*  T2["abmi"];
-           Z2["abij"] +=     WMNIJ["mnij"]*  R2["abmn"];
-           Z2["abij"] +=     XMNIJ["mnij"]* Tau["abmn"];
-           Z2["abij"] +=     VABCD["abef"]*  R2["efij"];
-           Z2["abij"] +=   WAMIESA["bmje"]*  R2["aeim"];
-           Z2["abij"] -=     WAMIE["amje"]*  R2["beim"];
-           Z2["abij"] -=     WAMIE["bmie"]*  R2["aejm"];
-           Z2["abij"] -=     WAMEI["amei"]*  R2["ebmj"];
-           Z2["abij"] -=     WAMEI["amej"]*  R2["ebim"];
-           Z2["abij"] -=     WAMEI["bmei"]*  R2["aemj"];
+        auto& R1 = R1s[vec];
+        auto& R2 = R2s[vec];
+        auto& Z1 = Z1s[vec];
+        auto& Z2 = Z2s[vec];
+
+        if (quintet)
+        {
+            XAMIJ["amij"]  =      VABCI["efam"]*  R2["efij"];
+            XMNIJ["mnij"]  =      VABIJ["efmn"]*  R2["efij"];
+
+               Z2["abij"] -=  0.5*XAMIJ["amij"]*  T1[  "bm"];
+               Z2["abij"] +=  0.5*  FAE[  "ae"]*  R2["ebij"];
+               Z2["abij"] -=  0.5*  FMI[  "mi"]*  R2["abmj"];
+               Z2["abij"] += 0.25*WMNIJ["mnij"]*  R2["abmn"];
+               Z2["abij"] += 0.25*XMNIJ["mnij"]* Tau["abmn"];
+               Z2["abij"] -=      WAMEI["amei"]*  R2["ebmj"];
+
+               Z2["abij"] -= Z2["abji"];
+               Z2["abij"] -= Z2["baij"];
+        }
+        else if (triplet)
+        {
+              XMI[  "mi"]  =     VABIJ["efmn"]*  R2["efin"];
+
+               Z1[  "ai"]  =       FAE[  "ae"]*  R1[  "ei"];
+               Z1[  "ai"] -=       FMI[  "mi"]*  R1[  "am"];
+               Z1[  "ai"] -=       XMI[  "mi"]*  T1[  "am"];
+               Z1[  "ai"] -=     WAMEI["amei"]*  R1[  "em"];
+               Z1[  "ai"] +=       FME[  "me"]*  R2["aeim"];
+               Z1[  "ai"] +=     VABCI["efam"]*  R2["efim"];
+               Z1[  "ai"] -=     WMNEJ["mnei"]*  R2["aenm"];
+
+              XMI[  "mi"] -=     WMNEJ["mnei"]*  R1[  "en"];
+
+              XME[  "me"]  =  -  VABIJ["efnm"]*  R1[  "fn"];
+
+              XAE[  "ae"]  =  -  VABCI["feam"]*  R1[  "fm"];
+              XAE[  "ae"] -=       XME[  "me"]*  T1[  "am"];
+              XAE[  "ae"] -=     VABIJ["efmn"]*  R2["afmn"];
+
+            XAMIJ["amij"]  =     VABCI["efam"]*  R2["efij"];
+            XBMJI["bmji"]  =     VABCI["febm"]*  R2["efij"];
+
+            XMNIJ["mnij"]  =     VABIJ["efmn"]*  R2["efij"];
+
+               Z2["abij"] += 2*  WABEJ["abej"]*  R1[  "ei"];
+               Z2["abij"] -=     WABEJ["baej"]*  R1[  "ei"];
+               Z2["abij"] -=     WABEJ["abei"]*  R1[  "ej"];
+               Z2["abij"] -= 2*  WAMIJ["bmji"]*  R1[  "am"];
+               Z2["abij"] +=     WAMIJ["bmij"]*  R1[  "am"];
+               Z2["abij"] +=     WAMIJ["amji"]*  R1[  "bm"];
+               Z2["abij"] -=     XBMJI["bmji"]*  T1[  "am"];
+               Z2["abij"] -=     XAMIJ["amij"]*  T1[  "bm"];
+               Z2["abij"] +=       FAE[  "ae"]*  R2["ebij"];
+               Z2["abij"] +=       FAE[  "be"]*  R2["aeij"];
+               Z2["abij"] -=       FMI[  "mi"]*  R2["abmj"];
+               Z2["abij"] -=       FMI[  "mj"]*  R2["abim"];
+               Z2["abij"] += 2*    XAE[  "ae"]*  T2["ebij"];
+               Z2["abij"] -=       XAE[  "ae"]*  T2["beij"];
+               Z2["abij"] -=       XAE[  "be"]*  T2["eaij"];
+               Z2["abij"] -= 2*    XMI[  "mi"]*  T2["abmj"];
+               Z2["abij"] +=       XMI[  "mi"]*  T2["abjm"];
+               Z2["abij"] +=       XMI[  "mj"]*  T2["abmi"];
+               Z2["abij"] +=     WMNIJ["mnij"]*  R2["abmn"];
+               Z2["abij"] +=     XMNIJ["mnij"]* Tau["abmn"];
+               Z2["abij"] +=   WAMIESA["bmje"]*  R2["aeim"];
+               Z2["abij"] -=     WAMIE["amje"]*  R2["beim"];
+               Z2["abij"] -=     WAMIE["bmie"]*  R2["aejm"];
+               Z2["abij"] -=     WAMEI["amei"]*  R2["ebmj"];
+               Z2["abij"] -=     WAMEI["amej"]*  R2["ebim"];
+               Z2["abij"] -=     WAMEI["bmei"]*  R2["aemj"];
+        }
+        else
+        {
+             R2SA["abij"]  =    2*    R2["abij"];
+             R2SA["abij"] -=          R2["abji"];
+
+              XMI[  "mi"]  =       VABIJ["efmn"]*R2SA["efin"];
+
+               Z1[  "ai"]  =         FAE[  "ae"]*  R1[  "ei"];
+               Z1[  "ai"] -=         FMI[  "mi"]*  R1[  "am"];
+               Z1[  "ai"] -=         XMI[  "mi"]*  T1[  "am"];
+               Z1[  "ai"] +=     WAMIESA["amie"]*  R1[  "em"];
+               Z1[  "ai"] +=         FME[  "me"]*R2SA["aeim"];
+               Z1[  "ai"] +=       VABCI["efam"]*R2SA["efim"];
+               Z1[  "ai"] -=       WMNEJ["mnei"]*R2SA["eamn"];
+
+              XMI[  "mi"] +=   2*  WMNEJ["nmei"]*  R1[  "en"];
+              XMI[  "mi"] -=       WMNEJ["mnei"]*  R1[  "en"];
+
+              XME[  "me"]  =   2*  VABIJ["efmn"]*  R1[  "fn"];
+              XME[  "me"] -=       VABIJ["efnm"]*  R1[  "fn"];
+
+              XAE[  "ae"]  =   2*  VABCI["efam"]*  R1[  "fm"];
+              XAE[  "ae"] -=       VABCI["feam"]*  R1[  "fm"];
+              XAE[  "ae"] -=         XME[  "me"]*  T1[  "am"];
+              XAE[  "ae"] -=       VABIJ["efmn"]*R2SA["afmn"];
+
+            XAMIJ["amij"]  =       VABCI["efam"]*  R2["efij"];
+
+            XMNIJ["mnij"]  =       VABIJ["efmn"]*  R2["efij"];
+
+               Z2["abij"] +=       WABEJ["abej"]*  R1[  "ei"];
+               Z2["abij"] -=       WAMIJ["amij"]*  R1[  "bm"];
+               Z2["abij"] -=       XAMIJ["amij"]*  T1[  "bm"];
+               Z2["abij"] +=         FAE[  "ae"]*  R2["ebij"];
+               Z2["abij"] -=         FMI[  "mi"]*  R2["abmj"];
+               Z2["abij"] +=         XAE[  "ae"]*  T2["ebij"];
+               Z2["abij"] -=         XMI[  "mi"]*  T2["abmj"];
+               Z2["abij"] += 0.5*  WMNIJ["mnij"]*  R2["abmn"];
+               Z2["abij"] += 0.5*  XMNIJ["mnij"]* Tau["abmn"];
+               Z2["abij"] += 0.5*WAMIESA["amie"]*R2SA["ebmj"];
+               Z2["abij"] -= 0.5*  WAMEI["amei"]*  R2["ebjm"];
+               Z2["abij"] -=       WAMEI["amej"]*  R2["ebim"];
+
+               Z2["abij"] +=          Z2["baji"];
+        }
     }
-    else
+
+    vector<ptr_vector<SymmetryBlockedTensor<U>>> R, Z;
+    for (int vec = 0;vec < this->nsolution();vec++)
     {
-         R2SA["abij"]  =    2*    R2["abij"];
-         R2SA["abij"] -=          R2["abji"];
-
-          XMI[  "mi"]  =       VABIJ["efmn"]*R2SA["efin"];
-
-           Z1[  "ai"]  =         FAE[  "ae"]*  R1[  "ei"];
-           Z1[  "ai"] -=         FMI[  "mi"]*  R1[  "am"];
-           Z1[  "ai"] -=         XMI[  "mi"]*  T1[  "am"];
-           Z1[  "ai"] +=     WAMIESA["amie"]*  R1[  "em"];
-           Z1[  "ai"] +=         FME[  "me"]*R2SA["aeim"];
-           Z1[  "ai"] +=       VABCI["efam"]*R2SA["efim"];
-           Z1[  "ai"] -=       WMNEJ["mnei"]*R2SA["eamn"];
-
-          XMI[  "mi"] +=   2*  WMNEJ["nmei"]*  R1[  "en"];
-          XMI[  "mi"] -=       WMNEJ["mnei"]*  R1[  "en"];
-
-          XME[  "me"]  =   2*  VABIJ["efmn"]*  R1[  "fn"];
-          XME[  "me"] -=       VABIJ["efnm"]*  R1[  "fn"];
-
-          XAE[  "ae"]  =   2*  VABCI["efam"]*  R1[  "fm"];
-          XAE[  "ae"] -=       VABCI["feam"]*  R1[  "fm"];
-          XAE[  "ae"] -=         XME[  "me"]*  T1[  "am"];
-          XAE[  "ae"] -=       VABIJ["efmn"]*R2SA["afmn"];
-
-        XAMIJ["amij"]  =       VABCI["efam"]*  R2["efij"];
-
-        XMNIJ["mnij"]  =       VABIJ["efmn"]*  R2["efij"];
-
-           Z2["abij"]  =       WABEJ["abej"]*  R1[  "ei"];
-           Z2["abij"] -=       WAMIJ["amij"]*  R1[  "bm"];
-           Z2["abij"] -=       XAMIJ["amij"]*  T1[  "bm"];
-           Z2["abij"] +=         FAE[  "ae"]*  R2["ebij"];
-           Z2["abij"] -=         FMI[  "mi"]*  R2["abmj"];
-           Z2["abij"] +=         XAE[  "ae"]*  T2["ebij"];
-           Z2["abij"] -=         XMI[  "mi"]*  T2["abmj"];
-           Z2["abij"] += 0.5*  WMNIJ["mnij"]*  R2["abmn"];
-           Z2["abij"] += 0.5*  XMNIJ["mnij"]* Tau["abmn"];
-           Z2["abij"] += 0.5*  VABCD["abef"]*  R2["efij"];
-           Z2["abij"] += 0.5*WAMIESA["amie"]*R2SA["ebmj"];
-           Z2["abij"] -= 0.5*  WAMEI["amei"]*  R2["ebjm"];
-           Z2["abij"] -=       WAMEI["amej"]*  R2["ebim"];
-
-           Z2["abij"] +=          Z2["baji"];
+        R.push_back({&R1s[vec], &R2s[vec]});
+        Z.push_back({&Z1s[vec], &Z2s[vec]});
     }
 
-    this->energy() = davidson.extrapolate(ptr_vector<SymmetryBlockedTensor<U>>{&R1, &R2},
-                                          ptr_vector<SymmetryBlockedTensor<U>>{&Z1, &Z2}, D)[0];
-    this->conv() = max(Z1.norm(00), Z2.norm(00));
+    vector<U> energies = davidson.extrapolate(R, Z, D);
+
+    for (int vec = 0;vec < this->nsolution();vec++)
+    {
+        this->energy(vec) = energies[vec];
+        this->conv(vec) = max(Z1s[vec].norm(00), Z2s[vec].norm(00));
+    }
 }
 
 }
@@ -433,6 +514,8 @@ void RHFEOMEECCSD<U>::iterate(const Arena& arena)
 
 static const char* spec = R"(
 
+multiroot?
+    bool false,
 nroot?
     int 1,
 ntriplet?
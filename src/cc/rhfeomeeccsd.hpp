@@ -24,6 +24,7 @@ class RHFEOMEECCSD : public Iterative<U>
         int nroot;
         int nsinglet;
         int ntriplet;
+        bool multiroot;
         bool triplet;
         bool quintet;
 
@@ -80,7 +80,10 @@ bool LocalRHFTDA<U>::run(TaskDAG& dag, const Arena& arena)
         vector<U> data_sing(ntot*ntot);
         vector<U> data_trip(ntot*ntot);
 
-        int offbj = 0;
+        /*
+         * Read all of the blocks for this irrep at once
+         */
+        vector<vector<int>> irreps;
         for (int j = 0;j < nirrep;j++)
         {
             const Representation& irr_j = group.getIrrep(j);
@@ -89,6 +92,32 @@ bool LocalRHFTDA<U>::run(TaskDAG& dag, const Arena& arena)
                 const Representation& irr_b = group.getIrrep(b);
                 if (!(irr_b*irr_j*irr_R).isTotallySymmetric()) continue;
 
+                for (int i = 0;i < nirrep;i++)
+                {
+                    const Representation& irr_i = group.getIrrep(i);
+                    for (int a = 0;a < nirrep;a++)
+                    {
+                        const Representation& irr_a = group.getIrrep(a);
+                        if (!(irr_a*irr_i*irr_R).isTotallySymmetric()) continue;
+                        irreps.push_back({a,i,b,j});
+                    }
+                }
+            }
+        }
+
+        vector<vector<U>> blocks_sing, blocks_trip;
+        H_sing.getAllData(irreps, blocks_sing);
+        H_trip.getAllData(irreps, blocks_trip);
+
+        int offbj = 0;
+        for (int j = 0, block = 0;j < nirrep;j++)
+        {
+            const Representation& irr_j = group.getIrrep(j);
+            for (int b = 0;b < nirrep;b++)
+            {
+                const Representation& irr_b = group.getIrrep(b);
+                if (!(irr_b*irr_j*irr_R).isTotallySymmetric()) continue;
+
                 int nbj = nA[b]*nI[j];
 
                 int offai = 0;
@@ -102,29 +131,28 @@ bool LocalRHFTDA<U>::run(TaskDAG& dag, const Arena& arena)
 
                         int nai = nA[a]*nI[i];
 
-                        vector<U> data;
-
-                        H_sing({a,i,b,j}).getAllData(data);
-                        assert(data.size() == nai*nbj);
+                        const vector<U>& sing = blocks_sing[block];
+                        assert(sing.size() == nai*nbj);
                         for (int bj = 0;bj < nbj;bj++)
                         {
                             for (int ai = 0;ai < nai;ai++)
                             {
-                                data_sing[offai+ai+(offbj+bj)*ntot] = data[ai+bj*nai];
+                                data_sing[offai+ai+(offbj+bj)*ntot] = sing[ai+bj*nai];
                             }
                         }
 
-                        H_trip({a,i,b,j}).getAllData(data);
-                        assert(data.size() == nai*nbj);
+                        const vector<U>& trip = blocks_trip[block];
+                        assert(trip.size() == nai*nbj);
                         for (int bj = 0;bj < nbj;bj++)
                         {
                             for (int ai = 0;ai < nai;ai++)
                             {
-                                data_trip[offai+ai+(offbj+bj)*ntot] = data[ai+bj*nai];
+                                data_trip[offai+ai+(offbj+bj)*ntot] = trip[ai+bj*nai];
                             }
                         }
 
                         offai += nai;
+                        block++;
                     }
                 }
                 offbj += nbj;
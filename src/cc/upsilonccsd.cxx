@@ -116,8 +116,7 @@ void UpsilonCCSD<Type>::iterate(const Arena& arena)
     /*
      *************************************************************************/
 
-    Z.weight(D);
-    Ups += Z;
+    Z.weightAndAdd(D, Ups);
 
     this->conv() = Z.norm(00);
 
@@ -144,7 +143,9 @@ diis?
     order?
         int 5,
     jacobi?
-        bool false
+        bool false,
+    history?
+        enum { memory, single, disk }
 }
 
 )!";
@@ -14,6 +14,10 @@ namespace aquarius
 namespace convergence
 {
 
+/*
+ * Solve (H-omega)x = b in a Krylov subspace, where the vectors x and b are
+ * of a complex type T and the preconditioner is a ComplexDenominator.
+ */
 template<typename T>
 class ComplexLinearKrylov : public task::Destructible
 {
@@ -23,12 +27,10 @@ class ComplexLinearKrylov : public task::Destructible
         ComplexLinearKrylov& operator=(const ComplexLinearKrylov& other);
 
     protected:
-        typedef typename T::dtype U;
-        typedef complex_type_t<U> CU;
-        unique_vector<T> old_c_r;
-        unique_vector<T> old_c_i;
-        unique_vector<T> old_hc_r;
-        unique_vector<T> old_hc_i;
+        typedef typename T::dtype CU;
+        typedef real_type_t<CU> U;
+        unique_vector<T> old_c;
+        unique_vector<T> old_hc;
         unique_ptr<T> rhs;
         vector<CU> b;
         marray<CU,2> e;
@@ -51,7 +53,7 @@ class ComplexLinearKrylov : public task::Destructible
             v.resize(nextrap, nextrap);
         }
 
-        void addVectors(const T& c_r, const T& c_i, const T& hc_r, const T& hc_i)
+        void addVectors(const T& c, const T& hc)
         {
             nextrap++;
 
@@ -59,72 +61,76 @@ class ComplexLinearKrylov : public task::Destructible
             e.resize(nextrap, nextrap);
             v.resize(nextrap, nextrap);
 
-            if (old_c_r.size() < nextrap)
-                old_c_r.emplace_back(c_r);
+            if (old_c.size() < nextrap)
+                old_c.emplace_back(c);
             else
-                old_c_r[nextrap-1] = c_r;
+                old_c[nextrap-1] = c;
 
-            if (old_c_i.size() < nextrap)
-                old_c_i.emplace_back(c_i);
+            if (old_hc.size() < nextrap)
+                old_hc.emplace_back(hc);
             else
-                old_c_i[nextrap-1] = c_i;
-
-            if (old_hc_r.size() < nextrap)
-                old_hc_r.emplace_back(hc_r);
-            else
-                old_hc_r[nextrap-1] = hc_r;
-
-            if (old_hc_i.size() < nextrap)
-                old_hc_i.emplace_back(hc_i);
-            else
-                old_hc_i[nextrap-1] = hc_i;
+                old_hc[nextrap-1] = hc;
 
             /*
-             * Compute the overlap with the rhs vector
+             * Compute the overlap with the rhs vector and augment the
+             * subspace matrix with the new vectors. The inner products are
+             * conjugated on the fly and share their reductions.
              */
-            b[nextrap-1].real( scalar(c_r*(*rhs)));
-            b[nextrap-1].imag(-scalar(c_i*(*rhs)));
+            vector<const T*> rhs_hc{rhs.get(), &hc};
+            vector<const T*> c_old;
+            for (int extrap = 0;extrap < nextrap-1;extrap++)
+            {
+                rhs_hc.push_back(&old_hc[extrap]);
+                c_old.push_back(&old_c[extrap]);
+            }
 
-            /*
-             * Augment the subspace matrix with the new vectors
-             */
-            e[nextrap-1][nextrap-1].real(scalar(hc_r*c_r) + scalar(hc_i*c_i));
-            e[nextrap-1][nextrap-1].imag(scalar(hc_i*c_r) - scalar(hc_r*c_i));
+            vector<CU> c_dots = c.dots(false, rhs_hc, true);
+            vector<CU> hc_dots = hc.dots(true, c_old, false);
+
+            b[nextrap-1] = c_dots[0];
+            e[nextrap-1][nextrap-1] = c_dots[1];
 
             for (int extrap = 0;extrap < nextrap-1;extrap++)
             {
-                e[   extrap][nextrap-1].real(scalar(old_hc_r[extrap]*c_r) + scalar(old_hc_i[extrap]*c_i));
-                e[   extrap][nextrap-1].imag(scalar(old_hc_i[extrap]*c_r) - scalar(old_hc_r[extrap]*c_i));
-                e[nextrap-1][   extrap].real(scalar(hc_r*old_c_r[extrap]) + scalar(hc_i*old_c_i[extrap]));
-                e[nextrap-1][   extrap].imag(scalar(hc_i*old_c_r[extrap]) - scalar(hc_r*old_c_i[extrap]));
+                e[   extrap][nextrap-1] = c_dots[extrap+2];
+                e[nextrap-1][   extrap] = hc_dots[extrap];
             }
         }
 
-        void getRoot(T& c_r, T& c_i, T& hc_r, T& hc_i)
+        void getRoot(T& c, T& hc)
         {
-            getRoot(c_r, c_i);
+            getRoot(c);
 
-            hc_r = 0;
-            hc_i = 0;
+            hc = 0;
             for (int extrap = 0;extrap < nextrap;extrap++)
             {
-                hc_r += old_hc_r[extrap]*v[extrap].real();
-                hc_r -= old_hc_i[extrap]*v[extrap].imag();
-                hc_i += old_hc_r[extrap]*v[extrap].imag();
-                hc_i += old_hc_i[extrap]*v[extrap].real();
+                hc += v[extrap]*old_hc[extrap];
             }
         }
 
-        void getRoot(T& c_r, T& c_i)
+        void getRoot(T& c)
         {
-            c_r = 0;
-            c_i = 0;
+            c = 0;
             for (int extrap = 0;extrap < nextrap;extrap++)
             {
-                c_r += old_c_r[extrap]*v[extrap].real();
-                c_r -= old_c_i[extrap]*v[extrap].imag();
-                c_i += old_c_r[extrap]*v[extrap].imag();
-                c_i += old_c_i[extrap]*v[extrap].real();
+                c += v[extrap]*old_c[extrap];
+            }
+        }
+
+        /*
+         * The old vectors are orthonormal, so all of the overlaps are taken
+         * with the same c and reduced together
+         */
+        void orthogonalize(T& c, int n)
+        {
+            vector<const T*> c_old;
+            for (int extrap = 0;extrap < n;extrap++) c_old.push_back(&old_c[extrap]);
+
+            vector<CU> olap = c.dots(true, c_old, false);
+
+            for (int extrap = 0;extrap < n;extrap++)
+            {
+                c -= olap[extrap]*old_c[extrap];
             }
         }
 
@@ -135,33 +141,11 @@ class ComplexLinearKrylov : public task::Destructible
             reset(g);
         }
 
-        void extrapolate(T& c_r, T& c_i, T& hc_r, T& hc_i, const cc::ComplexDenominator<U>& D, const CU& omega)
+        void extrapolate(T& c, T& hc, const cc::ComplexDenominator<U>& D, const CU& omega)
         {
             using slice::all;
 
-            addVectors(c_r, c_i, hc_r, hc_i);
-
-            /*
-            for (int i = 0;i < nextrap;i++)
-            {
-                for (int j = 0;j < nextrap;j++)
-                {
-                    printf(" %23.15e", e[i][j].real());
-                }
-                printf("\n");
-            }
-            printf("\n");
-
-            for (int i = 0;i < nextrap;i++)
-            {
-                for (int j = 0;j < nextrap;j++)
-                {
-                    printf(" %23.15e", e[i][j].imag());
-                }
-                printf("\n");
-            }
-            printf("\n");
-            */
+            addVectors(c, hc);
 
             /*
              * Solve the linear problem in the subspace
@@ -170,72 +154,34 @@ class ComplexLinearKrylov : public task::Destructible
             marray<CU,2> tmp(e);
             v = b;
 
-            /*
-            for (int j = 0;j < nextrap;j++)
-            {
-                printf(" %23.15e", v[j].real());
-            }
-            printf("\n\n");
-
-            for (int j = 0;j < nextrap;j++)
-            {
-                printf(" %23.15e", v[j].imag());
-            }
-            printf("\n\n");
-            */
-
             int info = gesv(nextrap, 1, tmp.data(), nextrap, ipiv.data(), v.data(), nextrap);
             if (info != 0) throw runtime_error(str("krylov: Info in gesv: %d", info));
 
-            /*
-            for (int j = 0;j < nextrap;j++)
-            {
-                printf(" %23.15e", v[j].real());
-            }
-            printf("\n\n");
-
-            for (int j = 0;j < nextrap;j++)
-            {
-                printf(" %23.15e", v[j].imag());
-            }
-            printf("\n\n");
-            */
-
             /*
              * Generate solution vector
              */
-            getRoot(c_r, c_i, hc_r, hc_i);
+            getRoot(c, hc);
 
             if (continuous)
             {
                 /*
                  * Orthogonalize to previous vectors
                  */
-                for (int extrap = 0;extrap < nextrap-1;extrap++)
-                {
-                    U olap_r = scalar(old_c_r[extrap]*c_r) + scalar(old_c_i[extrap]*c_i);
-                    U olap_i = scalar(old_c_r[extrap]*c_i) - scalar(old_c_i[extrap]*c_r);
-                    c_r -= olap_r*old_c_r[extrap];
-                    c_r += olap_i*old_c_i[extrap];
-                    c_i -= olap_r*old_c_i[extrap];
-                    c_i -= olap_i*old_c_r[extrap];
-                }
+                orthogonalize(c, nextrap-1);
 
                 /*
                  * Save current solution as new vector in the Krylov subspace
                  */
                 nextrap--;
-                addVectors(c_r, c_i, hc_r, hc_i);
+                addVectors(c, hc);
 
                 /*
                  * If the subspace is full, eject the oldest vector.
                  */
                 if (nextrap == maxextrap)
                 {
-                    rotate(old_c_r.pbegin(), old_c_r.pbegin()+1, old_c_r.pend());
-                    rotate(old_c_i.pbegin(), old_c_i.pbegin()+1, old_c_i.pend());
-                    rotate(old_hc_r.pbegin(), old_hc_r.pbegin()+1, old_hc_r.pend());
-                    rotate(old_hc_i.pbegin(), old_hc_i.pbegin()+1, old_hc_i.pend());
+                    rotate(old_c.pbegin(), old_c.pbegin()+1, old_c.pend());
+                    rotate(old_hc.pbegin(), old_hc.pbegin()+1, old_hc.pend());
                     e.rotate(1,1);
                     rotate(b.begin(), b.begin()+1, b.end());
                     nextrap--;
@@ -248,63 +194,37 @@ class ComplexLinearKrylov : public task::Destructible
                  * subspace must be constructed which contains the best approximation
                  * to the solution.
                  */
-                task::Logger::log(c_r.arena) << "Compacting..." << endl;
+                task::Logger::log(c.arena) << "Compacting..." << endl;
                 nextrap = 0;
-                addVectors(c_r, c_i, hc_r, hc_i);
+                addVectors(c, hc);
                 v[0] = 1.0;
             }
 
             /*
              * Form residual and apply Davidson-like correction
              */
-            hc_r -= *rhs;
-            c_r = hc_r;
-            c_i = hc_i;
-            D.weight(c_r, c_i, omega);
-
-            //printf("<B|r>: %.15f\n", scalar((*rhs)*c_r));
-            //printf("<B|i>: %.15f\n", scalar((*rhs)*c_i));
-
-            //printf("<rr|rr>: %.15f\n", scalar(hc_r*hc_r));
-            //printf("<ri|ri>: %.15f\n", scalar(hc_i*hc_i));
-
-            //printf("<Rr|Rr>: %.15f\n", scalar(c_r*c_r));
-            //printf("<Ri|Ri>: %.15f\n", scalar(c_i*c_i));
-
-            //printf("<B|r>: %.15f\n", scalar((*rhs)*c_r));
-            //printf("<B|i>: %.15f\n", scalar((*rhs)*c_i));
+            hc -= *rhs;
+            c = hc;
+            D.weight(c, omega);
 
             /*
              * Orthogonalize to previous vectors
              */
-            for (int extrap = 0;extrap < nextrap;extrap++)
-            {
-                U olap_r = scalar(old_c_r[extrap]*c_r) + scalar(old_c_i[extrap]*c_i);
-                U olap_i = scalar(old_c_r[extrap]*c_i) - scalar(old_c_i[extrap]*c_r);
-                c_r -= olap_r*old_c_r[extrap];
-                c_r += olap_i*old_c_i[extrap];
-                c_i -= olap_r*old_c_i[extrap];
-                c_i -= olap_i*old_c_r[extrap];
-            }
-
-            U norm = sqrt(aquarius::abs(scalar(c_r*c_r)) + aquarius::abs(scalar(c_i*c_i)));
-            c_r /= norm;
-            c_i /= norm;
+            orthogonalize(c, nextrap);
 
-            //printf("<B|r>: %.15f\n", scalar((*rhs)*c_r));
-            //printf("<B|i>: %.15f\n", scalar((*rhs)*c_i));
+            U norm = sqrt(aquarius::abs(c.dots(true, {&c}, false)[0]));
+            c /= norm;
         }
 
-        void getSolution(T& c_r, T& c_i)
+        void getSolution(T& c)
         {
             if (continuous)
             {
-                c_r = old_c_r[nextrap-1];
-                c_i = old_c_i[nextrap-1];
+                c = old_c[nextrap-1];
             }
             else
             {
-                getRoot(c_r, c_i);
+                getRoot(c);
             }
         }
 
@@ -286,31 +286,68 @@ class Davidson : public task::Destructible
              */
             if (!guess.empty())
             {
+                vector<const unique_vector<T>*> guesses;
+                for (int gvec = 0;gvec < nvec;gvec++) guesses.push_back(&guess[gvec]);
+
                 for (int cvec = 0;cvec < nvec;cvec++)
                 {
+                    vector<dtype> olap = innerProd(old_c[nextrap-1][cvec], guesses);
+
                     for (int gvec = 0;gvec < nvec;gvec++)
                     {
-                        guess_overlap[gvec][cvec][nextrap-1] = innerProd(old_c[nextrap-1][cvec], guess[gvec]);
+                        guess_overlap[gvec][cvec][nextrap-1] = olap[gvec];
                     }
                 }
             }
 
             /*
-             * Augment the subspace matrix with the new vectors
+             * Augment the subspace matrix with the new vectors. Each new
+             * vector is taken against all of the vectors it is paired with
+             * at once, so that there is one reduction per new vector.
              */
+            vector<const unique_vector<T>*> all_hc, all_c;
+            for (int extrap = 0;extrap < nextrap;extrap++)
+            {
+                for (int vec = 0;vec < nvec;vec++)
+                {
+                    all_hc.push_back(&old_hc[extrap][vec]);
+                    all_c.push_back(&old_c[extrap][vec]);
+                }
+            }
+
+            vector<const unique_vector<T>*> all_hc_c(all_hc);
+            all_hc_c.insert(all_hc_c.end(), all_c.begin(), all_c.end());
+
             for (int lvec = 0;lvec < nvec;lvec++)
             {
-                for (int rvec = 0;rvec < nvec;rvec++)
+                vector<dtype> olap = innerProd(old_c[nextrap-1][lvec], all_hc_c);
+
+                for (int extrap = 0;extrap < nextrap;extrap++)
                 {
-                    e[lvec][nextrap-1][rvec][nextrap-1] = innerProd(old_c[nextrap-1][lvec], old_hc[nextrap-1][rvec]);
-                    s[lvec][nextrap-1][rvec][nextrap-1] = innerProd(old_c[nextrap-1][lvec],  old_c[nextrap-1][rvec]);
+                    for (int rvec = 0;rvec < nvec;rvec++)
+                    {
+                        e[lvec][nextrap-1][rvec][extrap] = olap[                extrap*nvec+rvec];
+                        s[lvec][nextrap-1][rvec][extrap] = olap[nextrap*nvec + extrap*nvec+rvec];
+                    }
+                }
+            }
+
+            /*
+             * <c_old|H|c_new> is not <c_new|H|c_old>* unless H is
+             * Hermitian, so these must be computed separately
+             */
+            all_c.resize((nextrap-1)*nvec);
+
+            for (int rvec = 0;rvec < nvec;rvec++)
+            {
+                vector<dtype> olap = innerProd(old_hc[nextrap-1][rvec], all_c);
 
-                    for (int extrap = 0;extrap < nextrap;extrap++)
+                for (int extrap = 0;extrap < nextrap-1;extrap++)
+                {
+                    for (int lvec = 0;lvec < nvec;lvec++)
                     {
-                        e[lvec][   extrap][rvec][nextrap-1] = innerProd(old_c[   extrap][lvec], old_hc[nextrap-1][rvec]);
-                        e[lvec][nextrap-1][rvec][   extrap] = innerProd(old_c[nextrap-1][lvec], old_hc[   extrap][rvec]);
-                        s[lvec][   extrap][rvec][nextrap-1] = innerProd(old_c[   extrap][lvec],  old_c[nextrap-1][rvec]);
-                        s[lvec][nextrap-1][rvec][   extrap] = innerProd(old_c[nextrap-1][lvec],  old_c[   extrap][rvec]);
+                        e[lvec][extrap][rvec][nextrap-1] = aquarius::conj(olap[extrap*nvec+lvec]);
+                        s[lvec][extrap][rvec][nextrap-1] = aquarius::conj(s[rvec][nextrap-1][lvec][extrap]);
                     }
                 }
             }
@@ -379,6 +416,148 @@ class Davidson : public task::Destructible
             }
         }
 
+        template <typename container>
+        static ptr_vector<T> view(container& x)
+        {
+            ptr_vector<T> v;
+            for (auto& t : x) v.push_back(&t);
+            return v;
+        }
+
+        /*
+         * Orthogonalize the vectors c against the converged solutions, and
+         * orthonormalize them among themselves by a Cholesky factorization
+         * of their overlap matrix (c <- c*L^-H), with a single reduction for
+         * all of the overlaps. The solutions are assumed to be orthonormal.
+         * If hc is not empty, the same combinations are applied to it so
+         * that it remains H*c.
+         */
+        void orthonormalize(vector<ptr_vector<T>>& c, vector<ptr_vector<T>>& hc)
+        {
+            int nnew = c.size();
+            if (nnew == 0) return;
+
+            vector<ptr_vector<T>> old_vecs, old_hvecs;
+            for (int soln = 0;soln < nsoln;soln++)
+            {
+                for (int svec = 0;svec < nvec;svec++)
+                {
+                    old_vecs.push_back(view(old_c[soln][svec]));
+                    old_hvecs.push_back(view(old_hc[soln][svec]));
+                }
+            }
+            int nold = old_vecs.size();
+            int nrhs = nold+nnew;
+
+            vector<const ptr_vector<T>*> lhs, rhs;
+            for (auto& v : c) lhs.push_back(&v);
+            for (auto& v : old_vecs) rhs.push_back(&v);
+            for (auto& v : c) rhs.push_back(&v);
+
+            vector<dtype> olap = innerProd(lhs, rhs);
+
+            /*
+             * Overlap of the vectors after projecting out the solutions
+             */
+            marray<dtype,2> g(nnew, nnew);
+            for (int i = 0;i < nnew;i++)
+            {
+                for (int j = 0;j < nnew;j++)
+                {
+                    g[i][j] = olap[i*nrhs+nold+j];
+                    for (int q = 0;q < nold;q++)
+                        g[i][j] -= olap[i*nrhs+q]*aquarius::conj(olap[j*nrhs+q]);
+                }
+            }
+
+            /*
+             * g = L*L^H, falling back to normalizing each vector separately
+             * if the vectors are (numerically) linearly dependent
+             */
+            marray<dtype,2> L(nnew, nnew);
+            bool independent = true;
+            for (int j = 0;j < nnew && independent;j++)
+            {
+                dtype d = g[j][j];
+                for (int k = 0;k < j;k++) d -= L[j][k]*aquarius::conj(L[j][k]);
+
+                if (real(d) <= 1e-14*aquarius::abs(g[j][j]))
+                {
+                    independent = false;
+                    break;
+                }
+
+                L[j][j] = sqrt(real(d));
+                for (int i = j+1;i < nnew;i++)
+                {
+                    dtype x = g[i][j];
+                    for (int k = 0;k < j;k++) x -= L[i][k]*aquarius::conj(L[j][k]);
+                    L[i][j] = x/L[j][j];
+                }
+            }
+
+            /*
+             * m = L^-H (upper triangular)
+             */
+            marray<dtype,2> m(nnew, nnew);
+            if (independent)
+            {
+                marray<dtype,2> Linv(nnew, nnew);
+                for (int i = 0;i < nnew;i++)
+                {
+                    Linv[i][i] = 1.0/L[i][i];
+                    for (int j = 0;j < i;j++)
+                    {
+                        dtype x = 0;
+                        for (int k = j;k < i;k++) x += L[i][k]*Linv[k][j];
+                        Linv[i][j] = -x/L[i][i];
+                    }
+                }
+
+                for (int u = 0;u < nnew;u++)
+                    for (int v = u;v < nnew;v++)
+                        m[u][v] = aquarius::conj(Linv[v][u]);
+            }
+            else
+            {
+                for (int v = 0;v < nnew;v++)
+                    m[v][v] = 1.0/sqrt(aquarius::abs(g[v][v]));
+            }
+
+            /*
+             * Components of the new vectors along each solution
+             */
+            marray<dtype,2> p(nold, nnew);
+            for (int q = 0;q < nold;q++)
+                for (int v = 0;v < nnew;v++)
+                    for (int u = 0;u <= v;u++)
+                        p[q][v] += m[u][v]*aquarius::conj(olap[u*nrhs+q]);
+
+            /*
+             * Each new vector only depends on itself and the ones before it,
+             * so go backwards to combine them in place
+             */
+            for (int v = nnew-1;v >= 0;v--)
+            {
+                for (int idx = 0;idx < nc;idx++)
+                {
+                    c[v][idx] *= m[v][v];
+                    for (int u = 0;u < v;u++)
+                        if (m[u][v] != 0.0) c[v][idx] += c[u][idx]*m[u][v];
+                    for (int q = 0;q < nold;q++)
+                        c[v][idx] -= old_vecs[q][idx]*p[q][v];
+
+                    if (hc.empty()) continue;
+
+                    hc[v][idx] *= m[v][v];
+                    for (int u = 0;u < v;u++)
+                        if (m[u][v] != 0.0) hc[v][idx] += hc[u][idx]*m[u][v];
+                    for (int q = 0;q < nold;q++)
+                        hc[v][idx] -= old_hvecs[q][idx]*p[q][v];
+                }
+            }
+        }
+
     public:
         template <typename... U>
         Davidson(const input::Config& config, U&&... args)
@@ -463,6 +642,22 @@ class Davidson : public task::Destructible
                     }
                 }
 
+                /*
+                 * The retained vectors for different roots need not be
+                 * orthogonal, so orthonormalize them together to keep the
+                 * restarted subspace well-conditioned
+                 */
+                vector<ptr_vector<T>> kept_c, kept_hc;
+                for (int extrap = 0; extrap < nreduce; extrap++)
+                {
+                    for (int vec = 0;vec < nvec;vec++)
+                    {
+                        kept_c.push_back(view(new_c[extrap][vec]));
+                        kept_hc.push_back(view(new_hc[extrap][vec]));
+                    }
+                }
+                orthonormalize(kept_c, kept_hc);
+
                 nextrap = nsoln;
                 for (int extrap = 0; extrap < new_nextrap-nsoln; extrap++)
                 {
@@ -560,22 +755,16 @@ class Davidson : public task::Destructible
                     c[vec][idx] = -hc[vec][idx];
                 }
                 weight(c[vec], D, real(l[root[vec]]));
-
-                /*
-                 * Orthogonalize and normalize
-                 */
-                for (int soln = 0;soln < nsoln;soln++)
-                {
-                    for (int svec = 0;svec < nvec;svec++)
-                    {
-                        dtype olap = innerProd(old_c[soln][svec], c[vec]);
-                        for (int idx = 0;idx < nc;idx++) c[vec][idx] -= old_c[soln][svec][idx]*olap;
-                    }
-                }
-                dtype nrm = innerProd(c[vec], c[vec]);
-                for (int idx = 0;idx < nc;idx++) c[vec][idx] /= sqrt(nrm);
             }
 
+            /*
+             * Orthogonalize and normalize the corrections for all roots at
+             * once
+             */
+            vector<ptr_vector<T>> corrections, no_hc;
+            for (int vec = 0;vec < nvec;vec++) corrections.push_back(view(c[vec]));
+            orthonormalize(corrections, no_hc);
+
             if (continuous)
             {
                 /*
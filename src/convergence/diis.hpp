@@ -5,6 +5,7 @@
 
 #include "input/config.hpp"
 #include "task/task.hpp"
+#include "tensor/tensor.hpp"
 
 namespace aquarius
 {
@@ -29,6 +30,56 @@ struct DefaultInnerProd
         }
         return p;
     }
+
+    /*
+     * The inner products of a with each of b, with a single reduction
+     * over processes for all of them
+     */
+    template <typename a_container, typename b_container>
+    vector<dtype> operator()(const a_container& a, const vector<const b_container*>& b) const
+    {
+        vector<dtype> p(b.size(), (dtype)0);
+        if (b.empty()) return p;
+
+        for (int j = 0;j < a.size();j++)
+        {
+            vector<const T*> b_j;
+            for (int k = 0;k < b.size();k++) b_j.push_back(&(*b[k])[j]);
+            a[j].localDots(false, b_j, true, p);
+        }
+
+        a[0].arena.comm().Allreduce(p.data(), p.size(), MPI_SUM);
+        return p;
+    }
+
+    /*
+     * The inner products of each of a with each of b, stored by rows (the
+     * products for a[0] first), with a single reduction over processes
+     * for all of them
+     */
+    template <typename a_container, typename b_container>
+    vector<dtype> operator()(const vector<const a_container*>& a, const vector<const b_container*>& b) const
+    {
+        vector<dtype> p(a.size()*b.size(), (dtype)0);
+        if (p.empty()) return p;
+
+        for (int i = 0;i < a.size();i++)
+        {
+            vector<dtype> p_i(b.size(), (dtype)0);
+
+            for (int j = 0;j < a[i]->size();j++)
+            {
+                vector<const T*> b_j;
+                for (int k = 0;k < b.size();k++) b_j.push_back(&(*b[k])[j]);
+                (*a[i])[j].localDots(false, b_j, true, p_i);
+            }
+
+            copy(p_i.begin(), p_i.end(), p.begin()+i*b.size());
+        }
+
+        (*a[0])[0].arena.comm().Allreduce(p.data(), p.size(), MPI_SUM);
+        return p;
+    }
 };
 
 }
@@ -44,6 +95,7 @@ class DIIS
         marray<dtype,2> e;
         int nextrap, start;
         double damping;
+        tensor::Storage history;
         int nx, ndx;
         InnerProd innerProd;
 
@@ -55,6 +107,24 @@ class DIIS
             start = config.get<int>("start");
             damping = config.get<double>("damping");
 
+            /*
+             * Old vectors are only needed while extrapolating, so they
+             * may be kept on disk or in single precision in between
+             */
+            string shistory = (config.exists("history") ? config.get<string>("history") : "memory");
+            if (shistory == "disk")
+            {
+                history = tensor::ON_DISK;
+            }
+            else if (shistory == "single")
+            {
+                history = tensor::SINGLE_PRECISION;
+            }
+            else
+            {
+                history = tensor::IN_CORE;
+            }
+
             e.resize(nextrap+1, nextrap+1);
             c.resize(nextrap+1);
 
@@ -62,6 +132,106 @@ class DIIS
             old_dx.resize(nextrap);
         }
 
+        /*
+         * Free the extrapolation history, e.g. once a single precision
+         * solve is finished
+         */
+        void clear()
+        {
+            for (int i = 0;i < nextrap;i++)
+            {
+                old_x[i].clear();
+                old_dx[i].clear();
+            }
+        }
+
+        /*
+         * Save the extrapolation history to files beginning with path.
+         */
+        void save(const string& path, const Arena& arena) const
+        {
+            int nsaved = 0;
+            while (nsaved < nextrap && !old_dx[nsaved].empty()) nsaved++;
+
+            if (arena.rank == 0)
+            {
+                ofstream ofs(path, std::ios::binary);
+                ofs.write(reinterpret_cast<const char*>(&nsaved), sizeof(int));
+                ofs.write(reinterpret_cast<const char*>(&start), sizeof(int));
+                ofs.write(reinterpret_cast<const char*>(e.data()), sizeof(dtype)*(nextrap+1)*(nextrap+1));
+            }
+
+            for (int i = 0;i < nsaved;i++)
+            {
+                for (int j = 0;j < nx;j++)
+                {
+                    old_x[i][j].save(path + ".x" + str(i) + "." + str(j));
+                }
+
+                for (int j = 0;j < ndx;j++)
+                {
+                    old_dx[i][j].save(path + ".dx" + str(i) + "." + str(j));
+                }
+            }
+        }
+
+        bool load(const string& path, const Arena& arena, T& x, U& dx)
+        {
+            return load(path, arena, ptr_vector<T>{&x}, ptr_vector<U>{&dx});
+        }
+
+        /*
+         * Load the history saved by save, using x and dx as templates for
+         * the stored vectors.
+         */
+        template <typename x_container, typename dx_container>
+        bool load(const string& path, const Arena& arena, x_container&& x, dx_container&& dx)
+        {
+            assert(x.size() == nx);
+            assert(dx.size() == ndx);
+
+            int header[3] = {0, 0, 0};
+
+            if (arena.rank == 0)
+            {
+                ifstream ifs(path, std::ios::binary);
+                ifs.read(reinterpret_cast<char*>(&header[1]), sizeof(int));
+                ifs.read(reinterpret_cast<char*>(&header[2]), sizeof(int));
+                ifs.read(reinterpret_cast<char*>(e.data()), sizeof(dtype)*(nextrap+1)*(nextrap+1));
+                header[0] = ifs && header[1] <= nextrap;
+            }
+
+            arena.comm().Bcast(header, 3, 0);
+            if (!header[0]) return false;
+
+            arena.comm().Bcast(e.data(), (nextrap+1)*(nextrap+1), 0);
+            start = header[2];
+
+            for (int i = 0;i < nextrap;i++)
+            {
+                old_x[i].clear();
+                old_dx[i].clear();
+
+                if (i >= header[1]) continue;
+
+                for (int j = 0;j < nx;j++)
+                {
+                    old_x[i].push_back(x[j]);
+                    if (!old_x[i][j].load(path + ".x" + str(i) + "." + str(j))) return false;
+                    old_x[i][j].setStorage(history);
+                }
+
+                for (int j = 0;j < ndx;j++)
+                {
+                    old_dx[i].push_back(dx[j]);
+                    if (!old_dx[i][j].load(path + ".dx" + str(i) + "." + str(j))) return false;
+                    old_dx[i][j].setStorage(history);
+                }
+            }
+
+            return true;
+        }
+
         void extrapolate(T& x, U& dx)
         {
             extrapolate(ptr_vector<T>{&x}, ptr_vector<U>{&dx});
@@ -94,6 +264,7 @@ class DIIS
                 for (int i = 0;i < nx;i++)
                 {
                     old_x[0].push_back(x[i]);
+                    old_x[0][i].setStorage(history);
                 }
             }
             else
@@ -104,11 +275,34 @@ class DIIS
                 }
             }
 
+            /*
+             * Get the new row of the error matrix for all previous vectors
+             * which exist. There may be fewer than nextrap of them
+             * (e.g. in iterations 1 to nextrap-1), so save this number.
+             * The products use dx itself rather than its copy in the history,
+             * which may only be kept in single precision.
+             */
+            int nextrap_real = 1;
+            while (nextrap_real < nextrap && !old_dx[nextrap_real].empty()) nextrap_real++;
+
+            vector<ptr_vector<U>> rows(nextrap_real);
+            for (int j = 0;j < ndx;j++) rows[0].push_back(&dx[j]);
+            for (int i = 1;i < nextrap_real;i++)
+            {
+                for (int j = 0;j < ndx;j++) rows[i].push_back(&old_dx[i][j]);
+            }
+
+            vector<const ptr_vector<U>*> prev;
+            for (int i = 0;i < nextrap_real;i++) prev.push_back(&rows[i]);
+
+            vector<dtype> olap = innerProd(rows[0], prev);
+
             if (old_dx[0].empty())
             {
                 for (int i = 0;i < ndx;i++)
                 {
                     old_dx[0].push_back(dx[i]);
+                    old_dx[0][i].setStorage(history);
                 }
             }
             else
@@ -119,19 +313,11 @@ class DIIS
                 }
             }
 
-            e[0][0] = innerProd(dx, dx);
-
-            /*
-             * Get the new off-diagonal error matrix elements for all
-             * previous vectors which exist. There may be fewer than nextrap of them
-             * (e.g. in iterations 1 to nextrap-1), so save this number.
-             */
-            int nextrap_real = 1;
-            for (int i = 1;i < nextrap && !old_dx[i].empty();i++)
+            e[0][0] = olap[0];
+            for (int i = 1;i < nextrap_real;i++)
             {
-                e[i][0] = innerProd(dx, old_dx[i]);
+                e[i][0] = olap[i];
                 e[0][i] = e[i][0];
-                nextrap_real++;
             }
 
             /*
@@ -250,6 +250,29 @@ class OneElectronIntegralsTask : public task::Task
 
             return true;
         }
+
+        bool checkpoint(const string& path, const Arena& arena)
+        {
+            get<OVI>("S").save(path + ".S");
+            get<KEI>("T").save(path + ".T");
+            get<NAI>("G").save(path + ".G");
+            get<OneElectronHamiltonian>("H").save(path + ".H");
+            return true;
+        }
+
+        bool restore(const string& path, const Arena& arena)
+        {
+            const input::Molecule& molecule = get<input::Molecule>("molecule");
+            const vector<int>& N = molecule.getNumOrbitals();
+
+            auto& ovi = put("S", new OVI(arena, molecule.getGroup(), N));
+            auto& kei = put("T", new KEI(arena, molecule.getGroup(), N));
+            auto& nai = put("G", new NAI(arena, molecule.getGroup(), N));
+            auto& oeh = put("H", new OneElectronHamiltonian(arena, molecule.getGroup(), N));
+
+            return ovi.load(path + ".S") && kei.load(path + ".T") &&
+                   nai.load(path + ".G") && oeh.load(path + ".H");
+        }
 };
 
 using Ishida1eIntegralsTask = OneElectronIntegralsTask<IshidaOVI, IshidaKEI, IshidaNAI>;
@@ -187,31 +187,46 @@ void TwoElectronIntegrals::prims(const vec3& posa, const vec3& posb, const vec3&
         Kcd[g][h] = exp(-zc[g]*zd[h]*norm2(posc-posd)/zq)/zq;
     }
 
+    /*
+     * Primitive pairs whose overlap prefactor is already below the
+     * requested accuracy are dropped before forming quartets, so that the
+     * quartet loop only visits pairs which may contribute
+     */
+    vector<int> pab, pcd;
+    for (int j = 0;j < na*nb;j++)
+        if (Kab[j%na][j/na] >= accuracy_) pab.push_back(j);
+    for (int j = 0;j < nc*nd;j++)
+        if (Kcd[j%nc][j/nc] >= accuracy_) pcd.push_back(j);
+
+    int len = fca*fcb*fcc*fcd;
+    int64_t nab = pab.size();
+    int64_t ncd = pcd.size();
+
+    if (nab*ncd < na*nb*nc*nd) fill_n(integrals, (int64_t)na*nb*nc*nd*len, 0.0);
+
     #pragma omp parallel
     {
         int nt = omp_get_num_threads();
         int i = omp_get_thread_num();
-        int len = fca*fcb*fcc*fcd;
-        for (int64_t j = i;j < na*nb*nc*nd;j += nt)
+        for (int64_t j = i;j < nab*ncd;j += nt)
         {
-            int h = j/(na*nb*nc);
-            int r = j%(na*nb*nc);
-            int g = r/(na*nb);
-            int s = r%(na*nb);
-            int f = s/na;
-            int e = s%na;
+            int ef = pab[j%nab];
+            int gh = pcd[j/nab];
+            int e = ef%na;
+            int f = ef/na;
+            int g = gh%nc;
+            int h = gh/nc;
+            int64_t efgh = ef+(int64_t)na*nb*gh;
 
             double A0 = TWO_PI_52*Kab[e][f]*Kcd[g][h]/sqrt(za[e]+zb[f]+zc[g]+zd[h]);
 
-            if (Kab[e][f] < accuracy_ ||
-                Kcd[g][h] < accuracy_ ||
-                A0 < accuracy_)
+            if (A0 < accuracy_)
             {
-                fill_n(integrals+j*len, len, 0.0);
+                fill_n(integrals+efgh*len, len, 0.0);
                 continue;
             }
 
-            prim(posa, e, posb, f, posc, g, posd, h, integrals+j*len);
+            prim(posa, e, posb, f, posc, g, posd, h, integrals+efgh*len);
         }
     }
 }
@@ -518,6 +533,154 @@ void ERI::print(Printer& p) const
     //TODO
 }
 
+<<<<<<< HEAD
+/*
+ * File layout: the total number of integrals n, then n values, then n
+ * indices
+ */
+void ERI::save(const string& file) const
+{
+    int64_t nint = ints.size();
+    vector<int64_t> nints(arena.size);
+    arena.comm().Allgather(&nint, nints.data(), 1);
+
+    int64_t total = 0, offset = 0;
+    for (int i = 0;i < arena.size;i++)
+    {
+        if (i < arena.rank) offset += nints[i];
+        total += nints[i];
+    }
+
+    MPI_File fh;
+    if (MPI_File_open(const_cast<MPI_Comm&>((const MPI_Comm&)arena.comm()),
+                      const_cast<char*>(file.c_str()),
+                      MPI_MODE_CREATE|MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        throw runtime_error("Could not open " + file + " for writing");
+
+    MPI_File_set_size(fh, 0);
+
+    if (arena.rank == 0)
+    {
+        MPI_File_write_at(fh, 0, &total, sizeof(int64_t), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    /*
+     * The deques are not contiguous, so go through a bounded buffer, which
+     * also keeps the byte counts within the range of an int
+     */
+    const int64_t chunk = TMP_BUFSIZE;
+    vector<double> tmpval(chunk);
+    vector<idx4_t> tmpidx(chunk);
+
+    MPI_Offset valdisp = sizeof(int64_t) + offset*sizeof(double);
+    MPI_Offset idxdisp = sizeof(int64_t) + total*sizeof(double) + offset*sizeof(idx4_t);
+    for (int64_t i = 0;i < nint;i += chunk)
+    {
+        int64_t n = min(chunk, nint-i);
+        copy(ints.begin()+i, ints.begin()+i+n, tmpval.begin());
+        copy(idxs.begin()+i, idxs.begin()+i+n, tmpidx.begin());
+        MPI_File_write_at(fh, valdisp + i*sizeof(double), tmpval.data(),
+                          n*sizeof(double), MPI_BYTE, MPI_STATUS_IGNORE);
+        MPI_File_write_at(fh, idxdisp + i*sizeof(idx4_t), tmpidx.data(),
+                          n*sizeof(idx4_t), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    MPI_File_close(&fh);
+}
+
+bool ERI::load(const string& file)
+{
+    MPI_File fh;
+    if (MPI_File_open(const_cast<MPI_Comm&>((const MPI_Comm&)arena.comm()),
+                      const_cast<char*>(file.c_str()),
+                      MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        return false;
+
+    int64_t total = -1;
+    MPI_File_read_at_all(fh, 0, &total, sizeof(int64_t), MPI_BYTE, MPI_STATUS_IGNORE);
+
+    if (total < 0)
+    {
+        MPI_File_close(&fh);
+        return false;
+    }
+
+    /*
+     * Each process reads an even share of the integrals
+     */
+    int64_t begin = (total*arena.rank)/arena.size;
+    int64_t end = (total*(arena.rank+1))/arena.size;
+
+    ints.clear();
+    idxs.clear();
+
+    const int64_t chunk = TMP_BUFSIZE;
+    vector<double> tmpval(chunk);
+    vector<idx4_t> tmpidx(chunk);
+
+    MPI_Offset valdisp = sizeof(int64_t) + begin*sizeof(double);
+    MPI_Offset idxdisp = sizeof(int64_t) + total*sizeof(double) + begin*sizeof(idx4_t);
+    for (int64_t i = 0;i < end-begin;i += chunk)
+    {
+        int64_t n = min(chunk, end-begin-i);
+        MPI_File_read_at(fh, valdisp + i*sizeof(double), tmpval.data(),
+                         n*sizeof(double), MPI_BYTE, MPI_STATUS_IGNORE);
+        MPI_File_read_at(fh, idxdisp + i*sizeof(idx4_t), tmpidx.data(),
+                         n*sizeof(idx4_t), MPI_BYTE, MPI_STATUS_IGNORE);
+        ints.insert(ints.end(), tmpval.begin(), tmpval.begin()+n);
+        idxs.insert(idxs.end(), tmpidx.begin(), tmpidx.begin()+n);
+    }
+
+    MPI_File_close(&fh);
+
+    return true;
+=======
+void ERI::balance()
+{
+    int nproc = arena.size;
+
+    vector<int64_t> counts(nproc);
+    counts[arena.rank] = ints.size();
+    arena.comm().Allgather(counts);
+
+    int64_t total = 0, first = 0;
+    for (int i = 0;i < nproc;i++)
+    {
+        if (i < arena.rank) first += counts[i];
+        total += counts[i];
+    }
+
+    /*
+     * Integral number k overall goes to the process p with
+     * k in [p*total/nproc, (p+1)*total/nproc)
+     */
+    vector<MPI_Int> sendcount(nproc, 0);
+    vector<MPI_Int> recvcount(nproc, 0);
+
+    for (int i = 0;i < nproc;i++)
+    {
+        int64_t begin = max(first, (i*total)/nproc);
+        int64_t end = min(first+(int64_t)ints.size(), ((i+1)*total)/nproc);
+        if (end > begin) sendcount[i] = end-begin;
+    }
+
+    arena.comm().Alltoall(const_cast<const vector<MPI_Int>&>(sendcount), recvcount);
+
+    Datatype IDX4_T_TYPE = MPI_TYPE_<uint16_t>::value()*4;
+
+    vector<double> oldints(ints.begin(), ints.end());
+    vector<idx4_t> oldidxs(idxs.begin(), idxs.end());
+    vector<double> newints(sum(recvcount));
+    vector<idx4_t> newidxs(newints.size());
+
+    arena.comm().Alltoall(oldints, sendcount, newints, recvcount);
+    arena.comm().Alltoall(oldidxs, sendcount, newidxs, recvcount, IDX4_T_TYPE);
+
+    ints.assign(newints.begin(), newints.end());
+    idxs.assign(newidxs.begin(), newidxs.end());
+>>>>>>> 7d6f129 ([user-022] Balance shell quartets dynamically across processes)
+}
+
 }
 }
 
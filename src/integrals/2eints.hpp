@@ -11,7 +11,6 @@
 #include "shell.hpp"
 
 #define TMP_BUFSIZE 65536
-#define INTEGRAL_CUTOFF 1e-14
 
 #define IDX_EQ(i,r,e,j,s,f) ((i) == (j) && (r) == (s) && (e) == (f))
 #define IDX_GE(i,r,e,j,s,f) ((i) > (j) || ((i) == (j) && ((r) > (s) || ((r) == (s) && (e) >= (f)))))
@@ -114,11 +113,42 @@ class ERI : public task::Destructible, public Distributed
         ERI(const Arena& arena, const symmetry::PointGroup& group) : Distributed(arena), group(group) {}
 
         void print(task::Printer& p) const;
+
+        /*
+<<<<<<< HEAD
+         * Write the integrals to file, which may be read back on any number
+         * of processes, each of which gets an even share
+         */
+        void save(const string& file) const;
+
+        bool load(const string& file);
+=======
+         * Redistribute the integrals such that each process has the same
+         * number (to within one), keeping their overall order
+         */
+        void balance();
+>>>>>>> 7d6f129 ([user-022] Balance shell quartets dynamically across processes)
 };
 
 template <typename ERIType>
 class TwoElectronIntegralsTask : public task::Task
 {
+    protected:
+        double storage_cutoff, calc_cutoff;
+
+        /*
+         * Rough relative cost of a shell quartet: the number of primitive
+         * quartets times the number of Cartesian integrals in each,
+         * times the number of recursion steps
+         */
+        static double cost(const Shell& a, const Shell& b, const Shell& c, const Shell& d)
+        {
+            int la = a.getL(), lb = b.getL(), lc = c.getL(), ld = d.getL();
+            double nprim = a.getNPrim()*b.getNPrim()*c.getNPrim()*d.getNPrim();
+            double ncart = (la+1)*(la+2)*(lb+1)*(lb+2)*(lc+1)*(lc+2)*(ld+1)*(ld+2)/16;
+            return nprim*ncart*(la+lb+lc+ld+1);
+        }
+
     public:
         TwoElectronIntegralsTask(const string& name, input::Config& config)
         : task::Task(name, config)
@@ -126,6 +156,9 @@ class TwoElectronIntegralsTask : public task::Task
             vector<task::Requirement> reqs;
             reqs.push_back(task::Requirement("molecule", "molecule"));
             addProduct(task::Product("eri", "I", reqs));
+
+            storage_cutoff = config.get<double>("storage_cutoff");
+            calc_cutoff = config.get<double>("calc_cutoff");
         }
 
         bool run(task::TaskDAG& dag, const Arena& arena)
@@ -145,37 +178,146 @@ class TwoElectronIntegralsTask : public task::Task
             vector<vector<int>> idx = Shell::setupIndices(Context(), molecule);
             vector<Shell> shells(molecule.getShellsBegin(), molecule.getShellsEnd());
 
-            int abcd = 0;
-            for (int a = 0;a < shells.size();++a)
+            /*
+             * Cauchy-Schwarz estimates Q_ab = sqrt(max|(ab|ab)|) for each
+             * unique shell pair, such that every integral in (ab|cd) is
+             * bounded by Q_ab*Q_cd
+             */
+            int nshell = shells.size();
+            vector<double> schwarz(nshell*(nshell+1)/2, 0.0);
+
+            for (int a = 0, ab = 0;a < nshell;++a)
             {
-                for (int b = 0;b <= a;++b)
+                for (int b = 0;b <= a;++b, ++ab)
                 {
-                    for (int c = 0;c <= a;++c)
+                    if (ab%arena.size != arena.rank) continue;
+
+                    ERIType block(shells[a], shells[b], shells[a], shells[b]);
+                    block.run();
+
+                    double q = 0;
+                    for (double v : block.getIntegrals()) q = max(q, aquarius::abs(v));
+                    schwarz[ab] = sqrt(q);
+                }
+            }
+
+            arena.comm().Allreduce(schwarz.data(), schwarz.size(), MPI_MAX);
+
+            double qmax = 0;
+            for (double q : schwarz) qmax = max(qmax, q);
+
+            /*
+             * Keep only the shell pairs which can contribute a stored
+             * integral together with any other pair, in the same (a >= b)
+             * order as before
+             */
+            vector<pair<int,int>> pairs;
+            vector<double> qpairs;
+            for (int a = 0, ab = 0;a < nshell;++a)
+            {
+                for (int b = 0;b <= a;++b, ++ab)
+                {
+                    if (schwarz[ab]*qmax < storage_cutoff) continue;
+                    pairs.emplace_back(a, b);
+                    qpairs.push_back(schwarz[ab]);
+                }
+            }
+
+            /*
+             * Unique quartets are (ab|cd) with pair cd not after pair ab,
+             * of which only those which survive screening are kept
+             */
+            struct Quartet
+            {
+                int ab, cd;
+                double cost;
+            };
+
+            int64_t npair = nshell*(nshell+1)/2;
+            int64_t nquartet = npair*(npair+1)/2;
+            vector<Quartet> quartets;
+            for (int ab = 0;ab < pairs.size();++ab)
+            {
+                for (int cd = 0;cd <= ab;++cd)
+                {
+                    if (qpairs[ab]*qpairs[cd] < storage_cutoff) continue;
+                    quartets.push_back({ab, cd, cost(shells[pairs[ab].first], shells[pairs[ab].second],
+                                                     shells[pairs[cd].first], shells[pairs[cd].second])});
+                }
+            }
+
+            task::Logger::log(arena) << "Computing " << quartets.size() << " of " << nquartet <<
+                                        " shell quartets after Schwarz screening" << endl;
+
+            /*
+             * The most expensive quartets go first, and consecutive quartets
+             * are gathered into blocks of at most 1/16 of the average work
+             * per process (or a single quartet if it is larger), so that the
+             * cheap ones at the end do not each need a trip to the counter
+             */
+            stable_sort(quartets.begin(), quartets.end(),
+                        [](const Quartet& q1, const Quartet& q2) { return q1.cost > q2.cost; });
+
+            double total = 0;
+            for (auto& q : quartets) total += q.cost;
+            double target = total/(16*arena.size);
+
+            vector<int64_t> blocks(1, 0);
+            double work = 0;
+            for (int64_t i = 0;i < quartets.size();i++)
+            {
+                if (i > blocks.back() && work+quartets[i].cost > target)
+                {
+                    blocks.push_back(i);
+                    work = 0;
+                }
+                work += quartets[i].cost;
+            }
+            blocks.push_back(quartets.size());
+            int64_t nblock = blocks.size()-1;
+
+            /*
+             * Blocks are taken in turn by whichever process is free next,
+             * through an atomic counter held by the first process
+             */
+            Window counter = const_cast<Intracomm&>(arena.comm()).window(sizeof(int64_t));
+            counter.lock(MPI_MODE_NOCHECK);
+            if (arena.rank == 0)
+            {
+                *static_cast<int64_t*>(counter.data()) = 0;
+                counter.sync();
+            }
+            arena.comm().Barrier();
+
+            while (true)
+            {
+                int64_t one = 1, next;
+                counter.Get_accumulate(&one, &next, 1, 0, 0, MPI_SUM);
+                counter.flush(0);
+                if (next >= nblock) break;
+
+                for (int64_t i = blocks[next];i < blocks[next+1];i++)
+                {
+                    int a = pairs[quartets[i].ab].first;
+                    int b = pairs[quartets[i].ab].second;
+                    int c = pairs[quartets[i].cd].first;
+                    int d = pairs[quartets[i].cd].second;
+
+                    ERIType block(shells[a], shells[b], shells[c], shells[d]);
+                    block.accuracy(calc_cutoff);
+                    block.run();
+
+                    size_t n;
+                    while ((n = block.process(ctx, idx[a], idx[b], idx[c], idx[d],
+                                              TMP_BUFSIZE, tmpval.data(), tmpidx.data(), storage_cutoff)) != 0)
                     {
-                        int dmax = c;
-                        if (a == c) dmax = b;
-                        for (int d = 0;d <= dmax;++d)
-                        {
-                            if (abcd%arena.size == arena.rank)
-                            {
-                                ERIType block(shells[a], shells[b], shells[c], shells[d]);
-                                block.run();
-
-                                size_t n;
-                                while ((n = block.process(ctx, idx[a], idx[b], idx[c], idx[d],
-                                                          TMP_BUFSIZE, tmpval.data(), tmpidx.data(), INTEGRAL_CUTOFF)) != 0)
-                                {
-                                    eri->ints.insert(eri->ints.end(), tmpval.data(), tmpval.data()+n);
-                                    eri->idxs.insert(eri->idxs.end(), tmpidx.data(), tmpidx.data()+n);
-                                }
-                            }
-                            abcd++;
-                        }
+                        eri->ints.insert(eri->ints.end(), tmpval.data(), tmpval.data()+n);
+                        eri->idxs.insert(eri->idxs.end(), tmpidx.data(), tmpidx.data()+n);
                     }
                 }
             }
 
-            //TODO: load balance
+            counter.unlock();
 
             for (int i = 0;i < eri->ints.size();++i)
             {
@@ -190,10 +332,25 @@ class TwoElectronIntegralsTask : public task::Task
                 }
             }
 
+            eri->balance();
+
             put("I", eri);
 
             return true;
         }
+
+        bool checkpoint(const string& path, const Arena& arena)
+        {
+            get<ERI>("I").save(path + ".I");
+            return true;
+        }
+
+        bool restore(const string& path, const Arena& arena)
+        {
+            const auto& molecule = get<input::Molecule>("molecule");
+
+            return put("I", new ERI(arena, molecule.getGroup())).load(path + ".I");
+        }
 };
 
 class OSERI;
@@ -2,6 +2,7 @@
 
 #include "tensor/symblocked_tensor.hpp"
 #include "time/time.hpp"
+#include "time/ledger.hpp"
 #include "task/task.hpp"
 
 #ifdef HAVE_LIBINT2
@@ -160,6 +161,16 @@ int main(int argc, char **argv)
         }
 
         Timer::printTimers(world());
+        tensor::printPoolStatistics(world());
+
+        #ifdef PROFILE
+        Ledger::printReport(world());
+        if (argc >= 2) Ledger::writeTrace(string(argv[1]) + ".trace.json", world());
+        #endif
+
+        tensor::CTFTensor<float>::clearPool();
+        tensor::CTFTensor<double>::clearPool();
+        tensor::CTFTensor<complex<double>>::clearPool();
     }
 
     #ifdef HAVE_LIBINT2
@@ -15,7 +15,8 @@ namespace op
 
 template <typename T, typename Derived>
 class OneElectronOperatorBase : public MOOperator,
-    public tensor::CompositeTensor<Derived,tensor::SpinorbitalTensor<T>,T>
+    public tensor::CompositeTensor<Derived,tensor::SpinorbitalTensor<T>,T>,
+    public task::Relocatable
 {
     INHERIT_FROM_COMPOSITE_TENSOR(Derived,tensor::SpinorbitalTensor<T>,T)
 
@@ -25,6 +26,34 @@ class OneElectronOperatorBase : public MOOperator,
         tensor::SpinorbitalTensor<T>& ai;
         tensor::SpinorbitalTensor<T>& ia;
 
+        /*
+         * Describe and create operators of type Op, which are constructed
+         * from only a name, arena and spaces (see task::Relocatable::describe)
+         */
+        template <typename Op>
+        bool describeAs(string& type, string& shape) const
+        {
+            if (typeid(*this) != typeid(Op)) return false;
+
+            ostringstream os;
+            this->describeSpaces(this->name, os);
+
+            type = typeid(Op).name();
+            shape = os.str();
+            return RelocatableOperator<Op>::registered;
+        }
+
+        template <typename Op>
+        static task::Destructible* createAs(const string& shape, const Arena& arena)
+        {
+            istringstream is(shape);
+            string name = readName(is);
+            Space occ = Space::read(is);
+            Space vrt = Space::read(is);
+
+            return new task::Resource<Op>(new Op(name, arena, occ, vrt));
+        }
+
     public:
         enum
         {
@@ -137,6 +166,32 @@ class OneElectronOperatorBase : public MOOperator,
           ai(this->addTensor(new tensor::SpinorbitalTensor<T>(name, other.getAI()))),
           ia(this->addTensor(new tensor::SpinorbitalTensor<T>(name, other.getIA()))) {}
 
+        task::Relocatable* relocated(const Arena& arena) const
+        {
+            return new Derived(this->name, arena, occ, vrt);
+        }
+
+        void copyInto(task::Relocatable* other) const
+        {
+            this->copyTo(dynamic_cast<Derived*>(other));
+        }
+
+        void copyFrom(const task::Relocatable* other)
+        {
+            tensor::CompositeTensor<Derived,tensor::SpinorbitalTensor<T>,T>::
+                copyFrom(dynamic_cast<const Derived*>(other));
+        }
+
+        bool describe(string& type, string& shape) const
+        {
+            return describeAs<Derived>(type, shape);
+        }
+
+        static task::Destructible* create(const string& shape, const Arena& arena)
+        {
+            return createAs<Derived>(shape, arena);
+        }
+
         tensor::SpinorbitalTensor<T>& getAB() { return ab; }
         tensor::SpinorbitalTensor<T>& getIJ() { return ij; }
         tensor::SpinorbitalTensor<T>& getAI() { return ai; }
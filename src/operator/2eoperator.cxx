@@ -121,7 +121,7 @@ T TwoElectronOperator<T>::dot(bool conja, const TwoElectronOperator<T>& A, bool
     return sum;
 }
 
-INSTANTIATE_SPECIALIZATIONS(TwoElectronOperator);
+INSTANTIATE_ALL_SPECIALIZATIONS(TwoElectronOperator);
 
 }
 }
@@ -1078,16 +1078,19 @@ bool AOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     /*
      * Read transformation coefficients
      */
+    vector<vector<int>> irreps;
+    for (int i = 0;i < n;i++) irreps.push_back({i,i});
+
+    cA_.getAllData(irreps, cA);
+    ca_.getAllData(irreps, ca);
+    cI_.getAllData(irreps, cI);
+    ci_.getAllData(irreps, ci);
+
     for (int i = 0;i < n;i++)
     {
-        vector<int> irreps = {i,i};
-        cA_.getAllData(irreps, cA[i]);
         assert(cA[i].size() == N[i]*nA[i]);
-        ca_.getAllData(irreps, ca[i]);
         assert(ca[i].size() == N[i]*na[i]);
-        cI_.getAllData(irreps, cI[i]);
         assert(cI[i].size() == N[i]*nI[i]);
-        ci_.getAllData(irreps, ci[i]);
         assert(ci[i].size() == N[i]*ni[i]);
     }
 
@@ -18,20 +18,22 @@ template <typename T, int np, int nh=np>
 class ExcitationOperator
 : public MOOperator,
   public tensor::CompositeTensor< ExcitationOperator<T,np,nh>,
-                                  tensor::SpinorbitalTensor<T>, T >
+                                  tensor::SpinorbitalTensor<T>, T >,
+  public task::Relocatable
 {
     INHERIT_FROM_COMPOSITE_TENSOR(CONCAT(ExcitationOperator<T,np,nh>),
                                   tensor::SpinorbitalTensor<T>, T)
 
     protected:
         const int spin;
+        const symmetry::Representation rep;
 
     public:
         ExcitationOperator(const string& name, const Arena& arena, const Space& occ, const Space& vrt, int spin=0)
         : MOOperator(arena, occ, vrt),
           tensor::CompositeTensor< ExcitationOperator<T,np,nh>,
            tensor::SpinorbitalTensor<T>, T >(name, max(np,nh)+1),
-          spin(spin)
+          spin(spin), rep(occ.group)
         {
             for (int ex = 0;ex <= min(np,nh);ex++)
             {
@@ -49,7 +51,7 @@ class ExcitationOperator
         : MOOperator(arena, occ, vrt),
           tensor::CompositeTensor< ExcitationOperator<T,np,nh>,
            tensor::SpinorbitalTensor<T>, T >(name, max(np,nh)+1),
-          spin(spin)
+          spin(spin), rep(rep)
         {
             for (int ex = 0;ex <= min(np,nh);ex++)
             {
@@ -62,6 +64,50 @@ class ExcitationOperator
             }
         }
 
+        task::Relocatable* relocated(const Arena& arena) const
+        {
+            return new ExcitationOperator<T,np,nh>(this->name, arena, occ, vrt, rep, spin);
+        }
+
+        void copyInto(task::Relocatable* other) const
+        {
+            this->copyTo(dynamic_cast<ExcitationOperator<T,np,nh>*>(other));
+        }
+
+        void copyFrom(const task::Relocatable* other)
+        {
+            tensor::CompositeTensor< ExcitationOperator<T,np,nh>, tensor::SpinorbitalTensor<T>, T >::
+                copyFrom(dynamic_cast<const ExcitationOperator<T,np,nh>*>(other));
+        }
+
+        bool describe(string& type, string& shape) const
+        {
+            int irrep = irrepIndex(rep);
+            if (irrep == -1) return false;
+
+            ostringstream os;
+            describeSpaces(this->name, os);
+            os << irrep << ' ' << spin;
+
+            type = typeid(ExcitationOperator<T,np,nh>).name();
+            shape = os.str();
+            return RelocatableOperator<ExcitationOperator<T,np,nh>>::registered;
+        }
+
+        static task::Destructible* create(const string& shape, const Arena& arena)
+        {
+            istringstream is(shape);
+            string name = readName(is);
+            Space occ = Space::read(is);
+            Space vrt = Space::read(is);
+
+            int irrep, spin;
+            is >> irrep >> spin;
+
+            return new task::Resource<ExcitationOperator<T,np,nh>>(
+                new ExcitationOperator<T,np,nh>(name, arena, occ, vrt, occ.group.getIrrep(irrep), spin));
+        }
+
         void weight(const Denominator<T>& d, double shift = 0)
         {
             vector<const vector<vector<T>>*> da{&d.getDA(), &d.getDI()};
@@ -74,6 +120,26 @@ class ExcitationOperator
             }
         }
 
+        /*
+         * Weight this operator and add the result to B in the same pass (the
+         * scalar part, which is not weighted, is simply added)
+         */
+        void weightAndAdd(const Denominator<T>& d, ExcitationOperator<T,np,nh>& B, double shift = 0)
+        {
+            vector<const vector<vector<T>>*> da{&d.getDA(), &d.getDI()};
+            vector<const vector<vector<T>>*> db{&d.getDa(), &d.getDi()};
+
+            for (int ex = 0;ex <= min(np,nh);ex++)
+            {
+                if (ex == 0 && np == nh)
+                {
+                    B(0) += (*this)(0);
+                    continue;
+                }
+                tensors[ex+abs(np-nh)].tensor->weightAndAdd(da, db, B(ex+abs(np-nh)), shift);
+            }
+        }
+
         T dot(bool conja, const op::ExcitationOperator<T,np,nh>& A, bool conjb) const
         {
             T s = (T)0;
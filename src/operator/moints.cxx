@@ -22,6 +22,22 @@ MOIntegrals<T>::MOIntegrals(const string& name, Config& config)
     addProduct("moints", "H", reqs);
 }
 
+template <typename T>
+bool MOIntegrals<T>::checkpoint(const string& path, const Arena& arena)
+{
+    this->template get<TwoElectronOperator<T>>("H").save(path + ".H");
+    return true;
+}
+
+template <typename T>
+bool MOIntegrals<T>::restore(const string& path, const Arena& arena)
+{
+    const auto& occ = this->template get<MOSpace<T>>("occ");
+    const auto& vrt = this->template get<MOSpace<T>>("vrt");
+
+    return this->put("H", new TwoElectronOperator<T>("V", arena, occ, vrt)).load(path + ".H");
+}
+
 INSTANTIATE_SPECIALIZATIONS(MOIntegrals);
 
 }
@@ -17,6 +17,11 @@ class MOIntegrals : public task::Task
 {
     protected:
         MOIntegrals(const string& name, input::Config& config);
+
+    public:
+        bool checkpoint(const string& path, const Arena& arena);
+
+        bool restore(const string& path, const Arena& arena);
 };
 
 }
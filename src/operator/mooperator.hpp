@@ -12,6 +12,20 @@ namespace aquarius
 namespace op
 {
 
+/*
+ * Registers Op::create as the factory for operators of type Op (see
+ * task::registerRelocatable), once Op::describe is instantiated
+ */
+template <typename Op>
+struct RelocatableOperator
+{
+    static const bool registered;
+};
+
+template <typename Op>
+const bool RelocatableOperator<Op>::registered =
+    task::registerRelocatable(typeid(Op).name(), &Op::create);
+
 class MOOperator : public Distributed
 {
     public:
@@ -20,6 +34,47 @@ class MOOperator : public Distributed
 
         MOOperator(const Arena& arena, const Space& occ, const Space& vrt)
         : Distributed(arena), occ(occ), vrt(vrt) {}
+
+    protected:
+        /*
+         * Write the name and spaces of an operator at the start of its shape
+         * (see task::Relocatable::describe), and read the name back. The
+         * spaces follow as written by Space::write.
+         */
+        void describeSpaces(const string& name, ostream& os) const
+        {
+            os << name.size() << ' ' << name << ' ';
+            occ.write(os);
+            vrt.write(os);
+        }
+
+        /*
+         * The index of the irrep rep, or -1 if it is reducible
+         */
+        static int irrepIndex(const symmetry::Representation& rep)
+        {
+            if (rep.isReducible()) return -1;
+
+            const symmetry::PointGroup& group = rep.getPointGroup();
+            for (int i = 0;i < group.getNumIrreps();i++)
+            {
+                if (rep.transformsAs(group.getIrrep(i))) return i;
+            }
+
+            return -1;
+        }
+
+        static string readName(istream& is)
+        {
+            int len;
+            is >> len;
+            is.get();
+
+            string name(len, ' ');
+            is.read(&name[0], len);
+
+            return name;
+        }
 };
 
 }
@@ -161,6 +161,11 @@ class PerturbedSTTwoElectronOperator : public STTwoElectronOperator<U>
             this->abij["abij"] += 0.5*X.getIJKL()["mnij"]*TA(2)["abmn"];
             this->abij["abij"] -= X.getAIBJ()["amei"]*TA(2)["ebmj"];
         }
+
+        /*
+         * Refers to X and TA
+         */
+        bool canRelocate() const { return false; }
 };
 
 }
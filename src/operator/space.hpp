@@ -39,6 +39,32 @@ struct Space
     {
         return nalpha == other.nalpha && nbeta == other.nbeta;
     }
+
+    /*
+     * Write the space as text and read it back, for use in
+     * Relocatable::describe
+     */
+    void write(ostream& os) const
+    {
+        os << group.getName();
+        for (int n : nalpha) os << ' ' << n;
+        for (int n : nbeta) os << ' ' << n;
+        os << ' ';
+    }
+
+    static Space read(istream& is)
+    {
+        string name;
+        is >> name;
+
+        const symmetry::PointGroup& group = symmetry::PointGroup::byName(name);
+
+        vector<int> nalpha(group.getNumIrreps()), nbeta(group.getNumIrreps());
+        for (int& n : nalpha) is >> n;
+        for (int& n : nbeta) is >> n;
+
+        return Space(group, nalpha, nbeta);
+    }
 };
 
 template <class T>
@@ -69,12 +69,15 @@ bool SparseRHFAOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     /*
      * Read transformation coefficients
      */
+    vector<vector<int>> irreps;
+    for (int i = 0;i < n;i++) irreps.push_back({i,i});
+
+    cA_.getAllData(irreps, cA);
+    cI_.getAllData(irreps, cI);
+
     for (int i = 0;i < n;i++)
     {
-        vector<int> irreps = {i,i};
-        cA_.getAllData(irreps, cA[i]);
         assert(cA[i].size() == N[i]*nA[i]);
-        cI_.getAllData(irreps, cI[i]);
         assert(cI[i].size() == N[i]*nI[i]);
     }
 
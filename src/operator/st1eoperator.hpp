@@ -20,11 +20,29 @@ template <typename U>
 class STOneElectronOperator : public OneElectronOperator<U>
 {
     public:
+        STOneElectronOperator(const string& name, const Arena& arena, const Space& occ, const Space& vrt)
+        : OneElectronOperator<U>(name, arena, occ, vrt) {}
+
         template <int N>
         STOneElectronOperator(const string& name, const OneElectronOperator<U>& X, const ExcitationOperator<U,N>& T);
 
         template <int N>
         STOneElectronOperator(const string& name, const TwoElectronOperator<U>& X, const ExcitationOperator<U,N>& T);
+
+        task::Relocatable* relocated(const Arena& arena) const
+        {
+            return new STOneElectronOperator<U>(this->name, arena, this->occ, this->vrt);
+        }
+
+        bool describe(string& type, string& shape) const
+        {
+            return this->template describeAs<STOneElectronOperator<U>>(type, shape);
+        }
+
+        static task::Destructible* create(const string& shape, const Arena& arena)
+        {
+            return OneElectronOperatorBase<U,OneElectronOperator<U>>::template createAs<STOneElectronOperator<U>>(shape, arena);
+        }
 };
 
 template <typename U> template <int N>
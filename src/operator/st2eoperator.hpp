@@ -23,6 +23,9 @@ template <typename U>
 class STTwoElectronOperator : public TwoElectronOperator<U>
 {
     public:
+        STTwoElectronOperator(const string& name, const Arena& arena, const Space& occ, const Space& vrt)
+        : TwoElectronOperator<U>(name, arena, occ, vrt) {}
+
         template <int N>
         STTwoElectronOperator(const string& name, const OneElectronOperator<U>& X, const ExcitationOperator<U,N>& T)
         : TwoElectronOperator<U>(name, X)
@@ -151,6 +154,21 @@ class STTwoElectronOperator : public TwoElectronOperator<U>
                 this->abij["abij"] += 0.25*this->ijab["mnef"]*T(4)["abefijmn"];
             }
         }
+
+        task::Relocatable* relocated(const Arena& arena) const
+        {
+            return new STTwoElectronOperator<U>(this->name, arena, this->occ, this->vrt);
+        }
+
+        bool describe(string& type, string& shape) const
+        {
+            return this->template describeAs<STTwoElectronOperator<U>>(type, shape);
+        }
+
+        static task::Destructible* create(const string& shape, const Arena& arena)
+        {
+            return OneElectronOperatorBase<U,TwoElectronOperator<U>>::template createAs<STTwoElectronOperator<U>>(shape, arena);
+        }
 };
 
 }
@@ -47,37 +47,43 @@ void AOUHF<T,WhichUHF>::buildFock()
     vector<vector<T>> densa(nirrep), densb(nirrep);
     vector<vector<T>> densab(nirrep);
 
+    /*
+     * Read all of the blocks of H, Da, and Db at once
+     */
+    vector<const CTFTensor<T>*> blocks;
+    for (int i = 0;i < nirrep;i++) blocks.push_back(&H({i,i}));
+    for (int i = 0;i < nirrep;i++) blocks.push_back(&Da({i,i}));
+    for (int i = 0;i < nirrep;i++) blocks.push_back(&Db({i,i}));
+
+    vector<vector<T>> vals;
+    CTFTensor<T>::getAllData(blocks, vals);
+
     for (int i = 0;i < nirrep;i++)
     {
-        vector<int> irreps(2,i);
-
+        /*
+         * The core Hamiltonian is added in only once when the partial Fock
+         * matrices are summed
+         */
         if (arena.rank == 0)
         {
-            H.getAllData(irreps, focka[i], 0);
+            focka[i] = vals[i];
             assert(focka[i].size() == norb[i]*norb[i]);
             fockb[i] = focka[i];
         }
         else
         {
-            H.getAllData(irreps, 0);
             focka[i].resize(norb[i]*norb[i], (T)0);
             fockb[i].resize(norb[i]*norb[i], (T)0);
         }
 
-        Da.getAllData(irreps, densa[i]);
-        assert(densa[i].size() == norb[i]*norb[i]);
-        Db.getAllData(irreps, densb[i]);
+        densa[i] = move(vals[nirrep+i]);
         assert(densa[i].size() == norb[i]*norb[i]);
+        densb[i] = move(vals[2*nirrep+i]);
+        assert(densb[i].size() == norb[i]*norb[i]);
 
         densab[i] = densa[i];
         //PROFILE_FLOPS(norb[i]*norb[i]);
         axpy(norb[i]*norb[i], 1.0, densb[i].data(), 1, densab[i].data(), 1);
-
-        if (Da.norm(2) > 1e-10)
-        {
-            //fill(focka[i].begin(), focka[i].end(), 0.0);
-            //fill(fockb[i].begin(), fockb[i].end(), 0.0);
-        }
     }
 
     auto& eris = ints.ints;
@@ -220,44 +226,18 @@ void AOUHF<T,WhichUHF>::buildFock()
         }
     }
 
-    for (int i = 0;i < nirrep;i++)
-    {
-        vector<int> irreps(2,i);
-
-        if (arena.rank == 0)
-        {
-            //PROFILE_FLOPS(2*norb[i]*norb[i]);
-            arena.comm().Reduce(focka[i], MPI_SUM);
-            arena.comm().Reduce(fockb[i], MPI_SUM);
+    /*
+     * Sum the partial Fock matrices and write all of the blocks of Fa and Fb
+     * at once
+     */
+    vector<CTFTensor<T>*> fblocks;
+    for (int i = 0;i < nirrep;i++) fblocks.push_back(&Fa({i,i}));
+    for (int i = 0;i < nirrep;i++) fblocks.push_back(&Fb({i,i}));
 
-            vector<tkv_pair<T>> pairs(norb[i]*norb[i]);
+    vals = move(focka);
+    vals.insert(vals.end(), fockb.begin(), fockb.end());
 
-            for (int p = 0;p < norb[i]*norb[i];p++)
-            {
-                pairs[p].d = focka[i][p];
-                pairs[p].k = p;
-            }
-
-            Fa.writeRemoteData(irreps, pairs);
-
-            for (int p = 0;p < norb[i]*norb[i];p++)
-            {
-                pairs[p].d = fockb[i][p];
-                pairs[p].k = p;
-            }
-
-            Fb.writeRemoteData(irreps, pairs);
-        }
-        else
-        {
-            //PROFILE_FLOPS(2*norb[i]*norb[i]);
-            arena.comm().Reduce(focka[i], MPI_SUM, 0);
-            arena.comm().Reduce(fockb[i], MPI_SUM, 0);
-
-            Fa.writeRemoteData(irreps);
-            Fb.writeRemoteData(irreps);
-        }
-    }
+    CTFTensor<T>::sumAllData(fblocks, vals);
 }
 
 }
@@ -282,7 +262,9 @@ static const char* spec = R"(
         order?
             int 6,
         jacobi?
-            bool false
+            bool false,
+        history?
+            enum { memory, single, disk }
     }
 
 )";
@@ -188,6 +188,134 @@ bool UHF<T>::run(TaskDAG& dag, const Arena& arena)
     return true;
 }
 
+/*
+ * Besides the tensors themselves, the sizes of the occupied and virtual
+ * spaces and the orbital energies are written by the root process to
+ * path.spaces
+ */
+template <typename T>
+bool UHF<T>::checkpoint(const string& path, const Arena& arena)
+{
+    const auto& occ = this->template get<MOSpace<T>>("occ");
+    const auto& vrt = this->template get<MOSpace<T>>("vrt");
+    const auto& Ea = this->template get<vector<vector<real_type_t<T>>>>("Ea");
+    const auto& Eb = this->template get<vector<vector<real_type_t<T>>>>("Eb");
+
+    this->template get<SymmetryBlockedTensor<T>>("Fa").save(path + ".Fa");
+    this->template get<SymmetryBlockedTensor<T>>("Fb").save(path + ".Fb");
+    this->template get<SymmetryBlockedTensor<T>>("Da").save(path + ".Da");
+    this->template get<SymmetryBlockedTensor<T>>("Db").save(path + ".Db");
+    occ.Calpha.save(path + ".CI");
+    occ.Cbeta.save(path + ".Ci");
+    vrt.Calpha.save(path + ".CA");
+    vrt.Cbeta.save(path + ".Ca");
+
+    if (arena.rank == 0)
+    {
+        ofstream ofs(path + ".spaces", std::ios::binary);
+
+        for (const vector<int>* n : {&occ.nalpha, &occ.nbeta, &vrt.nalpha, &vrt.nbeta})
+        {
+            ofs.write(reinterpret_cast<const char*>(n->data()), sizeof(int)*n->size());
+        }
+
+        for (const auto& E : Ea)
+            ofs.write(reinterpret_cast<const char*>(E.data()), sizeof(real_type_t<T>)*E.size());
+        for (const auto& E : Eb)
+            ofs.write(reinterpret_cast<const char*>(E.data()), sizeof(real_type_t<T>)*E.size());
+    }
+
+    this->saveIterations(path, arena);
+    this->saveScalars(path, arena);
+
+    return true;
+}
+
+template <typename T>
+bool UHF<T>::restore(const string& path, const Arena& arena)
+{
+    const Molecule& molecule = this->template get<Molecule>("molecule");
+    const PointGroup& group = molecule.getGroup();
+    int nirrep = group.getNumIrreps();
+
+    const vector<int>& norb = molecule.getNumOrbitals();
+    vector<int> nocca(nirrep), noccb(nirrep), nvrta(nirrep), nvrtb(nirrep);
+    vector<vector<real_type_t<T>>> Ea(nirrep), Eb(nirrep);
+
+    int ok = 0;
+    if (arena.rank == 0)
+    {
+        ifstream ifs(path + ".spaces", std::ios::binary);
+
+        for (vector<int>* n : {&nocca, &noccb, &nvrta, &nvrtb})
+        {
+            ifs.read(reinterpret_cast<char*>(n->data()), sizeof(int)*nirrep);
+        }
+
+        for (int i = 0;ifs && i < nirrep;i++)
+        {
+            if (nocca[i] < 0 || nvrta[i] < 0 || noccb[i] < 0 || nvrtb[i] < 0 ||
+                nocca[i]+nvrta[i] > norb[i] || noccb[i]+nvrtb[i] > norb[i])
+                ifs.setstate(std::ios::failbit);
+        }
+
+        for (int i = 0;ifs && i < nirrep;i++)
+        {
+            Ea[i].resize(nocca[i]+nvrta[i]);
+            ifs.read(reinterpret_cast<char*>(Ea[i].data()), sizeof(real_type_t<T>)*Ea[i].size());
+        }
+
+        for (int i = 0;ifs && i < nirrep;i++)
+        {
+            Eb[i].resize(noccb[i]+nvrtb[i]);
+            ifs.read(reinterpret_cast<char*>(Eb[i].data()), sizeof(real_type_t<T>)*Eb[i].size());
+        }
+
+        ok = (bool)ifs;
+    }
+
+    arena.comm().Bcast(&ok, 1, 0);
+    if (!ok) return false;
+
+    for (vector<int>* n : {&nocca, &noccb, &nvrta, &nvrtb})
+    {
+        arena.comm().Bcast(*n, 0);
+    }
+
+    for (int i = 0;i < nirrep;i++)
+    {
+        Ea[i].resize(nocca[i]+nvrta[i]);
+        Eb[i].resize(noccb[i]+nvrtb[i]);
+        arena.comm().Bcast(Ea[i], 0);
+        arena.comm().Bcast(Eb[i], 0);
+    }
+
+    vector<int> shapeNN = {NS,NS};
+    vector<vector<int>> sizenn = {norb,norb};
+
+    auto& Fa = this->put("Fa", new SymmetryBlockedTensor<T>("Fa", arena, group, 2, sizenn, shapeNN, false));
+    auto& Fb = this->put("Fb", new SymmetryBlockedTensor<T>("Fb", arena, group, 2, sizenn, shapeNN, false));
+    auto& Da = this->put("Da", new SymmetryBlockedTensor<T>("Da", arena, group, 2, sizenn, shapeNN, false));
+    auto& Db = this->put("Db", new SymmetryBlockedTensor<T>("Db", arena, group, 2, sizenn, shapeNN, false));
+
+    SymmetryBlockedTensor<T> CI("CI", arena, group, 2, {norb,nocca}, shapeNN, false);
+    SymmetryBlockedTensor<T> Ci("Ci", arena, group, 2, {norb,noccb}, shapeNN, false);
+    SymmetryBlockedTensor<T> CA("CA", arena, group, 2, {norb,nvrta}, shapeNN, false);
+    SymmetryBlockedTensor<T> Ca("Ca", arena, group, 2, {norb,nvrtb}, shapeNN, false);
+
+    if (!Fa.load(path + ".Fa") || !Fb.load(path + ".Fb") ||
+        !Da.load(path + ".Da") || !Db.load(path + ".Db") ||
+        !CI.load(path + ".CI") || !Ci.load(path + ".Ci") ||
+        !CA.load(path + ".CA") || !Ca.load(path + ".Ca")) return false;
+
+    this->put("occ", new MOSpace<T>(move(CI), move(Ci)));
+    this->put("vrt", new MOSpace<T>(move(CA), move(Ca)));
+    this->put("Ea", new vector<vector<real_type_t<T>>>(move(Ea)));
+    this->put("Eb", new vector<vector<real_type_t<T>>>(move(Eb)));
+
+    return this->loadIterations(path, arena) && this->loadScalars(path, arena);
+}
+
 template <typename T>
 void UHF<T>::iterate(const Arena& arena)
 {
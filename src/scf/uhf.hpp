@@ -34,6 +34,10 @@ class UHF : public Iterative<T>
 
         bool run(task::TaskDAG& dag, const Arena& arena);
 
+        bool checkpoint(const string& path, const Arena& arena);
+
+        bool restore(const string& path, const Arena& arena);
+
     protected:
         virtual void calcSMinusHalf() = 0;
 
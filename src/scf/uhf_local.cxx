@@ -17,17 +17,24 @@ template <typename T>
 LocalUHF<T>::LocalUHF(const string& name, Config& config)
 : UHF<T>(name, config) {}
 
+/*
+ * Each irrep is handled by one process, which writes its contribution to the
+ * result; all blocks are read and written with a single collective each
+ */
 template <typename T>
 void LocalUHF<T>::calcSMinusHalf()
 {
     const Molecule& molecule = this->template get<Molecule>("molecule");
 
     const vector<int>& norb = molecule.getNumOrbitals();
+    int nirrep = molecule.getGroup().getNumIrreps();
 
     auto& S = this->template get<SymmetryBlockedTensor<T>>("S");
     auto& Smhalf = this->template gettmp<SymmetryBlockedTensor<T>>("S^-1/2");
 
-    for (int i = 0;i < molecule.getGroup().getNumIrreps();i++)
+    const Arena& arena = S.arena;
+
+    for (int i = 0;i < nirrep;i++)
     {
         //cout << "S " << (i+1) << endl;
         //vector<T> vals;
@@ -35,48 +42,34 @@ void LocalUHF<T>::calcSMinusHalf()
         //printmatrix(norb[i], norb[i], vals.data(), 6, 3, 108);
     }
 
-    for (int i = 0;i < molecule.getGroup().getNumIrreps();i++)
-    {
-        if (norb[i] == 0) continue;
+    vector<vector<int>> irreps;
+    for (int i = 0;i < nirrep;i++) irreps.push_back({i,i});
 
-        vector<int> irreps(2,i);
-        vector<real_type_t<T>> E(norb[i]);
-
-        if (S.arena.rank == 0)
-        {
-            vector<T> s;
-            vector<T> smhalf(norb[i]*norb[i]);
+    vector<vector<T>> s, smhalf(nirrep);
+    S.getAllData(irreps, s);
 
-            S.getAllData(irreps, s, 0);
-            assert(s.size() == norb[i]*norb[i]);
+    for (int i = 0;i < nirrep;i++)
+    {
+        smhalf[i].assign(norb[i]*norb[i], (T)0);
 
-            //PROFILE_FLOPS(26*norb[i]*norb[i]*norb[i]);
-            int info = heev('V', 'U', norb[i], s.data(), norb[i], E.data());
-            assert(info == 0);
+        if (norb[i] == 0 || i%arena.size != arena.rank) continue;
 
-            fill(smhalf.begin(), smhalf.end(), (T)0);
-            //PROFILE_FLOPS(2*norb[i]*norb[i]*norb[i]);
-            for (int j = 0;j < norb[i];j++)
-            {
-                ger(norb[i], norb[i], 1/sqrt(E[j]), &s[j*norb[i]], 1, &s[j*norb[i]], 1, smhalf.data(), norb[i]);
-            }
+        vector<real_type_t<T>> E(norb[i]);
 
-            vector<tkv_pair<T>> pairs(norb[i]*norb[i]);
+        assert(s[i].size() == norb[i]*norb[i]);
 
-            for (int j = 0;j < norb[i]*norb[i];j++)
-            {
-                pairs[j].k = j;
-                pairs[j].d = smhalf[j];
-            }
+        //PROFILE_FLOPS(26*norb[i]*norb[i]*norb[i]);
+        int info = heev('V', 'U', norb[i], s[i].data(), norb[i], E.data());
+        assert(info == 0);
 
-            Smhalf.writeRemoteData(irreps, pairs);
-        }
-        else
+        //PROFILE_FLOPS(2*norb[i]*norb[i]*norb[i]);
+        for (int j = 0;j < norb[i];j++)
         {
-            S.getAllData(irreps, 0);
-            Smhalf.writeRemoteData(irreps);
+            ger(norb[i], norb[i], 1/sqrt(E[j]), &s[i][j*norb[i]], 1, &s[i][j*norb[i]], 1, smhalf[i].data(), norb[i]);
         }
     }
+
+    Smhalf.sumAllData(irreps, smhalf);
 }
 
 template <typename T>
@@ -85,6 +78,7 @@ void LocalUHF<T>::diagonalizeFock()
     const Molecule& molecule = this->template get<Molecule>("molecule");
 
     const vector<int>& norb = molecule.getNumOrbitals();
+    int nirrep = molecule.getGroup().getNumIrreps();
 
     auto& S  = this->template get   <SymmetryBlockedTensor<T>>("S");
     auto& Fa = this->template get   <SymmetryBlockedTensor<T>>("Fa");
@@ -92,7 +86,9 @@ void LocalUHF<T>::diagonalizeFock()
     auto& Ca = this->template gettmp<SymmetryBlockedTensor<T>>("Ca");
     auto& Cb = this->template gettmp<SymmetryBlockedTensor<T>>("Cb");
 
-    for (int i = 0;i < molecule.getGroup().getNumIrreps();i++)
+    const Arena& arena = S.arena;
+
+    for (int i = 0;i < nirrep;i++)
     {
         //cout << "F " << (i+1) << endl;
         //vector<T> vals;
@@ -100,71 +96,90 @@ void LocalUHF<T>::diagonalizeFock()
         //printmatrix(norb[i], norb[i], vals.data(), 6, 3, 108);
     }
 
-    for (int i = 0;i < molecule.getGroup().getNumIrreps();i++)
+    /*
+     * Read all of the blocks of S, Fa, and Fb at once
+     */
+    vector<const CTFTensor<T>*> blocks;
+    for (int i = 0;i < nirrep;i++) blocks.push_back(&S({i,i}));
+    for (int i = 0;i < nirrep;i++) blocks.push_back(&Fa({i,i}));
+    for (int i = 0;i < nirrep;i++) blocks.push_back(&Fb({i,i}));
+
+    vector<vector<T>> vals;
+    CTFTensor<T>::getAllData(blocks, vals);
+
+    /*
+     * The eigenvalues and vectors are zero except on the process which
+     * handles each irrep, and are then summed
+     */
+    vector<vector<T>> coef(2*nirrep);
+    vector<real_type_t<T>> energies;
+
+    for (int i = 0;i < nirrep;i++)
     {
-        if (norb[i] == 0) continue;
+        E_alpha[i].assign(norb[i], 0);
+        E_beta[i].assign(norb[i], 0);
+        coef[       i].assign(norb[i]*norb[i], (T)0);
+        coef[nirrep+i].assign(norb[i]*norb[i], (T)0);
+
+        if (norb[i] == 0 || i%arena.size != arena.rank) continue;
 
-        vector<int> irreps(2,i);
+        const vector<T>& s = vals[i];
+        assert(s.size() == norb[i]*norb[i]);
 
-        if (S.arena.rank == 0)
+        for (int spin : {0,1})
         {
-            vector<T> s;
-            S.getAllData(irreps, s, 0);
-            assert(s.size() == norb[i]*norb[i]);
+            auto& E = (spin == 0 ? E_alpha[i] : E_beta[i]);
 
-            for (int spin : {0,1})
+            int info;
+            vector<T>& fock = vals[(spin+1)*nirrep+i];
+            vector<T> tmp(s);
+
+            assert(fock.size() == norb[i]*norb[i]);
+            //PROFILE_FLOPS(9*norb[i]*norb[i]*norb[i]);
+            info = hegv(AXBX, 'V', 'U', norb[i], fock.data(), norb[i], tmp.data(), norb[i], E.data());
+            assert(info == 0);
+
+            for (int j = 0;j < norb[i];j++)
             {
-                auto& F = (spin == 0 ? Fa : Fb);
-                auto& C = (spin == 0 ? Ca : Cb);
-                auto& E = (spin == 0 ? E_alpha[i] : E_beta[i]);
-
-                int info;
-                vector<T> fock, ctsc(norb[i]*norb[i]);
-                vector<tkv_pair<T>> pairs(norb[i]*norb[i]);
-                vector<T> tmp(s);
-
-                F.getAllData(irreps, fock, 0);
-                assert(fock.size() == norb[i]*norb[i]);
-                //PROFILE_FLOPS(9*norb[i]*norb[i]*norb[i]);
-                info = hegv(AXBX, 'V', 'U', norb[i], fock.data(), norb[i], tmp.data(), norb[i], E.data());
-                assert(info == 0);
-                S.arena.comm().Bcast(E);
-
-                for (int j = 0;j < norb[i];j++)
+                T sign = 0;
+                for (int k = 0;k < norb[i];k++)
                 {
-                    T sign = 0;
-                    for (int k = 0;k < norb[i];k++)
+                    if (aquarius::abs(fock[k+j*norb[i]]) > 1e-10)
                     {
-                        if (aquarius::abs(fock[k+j*norb[i]]) > 1e-10)
-                        {
-                            sign = (fock[k+j*norb[i]] < 0 ? -1 : 1);
-                            break;
-                        }
+                        sign = (fock[k+j*norb[i]] < 0 ? -1 : 1);
+                        break;
                     }
-                    //PROFILE_FLOPS(norb[i]);
-                    scal(norb[i], sign, &fock[j*norb[i]], 1);
-                }
-
-                for (int j = 0;j < norb[i]*norb[i];j++)
-                {
-                    pairs[j].k = j;
-                    pairs[j].d = fock[j];
                 }
-
-                C.writeRemoteData(irreps, pairs);
+                //PROFILE_FLOPS(norb[i]);
+                scal(norb[i], sign, &fock[j*norb[i]], 1);
             }
-        }
-        else
-        {
-            S.getAllData(irreps, 0);
-            Fa.getAllData(irreps, 0);
-            S.arena.comm().Bcast(E_alpha[i], 0);
-            Ca.writeRemoteData(irreps);
-            Fb.getAllData(irreps, 0);
-            S.arena.comm().Bcast(E_beta[i], 0);
-            Cb.writeRemoteData(irreps);
+
+            coef[spin*nirrep+i] = fock;
         }
     }
+
+    for (int i = 0;i < nirrep;i++) energies += E_alpha[i];
+    for (int i = 0;i < nirrep;i++) energies += E_beta[i];
+
+    arena.comm().Allreduce(energies, MPI_SUM);
+
+    auto e = energies.begin();
+    for (int i = 0;i < nirrep;i++)
+    {
+        copy(e, e+norb[i], E_alpha[i].begin());
+        e += norb[i];
+    }
+    for (int i = 0;i < nirrep;i++)
+    {
+        copy(e, e+norb[i], E_beta[i].begin());
+        e += norb[i];
+    }
+
+    vector<CTFTensor<T>*> cblocks;
+    for (int i = 0;i < nirrep;i++) cblocks.push_back(&Ca({i,i}));
+    for (int i = 0;i < nirrep;i++) cblocks.push_back(&Cb({i,i}));
+
+    CTFTensor<T>::sumAllData(cblocks, coef);
 }
 
 INSTANTIATE_SPECIALIZATIONS(LocalUHF);
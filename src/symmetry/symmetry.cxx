@@ -2207,5 +2207,20 @@ const PointGroup& PointGroup::S6()
 	return S6_;
 }
 
+const PointGroup& PointGroup::byName(const string& name)
+{
+    static const PointGroup& (*groups[])() =
+        {C1, Cs, Ci, Td, Oh, Ih, C2, C3, C4, C5, C6, C2v, C3v, C4v, C5v, C6v,
+         C2h, C3h, C4h, C5h, C6h, D2, D3, D4, D5, D6, D2h, D3h, D4h, D5h, D6h,
+         D2d, D3d, S4, S6};
+
+    for (auto group : groups)
+    {
+        if (name == group().getName()) return group();
+    }
+
+    throw logic_error("Unknown point group " + name);
+}
+
 }
 }
@@ -96,6 +96,11 @@ class PointGroup
         static const PointGroup& S4();
         static const PointGroup& S6();
 
+        /*
+         * The group whose name is given by getName
+         */
+        static const PointGroup& byName(const string& name);
+
     protected:
         const int order;
         const int nirrep;
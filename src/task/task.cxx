@@ -1,5 +1,10 @@
 #include "task.hpp"
 
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tensor/symblocked_tensor.hpp"
+
 using namespace aquarius::time;
 using namespace aquarius::input;
 
@@ -138,10 +143,12 @@ Product& Requirement::get()
 }
 
 Product::Product(const string& type, const string& name)
-: type(type), name(name), requirements(new vector<Requirement>()), used(new bool(false)) {}
+: type(type), name(name), requirements(new vector<Requirement>()), used(new bool(false)),
+  kept(new bool(false)), provenance(new size_t(0)) {}
 
 Product::Product(const string& type, const string& name, const vector<Requirement>& reqs)
-: type(type), name(name), requirements(new vector<Requirement>(reqs)), used(new bool(false)) {}
+: type(type), name(name), requirements(new vector<Requirement>(reqs)), used(new bool(false)),
+  kept(new bool(false)), provenance(new size_t(0)) {}
 
 void Product::addRequirement(Requirement&& req)
 {
@@ -159,13 +166,42 @@ void Product::addRequirements(vector<Requirement>&& reqs)
     for (Requirement& req : reqs) requirements->push_back(move(req));
 }
 
+static void broadcast(string& s, const Arena& arena, int root)
+{
+    int len = s.size();
+    arena.comm().Bcast(&len, 1, root);
+
+    vector<char> buf(s.begin(), s.end());
+    buf.resize(len);
+    arena.comm().Bcast(buf, root);
+    s.assign(buf.begin(), buf.end());
+}
+
+static map<string,relocatable_factory>& relocatables()
+{
+    static map<string,relocatable_factory> relocatables_;
+    return relocatables_;
+}
+
+bool registerRelocatable(const string& type, relocatable_factory factory)
+{
+    relocatables()[type] = factory;
+    return true;
+}
+
+Destructible* createRelocatable(const string& type, const string& shape, const Arena& arena)
+{
+    auto i = relocatables().find(type);
+    return (i == relocatables().end() ? NULL : i->second(shape, arena));
+}
+
 template <> string Task::type_string<float>() { return "<float>"; }
 template <> string Task::type_string<double>() { return ""; }
 template <> string Task::type_string<complex<float>>() { return "<scomplex>"; }
 template <> string Task::type_string<complex<double>>() { return "<dcomplex>"; }
 
 Task::Task(const string& name, Config& config)
-: name(name), config(config.clone()) {}
+: name(name), config(config.clone()), cost(1.0), provenance(0) {}
 
 map<string,tuple<Schema,Task::factory_func>>& Task::tasks()
 {
@@ -201,6 +237,119 @@ const Schema& Task::getSchema(const string& name)
     return aquarius::get<0>(i->second);
 }
 
+static bool isScalarType(const string& type)
+{
+    return type == "double" || type == "bool";
+}
+
+/*
+ * Scalar products are written by the root process only as a flag for
+ * whether the product exists followed by its value. Other products are
+ * skipped and must be handled by the task itself.
+ */
+void Task::saveScalars(const string& path, const Arena& arena)
+{
+    if (arena.rank != 0) return;
+
+    ofstream ofs(path + ".scalars", std::ios::binary);
+
+    for (Product& p : products)
+    {
+        if (!isScalarType(p.getType())) continue;
+
+        char exists = p.exists();
+        ofs.write(&exists, 1);
+        if (!exists) continue;
+
+        if (p.getType() == "double")
+        {
+            ofs.write(reinterpret_cast<char*>(&p.get<double>()), sizeof(double));
+        }
+        else
+        {
+            char val = p.get<bool>();
+            ofs.write(&val, 1);
+        }
+    }
+}
+
+bool Task::loadScalars(const string& path, const Arena& arena)
+{
+    vector<char> exists(products.size(), 0);
+    vector<double> vals(products.size(), 0.0);
+    int ok = 0;
+
+    if (arena.rank == 0)
+    {
+        ifstream ifs(path + ".scalars", std::ios::binary);
+
+        for (int i = 0;ifs && i < products.size();i++)
+        {
+            if (!isScalarType(products[i].getType())) continue;
+
+            ifs.read(&exists[i], 1);
+            if (!exists[i]) continue;
+
+            if (products[i].getType() == "double")
+            {
+                ifs.read(reinterpret_cast<char*>(&vals[i]), sizeof(double));
+            }
+            else
+            {
+                char val;
+                ifs.read(&val, 1);
+                vals[i] = val;
+            }
+        }
+
+        ok = (bool)ifs;
+    }
+
+    arena.comm().Bcast(&ok, 1, 0);
+    if (!ok) return false;
+
+    arena.comm().Bcast(exists, 0);
+    arena.comm().Bcast(vals, 0);
+
+    for (int i = 0;i < products.size();i++)
+    {
+        if (!exists[i]) continue;
+
+        if (products[i].getType() == "double")
+        {
+            products[i].put(new double(vals[i]));
+        }
+        else
+        {
+            products[i].put(new bool(vals[i] != 0));
+        }
+    }
+
+    return true;
+}
+
+bool Task::checkpoint(const string& path, const Arena& arena)
+{
+    for (Product& p : products)
+    {
+        if (p.exists() && !isScalarType(p.getType())) return false;
+    }
+
+    saveScalars(path, arena);
+
+    return true;
+}
+
+bool Task::restore(const string& path, const Arena& arena)
+{
+    for (Product& p : products)
+    {
+        if (!isScalarType(p.getType())) return false;
+    }
+
+    return loadScalars(path, arena);
+}
+
 Product& Task::getProduct(const string& name)
 {
     for (auto& p : products)
@@ -243,9 +392,98 @@ void TaskDAG::parseTasks(const string& context, Config& input)
 }
 
 TaskDAG::TaskDAG(const string& file)
+: schedule(SERIAL), checkpoint_interval(0)
 {
     ifstream ifs(file);
     Config input(ifs);
+
+    if (input.exists("scheduler"))
+    {
+        string s = input.get<string>("scheduler");
+        if (s == "concurrent")
+        {
+            schedule = CONCURRENT;
+        }
+        else if (s != "serial")
+        {
+            Logger::error(world()) << "Unknown scheduler " << s << endl;
+        }
+        input.remove("scheduler");
+    }
+
+    if (input.exists("block_scheduler"))
+    {
+        string s = input.get<string>("block_scheduler");
+        if (s == "concurrent")
+        {
+            tensor::SymmetryBlockedTensor<float>::setConcurrent(true);
+            tensor::SymmetryBlockedTensor<double>::setConcurrent(true);
+        }
+        else if (s != "serial")
+        {
+            Logger::error(world()) << "Unknown block scheduler " << s << endl;
+        }
+        input.remove("block_scheduler");
+    }
+
+    /*
+     * By default the pool may hold a small fraction of the memory free to
+     * each process at startup. The limit must be the same everywhere for the
+     * pools to stay in step, so the smallest is used.
+     */
+    int64_t pool_bytes;
+    if (input.exists("memory_pool"))
+    {
+        pool_bytes = input.get<int64_t>("memory_pool")*1048576;
+        input.remove("memory_pool");
+    }
+    else
+    {
+        MPI_Comm node;
+        int nlocal;
+        MPI_Comm_split_type(world().comm(), MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node);
+        MPI_Comm_size(node, &nlocal);
+        MPI_Comm_free(&node);
+
+        int64_t avail = (int64_t)sysconf(_SC_AVPHYS_PAGES)*sysconf(_SC_PAGESIZE)/nlocal;
+        world().comm().Allreduce(&avail, 1, MPI_MIN);
+        pool_bytes = avail/32;
+    }
+    tensor::CTFTensor<float>::setPoolLimit(pool_bytes);
+    tensor::CTFTensor<double>::setPoolLimit(pool_bytes);
+    tensor::CTFTensor<complex<double>>::setPoolLimit(pool_bytes);
+
+    if (input.exists("dense_limit"))
+    {
+        int64_t bytes = input.get<int64_t>("dense_limit")*1048576;
+        tensor::CTFTensor<float>::setDenseLimit(bytes);
+        tensor::CTFTensor<double>::setDenseLimit(bytes);
+        tensor::CTFTensor<complex<double>>::setDenseLimit(bytes);
+        input.remove("dense_limit");
+    }
+
+    if (input.exists("ooc"))
+    {
+        Config c = input.get("ooc");
+        if (c.exists("directory"))
+        {
+            tensor::OutOfCore::directory() = c.get<string>("directory");
+            c.remove("directory");
+        }
+        input.remove("ooc");
+    }
+
+    if (input.exists("checkpoint"))
+    {
+        Config c = input.get("checkpoint");
+        checkpoint_dir = c.get<string>("directory");
+        if (c.exists("interval")) checkpoint_interval = c.get<int>("interval");
+        input.remove("checkpoint");
+
+        if (world().rank == 0) mkdir(checkpoint_dir.c_str(), 0755);
+        world().comm().Barrier();
+    }
+
     parseTasks("", input);
 }
 
@@ -273,6 +511,15 @@ Task& TaskDAG::addTask(const Arena& arena, const string& type, const string& con
             type + (num == 0 ? "" : str(num));
     }
 
+    double cost = 1.0;
+    if (config.exists("cost"))
+    {
+        cost = config.get<double>("cost");
+        if (cost <= 0)
+            Logger::error(arena) << "Task cost must be positive (" << name << ")" << endl;
+        config.remove("cost");
+    }
+
     while (config.exists("using"))
     {
         string u = config.get<string>("using");
@@ -281,6 +528,13 @@ Task& TaskDAG::addTask(const Arena& arena, const string& type, const string& con
         config.remove("using");
     }
 
+    vector<string> keeps;
+    while (config.exists("keep"))
+    {
+        keeps.push_back(config.get<string>("keep"));
+        config.remove("keep");
+    }
+
     for (Task& t : tasks)
     {
         if (t.getName() == name)
@@ -291,6 +545,14 @@ Task& TaskDAG::addTask(const Arena& arena, const string& type, const string& con
 
     auto task = Task::createTask(type, name, config);
     Task& t1 = *task;
+    t1.setCost(cost);
+
+    for (const string& k : keeps)
+    {
+        Product& p = t1.getProduct(k);
+        p.keep();
+        kept.push_back(p);
+    }
 
     string context1;
     size_t sep = t1.getName().find_last_of(".");
@@ -492,81 +754,511 @@ void TaskDAG::satisfyExplicitRequirements(const Arena& world)
     }
 }
 
-void TaskDAG::execute(const Arena& world)
+bool TaskDAG::isReady(Task& t)
 {
-    satisfyExplicitRequirements(world);
+    for (Product& p : t.getProducts())
+    {
+        for (Requirement& r : p.getRequirements())
+        {
+            if (!r.exists()) return false;
+        }
+    }
 
-    //TODO: check for cycles
+    return true;
+}
 
-    /*
-     * Successively search for executable tasks
-     */
-    while (!tasks.empty())
+/*
+ * A task may run on a sub-arena if each of its requirements is either a
+ * scalar or can be copied onto the sub-arena (see Relocatable). Distributed
+ * products which other tasks use are copied back to the whole arena
+ * afterwards, which is only known to be possible once they exist; tasks for
+ * which it was not are pinned to the whole arena.
+ */
+bool TaskDAG::isRelocatable(Task& t) const
+{
+    if (pinned.count(&t)) return false;
+
+    for (Product& p : t.getProducts())
     {
-        bool ran_something = false;
-        for (auto i = tasks.pbegin();i != tasks.pend();)
+        for (Requirement& r : p.getRequirements())
         {
-            bool can_execute = true;
-            Task& t = **i;
+            if (isScalarType(r.getType())) continue;
+            if (!r.exists() || !r.get().data->relocatable()) return false;
+        }
+    }
 
-            for (Product& p : t.getProducts())
+    return true;
+}
+
+/*
+ * Destroy the products required by a finished task which no remaining task
+ * produces or requires, unless they have been marked to be kept.
+ */
+void TaskDAG::releaseRequirements(Task& finished)
+{
+    for (Product& p : finished.getProducts())
+    {
+        for (Requirement& r : p.getRequirements())
+        {
+            if (!r.isFulfilled()) continue;
+
+            Product& q = r.get();
+            if (!q.exists() || q.isKept()) continue;
+
+            bool needed = false;
+            for (Task& t : tasks)
             {
-                for (Requirement& r : p.getRequirements())
+                if (&t == &finished) continue;
+
+                for (Product& p2 : t.getProducts())
                 {
-                    if (!r.exists())
+                    if (p2.sharesData(q))
                     {
-                        can_execute = false;
+                        needed = true;
                         break;
                     }
+
+                    for (Requirement& r2 : p2.getRequirements())
+                    {
+                        if (r2.isFulfilled() && r2.get().sharesData(q))
+                        {
+                            needed = true;
+                            break;
+                        }
+                    }
+
+                    if (needed) break;
                 }
-                if (!can_execute) break;
+
+                if (needed) break;
             }
 
-            if (can_execute)
+            if (!needed) q.release();
+        }
+    }
+}
+
+/*
+ * A task's provenance identifies its type and input together with the
+ * provenance of everything it requires, so that a checkpoint is only reused
+ * if nothing upstream of it (molecule, basis, SCF options, ...) has changed.
+ */
+size_t TaskDAG::computeProvenance(Task& t)
+{
+    ostringstream oss;
+    oss << t.getType() << '\n' << t.getName() << '\n';
+    t.getConfig().write(oss);
+
+    for (Product& p : t.getProducts())
+    {
+        for (Requirement& r : p.getRequirements())
+        {
+            if (r.isFulfilled()) oss << r.get().getProvenance() << '\n';
+        }
+    }
+
+    size_t key = std::hash<string>()(oss.str());
+
+    t.setProvenance(key);
+    for (Product& p : t.getProducts()) p.setProvenance(key);
+
+    return key;
+}
+
+string TaskDAG::getCheckpointPath(const Task& t) const
+{
+    return checkpoint_dir + "/" + t.getName();
+}
+
+bool TaskDAG::isCheckpointed(const Task& t, const string& path, const Arena& arena) const
+{
+    int valid = 0;
+
+    if (arena.rank == 0)
+    {
+        ifstream ifs(path + ".key");
+        size_t key;
+        valid = (ifs >> key) && key == t.getProvenance();
+    }
+
+    arena.comm().Bcast(&valid, 1, 0);
+
+    return valid;
+}
+
+void TaskDAG::markCheckpointed(const Task& t, const string& path, const Arena& arena) const
+{
+    arena.comm().Barrier();
+
+    if (arena.rank == 0)
+    {
+        ofstream ofs(path + ".key");
+        ofs << t.getProvenance() << endl;
+    }
+}
+
+bool TaskDAG::runTask(Task& t, const Arena& arena)
+{
+    string path;
+
+    if (!checkpoint_dir.empty())
+    {
+        computeProvenance(t);
+        path = getCheckpointPath(t);
+
+        if (isCheckpointed(t, path, arena) && t.restore(path, arena))
+        {
+            bool restored = true;
+            for (Product& p : t.getProducts())
             {
-                ran_something = true;
+                if (p.isUsed() && !p.exists()) restored = false;
+            }
 
-                Logger::log(world) << "Starting task: " << t.getName() << endl;
-                Timer timer;
-
-                bool success = true;
-                bool done = false;
-                string error;
-
-                timer.start();
-                //try
-                //{
-                    done = t.run(*this, world);
-                //}
-                //catch (runtime_error& e)
-                //{
-                //    success = false;
-                //    error = e.what();
-                //}
-                timer.stop();
-
-                double dt = timer.seconds(world);
-                double gflops = timer.gflops(world);
-                Logger::log(world) << "Finished task: " << t.getName() <<
-                           " in " << fixed << setprecision(3) << dt << " s" << endl;
-                Logger::log(world) << "Task: " << t.getName() <<
-                           " achieved " << fixed << setprecision(3) << gflops << " Gflops/sec" << endl;
-
-                if (!success)
-                {
-                    throw runtime_error(error);
-                }
+            if (restored)
+            {
+                Logger::log(arena) << "Restored task: " << t.getName() <<
+                                      " from " << path << endl;
+                return true;
+            }
+        }
+    }
+
+    Logger::log(arena) << "Starting task: " << t.getName() << endl;
+    Timer timer;
+
+    bool success = true;
+    bool done = false;
+    string error;
+
+    ProfileSection section(t.getName());
+    timer.start();
+    //try
+    //{
+        done = t.run(*this, arena);
+    //}
+    //catch (runtime_error& e)
+    //{
+    //    success = false;
+    //    error = e.what();
+    //}
+    timer.stop();
+    section.stop();
+
+    double dt = timer.seconds(arena);
+    double gflops = timer.gflops(arena);
+    Logger::log(arena) << "Finished task: " << t.getName() <<
+               " in " << fixed << setprecision(3) << dt << " s" << endl;
+    Logger::log(arena) << "Task: " << t.getName() <<
+               " achieved " << fixed << setprecision(3) << gflops << " Gflops/sec" << endl;
+
+    if (!success)
+    {
+        throw runtime_error(error);
+    }
 
-                if (done)
+    if (done)
+    {
+        for (Product& p : t.getProducts())
+        {
+            if (p.isUsed() && !p.exists())
+                Logger::error(arena) << "Product " << p.getName() <<
+                                        " of task " << t.getName() <<
+                                        " was not successfully produced" << endl;
+        }
+
+        if (!path.empty() && t.checkpoint(path, arena))
+        {
+            markCheckpointed(t, path, arena);
+        }
+    }
+
+    return done;
+}
+
+void TaskDAG::runConcurrently(const vector<Task*>& batch, const Arena& world)
+{
+    /*
+     * Every process needs the provenance of every product, not just of those
+     * computed in its own group.
+     */
+    if (!checkpoint_dir.empty())
+    {
+        for (Task* t : batch) computeProvenance(*t);
+    }
+
+    int ntask = min((int)batch.size(), world.size);
+
+    /*
+     * Give each task at least one process and distribute the rest in
+     * proportion to the cost hints (largest remainder first).
+     */
+    double totcost = 0;
+    for (int i = 0;i < ntask;i++) totcost += batch[i]->getCost();
+
+    vector<int> nproc(ntask, 1);
+    vector<pair<double,int>> remainder(ntask);
+    int nleft = world.size-ntask;
+    int nassigned = 0;
+    for (int i = 0;i < ntask;i++)
+    {
+        double share = nleft*batch[i]->getCost()/totcost;
+        nproc[i] += (int)share;
+        nassigned += (int)share;
+        remainder[i] = make_pair(share-(int)share, i);
+    }
+    sort(remainder.begin(), remainder.end(),
+         [](const pair<double,int>& a, const pair<double,int>& b) { return a.first > b.first; });
+    for (int i = 0;nassigned < nleft;i++,nassigned++) nproc[remainder[i].second]++;
+
+    vector<int> first(ntask+1, 0);
+    for (int i = 0;i < ntask;i++) first[i+1] = first[i]+nproc[i];
+
+    int color; for (color = 0;world.rank >= first[color+1];color++);
+
+    Arena sub(const_cast<Intracomm&>(world.comm()).split(color, world.rank));
+
+    /*
+     * Copy the distributed requirements of the tasks onto the sub-arenas of
+     * the tasks which need them. Every process takes part in the copy of
+     * each requirement, in the same order, whether its own task needs it or
+     * not. A requirement shared by several tasks is only copied once.
+     */
+    vector<Product> moved;
+    for (int i = 0;i < ntask;i++)
+    {
+        for (Product& p : batch[i]->getProducts())
+        {
+            for (Requirement& r : p.getRequirements())
+            {
+                if (isScalarType(r.getType())) continue;
+
+                Product& q = r.get();
+
+                bool seen = false;
+                for (Product& m : moved) if (m.sharesData(q)) seen = true;
+                if (!seen) moved.push_back(q);
+            }
+        }
+    }
+
+    vector<Destructible*> copies;
+    for (Product& q : moved)
+    {
+        bool mine = false;
+        for (Product& p : batch[color]->getProducts())
+        {
+            for (Requirement& r : p.getRequirements())
+            {
+                if (r.isFulfilled() && r.get().sharesData(q)) mine = true;
+            }
+        }
+
+        Destructible* copy = (mine ? q.data->relocated(sub) : NULL);
+        q.data->relocatable()->copyInto(copy ? copy->relocatable() : NULL);
+        copies.push_back(copy);
+    }
+
+    /*
+     * The copies stand in for the originals (on this process only) while the
+     * task runs
+     */
+    for (int i = 0;i < moved.size();i++)
+    {
+        if (copies[i]) copies[i] = moved[i].data.exchange(copies[i]);
+    }
+
+    Logger::log(sub) << "Running task " << batch[color]->getName() <<
+                        " on " << sub.size << " of " << world.size << " processes" << endl;
+
+    bool done = runTask(*batch[color], sub);
+
+    vector<int> flags(ntask);
+    for (int i = 0;i < ntask;i++)
+    {
+        flags[i] = (color == i && done);
+        world.comm().Bcast(&flags[i], 1, first[i]);
+    }
+
+    /*
+     * Copy the distributed products which other tasks use back onto the
+     * whole arena. The first process in each group describes each product
+     * so that the other processes can create an empty one to copy into. A
+     * task with a product that cannot be described runs again later on the
+     * whole arena.
+     */
+    vector<vector<Destructible*>> copied(ntask);
+    for (int i = 0;i < ntask;i++)
+    {
+        Task& t = *batch[i];
+        int root = first[i];
+
+        for (Product& p : t.getProducts())
+        {
+            Destructible* copy = NULL;
+
+            if (flags[i] && !pinned.count(&t) &&
+                !isScalarType(p.getType()) && (p.isUsed() || p.isKept()))
+            {
+                string type, shape;
+                int exists = (color == i && p.exists());
+                world.comm().Bcast(&exists, 1, root);
+
+                if (exists)
                 {
-                    for (Product& p : t.getProducts())
+                    Relocatable* data = (color == i ? p.data->relocatable() : NULL);
+                    int ok = (color == i && data && data->describe(type, shape));
+                    world.comm().Bcast(&ok, 1, root);
+
+                    if (ok)
+                    {
+                        broadcast(type, world, root);
+                        broadcast(shape, world, root);
+                        copy = createRelocatable(type, shape, world);
+                        ok = (copy != NULL);
+                        world.comm().Allreduce(&ok, 1, MPI_LAND);
+                    }
+
+                    if (ok)
+                    {
+                        copy->relocatable()->copyFrom(data);
+                    }
+                    else
                     {
-                        if (p.isUsed() && !p.exists())
-                            Logger::error(world) << "Product " << p.getName() <<
-                                                    " of task " << t.getName() <<
-                                                    " was not successfully produced" << endl;
+                        Logger::log(world) << "Product " << p.getName() << " of task " << t.getName() <<
+                                              " cannot be copied from a sub-arena" << endl;
+                        delete copy;
+                        copy = NULL;
+                        pinned.insert(&t);
                     }
+                }
+            }
+
+            copied[i].push_back(copy);
+        }
+    }
+
+    /*
+     * Only the copies of the distributed products are kept, and the
+     * originals must go before the requirements that they may refer to
+     */
+    for (Product& p : batch[color]->getProducts())
+    {
+        if (!isScalarType(p.getType())) p.release();
+    }
+
+    for (int i = 0;i < moved.size();i++)
+    {
+        if (copies[i]) delete moved[i].data.exchange(copies[i]);
+    }
+
+    /*
+     * Replicate the results on the whole arena. The first process in each
+     * group is the source for that task's products.
+     */
+    for (int i = 0;i < ntask;i++)
+    {
+        Task& t = *batch[i];
+        int root = first[i];
+
+        int flag = flags[i];
+
+        if (flag && pinned.count(&t))
+        {
+            for (Destructible* copy : copied[i]) delete copy;
+            if (color == i) for (Product& p : t.getProducts()) p.release();
+            continue;
+        }
+
+        for (int j = 0;j < t.getProducts().size();j++)
+        {
+            Product& p = t.getProducts()[j];
+
+            if (copied[i][j])
+            {
+                p.data.set(copied[i][j]);
+                continue;
+            }
+
+            if (!isScalarType(p.getType())) continue;
+
+            int exists = (color == i && p.exists());
+            world.comm().Bcast(&exists, 1, root);
+            if (!exists) continue;
+
+            if (p.getType() == "double")
+            {
+                double val = (color == i ? p.get<double>() : 0.0);
+                world.comm().Bcast(&val, 1, root);
+                if (color != i) p.put(new double(val));
+            }
+            else if (p.getType() == "bool")
+            {
+                int val = (color == i ? p.get<bool>() : 0);
+                world.comm().Bcast(&val, 1, root);
+                if (color != i) p.put(new bool(val));
+            }
+        }
+
+        if (flag)
+        {
+            releaseRequirements(t);
+
+            for (auto it = tasks.pbegin();it != tasks.pend();++it)
+            {
+                if (it->get() == &t)
+                {
+                    tasks.perase(it);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void TaskDAG::execute(const Arena& world)
+{
+    satisfyExplicitRequirements(world);
+
+    //TODO: check for cycles
+
+    /*
+     * Successively search for executable tasks
+     */
+    while (!tasks.empty())
+    {
+        bool ran_something = false;
+
+        /*
+         * Independent tasks can share the arena instead of waiting for each
+         * other.
+         */
+        if (schedule == CONCURRENT && world.size > 1)
+        {
+            vector<Task*> batch;
+            for (Task& t : tasks)
+            {
+                if (isReady(t) && isRelocatable(t)) batch.push_back(&t);
+            }
+
+            if (batch.size() > 1)
+            {
+                runConcurrently(batch, world);
+                continue;
+            }
+        }
 
+        for (auto i = tasks.pbegin();i != tasks.pend();)
+        {
+            Task& t = **i;
+
+            if (isReady(t))
+            {
+                ran_something = true;
+
+                if (runTask(t, world))
+                {
+                    releaseRequirements(t);
+                    pinned.erase(&t);
                     i = tasks.perase(i);
                 }
                 else
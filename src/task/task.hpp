@@ -101,10 +101,67 @@ class Printer
         }
 };
 
+/*
+ * Distributed data which can be copied onto a subset of the processes of its
+ * arena, so that tasks which require it can run on a sub-arena (see
+ * TaskDAG::runConcurrently)
+ */
+class Relocatable
+{
+    public:
+        virtual ~Relocatable() {}
+
+        /*
+         * Create an object of the same type and shape on arena, which holds
+         * a subset of the processes of this object's arena, without copying
+         * the data. Collective over arena.
+         */
+        virtual Relocatable* relocated(const Arena& arena) const = 0;
+
+        /*
+         * Copy the data into an object created by relocated. Collective over
+         * this object's arena; processes which do not hold other pass NULL.
+         */
+        virtual void copyInto(Relocatable* other) const = 0;
+
+        /*
+         * False for objects which refer to other distributed objects, and so
+         * cannot be copied on their own
+         */
+        virtual bool canRelocate() const { return true; }
+
+        /*
+         * Write the type (under which a factory is registered, see
+         * registerType) and the shape of this object, so that the processes
+         * which do not hold it can create an empty one. Returns false if the
+         * object cannot be described.
+         */
+        virtual bool describe(string& type, string& shape) const { return false; }
+
+        /*
+         * Overwrite this object with the data of other, which was created by
+         * relocated on a subset of the processes of this object's arena (the
+         * reverse of copyInto). Collective over this object's arena;
+         * processes which do not hold other pass NULL.
+         */
+        virtual void copyFrom(const Relocatable* other) {}
+};
+
 class Destructible
 {
     public:
         virtual ~Destructible() {}
+
+        /*
+         * The data if it is Relocatable (and can be relocated), or NULL
+         */
+        virtual Relocatable* relocatable() const { return NULL; }
+
+        /*
+         * Wrap the result of Relocatable::relocated, or return NULL if the
+         * data is not Relocatable
+         */
+        virtual Destructible* relocated(const Arena& arena) const { return NULL; }
 };
 
 template <typename T>
@@ -115,14 +172,55 @@ class Resource : public Destructible
 
         Resource& operator=(const Resource& other);
 
+        static Relocatable* asRelocatable(Relocatable* data)
+        {
+            return (data->canRelocate() ? data : NULL);
+        }
+
+        static Relocatable* asRelocatable(void* data) { return NULL; }
+
+        template <typename U>
+        static U* emptyCopy(const U* data, const Arena& arena, const Relocatable*)
+        {
+            return dynamic_cast<U*>(data->relocated(arena));
+        }
+
+        template <typename U>
+        static U* emptyCopy(const U* data, const Arena& arena, const void*)
+        {
+            return NULL;
+        }
+
     public:
         T* const data;
 
         Resource(T* data) : data(data) {}
 
         ~Resource() { delete data; }
+
+        Relocatable* relocatable() const { return asRelocatable(data); }
+
+        Destructible* relocated(const Arena& arena) const
+        {
+            T* copy = emptyCopy(data, arena, data);
+            return (copy ? new Resource<T>(copy) : NULL);
+        }
 };
 
+/*
+ * Create an empty object from the shape written by Relocatable::describe, on
+ * the given arena
+ */
+typedef Destructible* (*relocatable_factory)(const string& shape, const Arena& arena);
+
+bool registerRelocatable(const string& type, relocatable_factory factory);
+
+/*
+ * Create the object described by type and shape on arena, or return NULL if
+ * no factory is registered for type
+ */
+Destructible* createRelocatable(const string& type, const string& shape, const Arena& arena);
+
 class Product;
 
 class Requirement
@@ -154,6 +252,7 @@ class Product
 {
     friend class Requirement;
     friend class Task;
+    friend class TaskDAG;
 
     protected:
         string type;
@@ -161,6 +260,8 @@ class Product
         global_ptr<Destructible> data;
         shared_ptr<vector<Requirement>> requirements;
         shared_ptr<bool> used;
+        shared_ptr<bool> kept;
+        shared_ptr<size_t> provenance;
 
     public:
         Product(const string& type, const string& name);
@@ -173,6 +274,18 @@ class Product
 
         bool isUsed() const { return *used; }
 
+        /*
+         * Kept products are not released by the TaskDAG after their last
+         * consumer finishes.
+         */
+        bool isKept() const { return *kept; }
+
+        void keep() { *kept = true; }
+
+        size_t getProvenance() const { return *provenance; }
+
+        void setProvenance(size_t key) { *provenance = key; }
+
         template <typename T> T& put(T* resource)
         {
             data.set(new Resource<T>(resource));
@@ -187,6 +300,19 @@ class Product
 
         bool exists() const { return data; }
 
+        /*
+         * True if this and other are copies of the same product.
+         */
+        bool sharesData(const Product& other) const
+        {
+            return data && data.get() == other.data.get();
+        }
+
+        /*
+         * Destroy the data for all copies of this product.
+         */
+        void release() { data.set(); }
+
         void addRequirement(Requirement&& req);
 
         template <typename... Args>
@@ -214,6 +340,8 @@ class Task
         vector<Product> products;
         vector<Product> temporaries;
         input::Config config;
+        double cost;
+        size_t provenance;
 
         static map<string,tuple<input::Schema,factory_func>>& tasks();
 
@@ -260,6 +388,38 @@ class Task
             throw logic_error("Temporary " + name + " not found on task " + this->name);
         }
 
+        bool hastmp(const string& name) const
+        {
+            for (const Product& p : temporaries)
+            {
+                if (p.getName() == name) return p.exists();
+            }
+
+            return false;
+        }
+
+        /*
+         * Free every temporary whose name ends in tag, e.g. the single
+         * precision copies used in a mixed precision solve
+         */
+        void releasetmp(const string& tag)
+        {
+            for (Product& p : temporaries)
+            {
+                const string& name = p.getName();
+                if (name.size() >= tag.size() &&
+                    name.compare(name.size()-tag.size(), tag.size(), tag) == 0) p.release();
+            }
+        }
+
+        /*
+         * Save or load only the scalar products, for use by tasks which
+         * checkpoint their other products themselves.
+         */
+        void saveScalars(const string& path, const Arena& arena);
+
+        bool loadScalars(const string& path, const Arena& arena);
+
         ostream& log(const Arena& arena);
 
         ostream& warn(const Arena& arena);
@@ -281,6 +441,22 @@ class Task
 
         const string& getName() const { return name; }
 
+        /*
+         * Relative cost estimate used by the concurrent scheduler to size
+         * the sub-arena on which this task is run.
+         */
+        double getCost() const { return cost; }
+
+        void setCost(double cost) { this->cost = cost; }
+
+        /*
+         * Hash of this task's input and of everything upstream of it, set by
+         * the TaskDAG when checkpointing is enabled.
+         */
+        size_t getProvenance() const { return provenance; }
+
+        void setProvenance(size_t key) { provenance = key; }
+
         bool isUsed(const string& name) const { return getProduct(name).isUsed(); }
 
         template <typename T> static string type_string();
@@ -329,6 +505,19 @@ class Task
 
         virtual bool run(TaskDAG& dag, const Arena& arena) = 0;
 
+        /*
+         * Save the products of a finished task to files beginning with path.
+         * Returns false if the task cannot be checkpointed; the default
+         * handles tasks which only produce scalars.
+         */
+        virtual bool checkpoint(const string& path, const Arena& arena);
+
+        /*
+         * Recreate the products saved by checkpoint, returning false if they
+         * could not be read. Requirements are available as for run.
+         */
+        virtual bool restore(const string& path, const Arena& arena);
+
         static unique_ptr<Task> createTask(const string& type, const string& name, input::Config& config);
 };
 
@@ -352,16 +541,40 @@ template <> bool aquarius::task::TaskFactory<type>::initialized = \
 
 class TaskDAG
 {
+    public:
+        enum Schedule {SERIAL, CONCURRENT};
+
     protected:
         unique_list<Task> tasks;
         vector<tuple<string,string,input::Config>> usings;
+        vector<Product> kept;
+        /*
+         * Tasks which produced a distributed product that could not be copied
+         * back from their sub-arena, and so only run on the whole arena
+         */
+        set<const Task*> pinned;
+        Schedule schedule;
+        string checkpoint_dir;
+        int checkpoint_interval;
 
         void parseTasks(const string& context, input::Config& config);
 
         void satisfyExplicitRequirements(const Arena& world);
 
+        static bool isReady(Task& t);
+
+        bool isRelocatable(Task& t) const;
+
+        void releaseRequirements(Task& finished);
+
+        size_t computeProvenance(Task& t);
+
+        bool runTask(Task& t, const Arena& arena);
+
+        void runConcurrently(const vector<Task*>& batch, const Arena& world);
+
     public:
-        TaskDAG() {}
+        TaskDAG() : schedule(SERIAL), checkpoint_interval(0) {}
 
         TaskDAG(const string& file);
 
@@ -369,6 +582,28 @@ class TaskDAG
 
         Task& addTask(const Arena& arena, unique_ptr<Task>&& task);
 
+        void setSchedule(Schedule schedule) { this->schedule = schedule; }
+
+        Schedule getSchedule() const { return schedule; }
+
+        /*
+         * Directory in which task products are checkpointed, or empty if
+         * checkpointing is disabled.
+         */
+        const string& getCheckpointDirectory() const { return checkpoint_dir; }
+
+        /*
+         * Number of iterations between saves of the state of iterative
+         * tasks, or 0 to only checkpoint finished tasks.
+         */
+        int getCheckpointInterval() const { return checkpoint_interval; }
+
+        string getCheckpointPath(const Task& t) const;
+
+        bool isCheckpointed(const Task& t, const string& path, const Arena& arena) const;
+
+        void markCheckpointed(const Task& t, const string& path, const Arena& arena) const;
+
         void execute(const Arena& world);
 };
 
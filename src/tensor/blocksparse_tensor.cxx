@@ -0,0 +1,782 @@
+#include "blocksparse_tensor.hpp"
+
+using namespace aquarius::task;
+
+namespace aquarius
+{
+namespace tensor
+{
+
+template <class T>
+static void sendPairs(const Intracomm& comm, int to, const vector<tkv_pair<T>>& pairs)
+{
+    int64_t npair = pairs.size();
+    comm.Send(&npair, 1, to, 0);
+    comm.Send((const char*)pairs.data(), npair*sizeof(tkv_pair<T>), to, 0);
+}
+
+template <class T>
+static void recvPairs(const Intracomm& comm, int from, vector<tkv_pair<T>>& pairs)
+{
+    int64_t npair;
+    comm.Recv(&npair, 1, from, 0);
+    pairs.resize(npair);
+    comm.Recv((char*)pairs.data(), npair*sizeof(tkv_pair<T>), from, 0);
+}
+
+template <class T>
+BlockSparseTensor<T>::BlockSparseTensor(const BlockSparseTensor<T>& other)
+: IndexableCompositeTensor<BlockSparseTensor<T>,CTFTensor<T>,T>(other), Distributed(other.arena),
+  len(other.len), local(other.local), offsets(other.offsets), norms(other.norms), threshold(other.threshold) {}
+
+template <class T>
+BlockSparseTensor<T>::BlockSparseTensor(const string& name, const BlockSparseTensor<T>& other)
+: IndexableCompositeTensor<BlockSparseTensor<T>,CTFTensor<T>,T>(name, other), Distributed(other.arena),
+  len(other.len), local(other.local), offsets(other.offsets), norms(other.norms), threshold(other.threshold) {}
+
+template <class T>
+BlockSparseTensor<T>::BlockSparseTensor(const string& name, const BlockSparseTensor<T>& other, T scalar)
+: IndexableCompositeTensor<BlockSparseTensor<T>,CTFTensor<T>,T>(name, 0, 0), Distributed(other.arena),
+  local(other.local), threshold(other.threshold)
+{
+    this->addTensor(isLocal(0) ? new CTFTensor<T>(name, local, scalar) : NULL);
+    offsets.push_back(0);
+    norms.push_back(0);
+    updateNorm(0);
+}
+
+template <class T>
+BlockSparseTensor<T>::BlockSparseTensor(const string& name, const Arena& arena, int ndim,
+                                        const vector<vector<int>>& len)
+: IndexableCompositeTensor<BlockSparseTensor<T>,CTFTensor<T>,T>(name, ndim, 0), Distributed(arena),
+  len(len), local(arena.split(vector<int>(arena.size, 1))), threshold(0)
+{
+    assert(len.size() == ndim);
+}
+
+template <class T>
+int64_t BlockSparseTensor<T>::getNumTiles() const
+{
+    int64_t ntiles = 1;
+    for (int i = 0;i < ndim;i++) ntiles *= len[i].size();
+    return ntiles;
+}
+
+template <class T>
+vector<int> BlockSparseTensor<T>::getTile(int64_t off) const
+{
+    vector<int> tile(ndim);
+    for (int i = 0;i < ndim;i++)
+    {
+        tile[i] = off%len[i].size();
+        off /= len[i].size();
+    }
+    return tile;
+}
+
+template <class T>
+int64_t BlockSparseTensor<T>::getOffset(const vector<int>& tile) const
+{
+    assert(tile.size() == ndim);
+
+    int64_t off = 0;
+    int64_t stride = 1;
+    for (int i = 0;i < ndim;i++)
+    {
+        assert(tile[i] >= 0 && tile[i] < len[i].size());
+        off += stride*tile[i];
+        stride *= len[i].size();
+    }
+    return off;
+}
+
+template <class T>
+vector<int> BlockSparseTensor<T>::getTileLengths(int64_t off) const
+{
+    vector<int> tile = getTile(off);
+    vector<int> sublen(ndim);
+    for (int i = 0;i < ndim;i++) sublen[i] = len[i][tile[i]];
+    return sublen;
+}
+
+template <class T>
+int BlockSparseTensor<T>::find(int64_t off) const
+{
+    auto it = lower_bound(offsets.begin(), offsets.end(), off);
+    if (it == offsets.end() || *it != off) return -1;
+    return it-offsets.begin();
+}
+
+template <class T>
+const CTFTensor<T>& BlockSparseTensor<T>::tileAt(int64_t off) const
+{
+    int i = find(off);
+    assert(i != -1 && tensors[i].tensor);
+    return *tensors[i].tensor;
+}
+
+template <class T>
+const CTFTensor<T>& BlockSparseTensor<T>::tileAt(int64_t off, const map<int64_t,unique_ptr<CTFTensor<T>>>& copies) const
+{
+    if (isLocal(off)) return tileAt(off);
+
+    auto it = copies.find(off);
+    assert(it != copies.end());
+    return *it->second;
+}
+
+template <class T>
+CTFTensor<T>* BlockSparseTensor<T>::allocateTile(int64_t off)
+{
+    auto it = lower_bound(offsets.begin(), offsets.end(), off);
+    int i = it-offsets.begin();
+
+    if (it == offsets.end() || *it != off)
+    {
+        CTFTensor<T>* t = NULL;
+        if (isLocal(off))
+        {
+            t = new CTFTensor<T>(this->name, local, ndim, getTileLengths(off),
+                                 vector<int>(ndim, NS), true);
+        }
+
+        tensors.insert(tensors.begin()+i,
+                       typename CompositeTensor<BlockSparseTensor<T>,CTFTensor<T>,T>::TensorRef(t, t != NULL));
+        offsets.insert(it, off);
+        norms.insert(norms.begin()+i, 0);
+    }
+
+    return tensors[i].tensor;
+}
+
+template <class T>
+void BlockSparseTensor<T>::freeTile(int64_t off)
+{
+    int i = find(off);
+    if (i == -1) return;
+
+    if (tensors[i].isAlloced) delete tensors[i].tensor;
+    tensors.erase(tensors.begin()+i);
+    offsets.erase(offsets.begin()+i);
+    norms.erase(norms.begin()+i);
+}
+
+template <class T>
+void BlockSparseTensor<T>::updateNorm(int64_t off)
+{
+    int i = find(off);
+    if (i == -1) return;
+
+    if (isLocal(off)) norms[i] = tensors[i].tensor->norm(2);
+    this->arena.comm().Bcast(&norms[i], 1, owner(off));
+}
+
+template <class T>
+void BlockSparseTensor<T>::shareNorms()
+{
+    vector<real_type_t<T>> nrms(norms.size(), 0);
+    for (int i = 0;i < tensors.size();i++)
+    {
+        if (tensors[i].tensor) nrms[i] = norms[i];
+    }
+
+    this->arena.comm().Allreduce(nrms.data(), nrms.size(), MPI_SUM);
+    norms = nrms;
+}
+
+template <class T>
+void BlockSparseTensor<T>::sendTiles(const set<pair<int64_t,int>>& needed,
+                                     map<int64_t,unique_ptr<CTFTensor<T>>>& copies) const
+{
+    const Intracomm& comm = this->arena.comm();
+
+    for (auto& n : needed)
+    {
+        int64_t off = n.first;
+        int from = owner(off);
+        int to = n.second;
+
+        if (from == to) continue;
+
+        vector<tkv_pair<T>> pairs;
+
+        if (this->arena.rank == from)
+        {
+            tileAt(off).getLocalData(pairs);
+            sendPairs(comm, to, pairs);
+        }
+        else if (this->arena.rank == to)
+        {
+            recvPairs(comm, from, pairs);
+
+            CTFTensor<T>* t = new CTFTensor<T>(this->name, local, ndim, getTileLengths(off),
+                                               vector<int>(ndim, NS), true);
+            t->writeRemoteData(pairs);
+            copies[off].reset(t);
+        }
+    }
+}
+
+template <class T>
+void BlockSparseTensor<T>::allocate(const vector<int>& tile)
+{
+    allocateTile(getOffset(tile));
+}
+
+template <class T>
+CTFTensor<T>& BlockSparseTensor<T>::operator()(const vector<int>& tile)
+{
+    int i = find(getOffset(tile));
+    if (i == -1)
+        throw logic_error("tile does not exist");
+    if (!tensors[i].tensor)
+        throw logic_error("tile is owned by another process");
+    return *tensors[i].tensor;
+}
+
+template <class T>
+const CTFTensor<T>& BlockSparseTensor<T>::operator()(const vector<int>& tile) const
+{
+    int i = find(getOffset(tile));
+    if (i == -1)
+        throw logic_error("tile does not exist");
+    if (!tensors[i].tensor)
+        throw logic_error("tile is owned by another process");
+    return *tensors[i].tensor;
+}
+
+template <class T>
+void BlockSparseTensor<T>::getLocalData(const vector<int>& tile, vector<tkv_pair<T>>& pairs) const
+{
+    int i = find(getOffset(tile));
+    if (i == -1 || !tensors[i].tensor)
+    {
+        pairs.clear();
+        return;
+    }
+
+    tensors[i].tensor->getLocalData(pairs);
+}
+
+template <class T>
+void BlockSparseTensor<T>::getRemoteData(const vector<int>& tile, vector<tkv_pair<T>>& pairs) const
+{
+    const Intracomm& comm = this->arena.comm();
+    int64_t off = getOffset(tile);
+    int root = owner(off);
+    int i = find(off);
+
+    if (this->arena.rank != root)
+    {
+        sendPairs(comm, root, pairs);
+        recvPairs(comm, root, pairs);
+        return;
+    }
+
+    for (int r = 0;r < this->arena.size;r++)
+    {
+        vector<tkv_pair<T>> requested;
+        vector<tkv_pair<T>>& req = (r == root ? pairs : requested);
+
+        if (r != root) recvPairs(comm, r, req);
+
+        if (i == -1)
+        {
+            for (auto& p : req) p.d = (T)0;
+        }
+        else
+        {
+            tensors[i].tensor->getRemoteData(req);
+        }
+
+        if (r != root) sendPairs(comm, r, req);
+    }
+}
+
+template <class T>
+void BlockSparseTensor<T>::getRemoteData(const vector<int>& tile) const
+{
+    vector<tkv_pair<T>> pairs;
+    getRemoteData(tile, pairs);
+}
+
+template <class T>
+void BlockSparseTensor<T>::writeRemoteData(const vector<int>& tile, const vector<tkv_pair<T>>& pairs)
+{
+    const Intracomm& comm = this->arena.comm();
+    int64_t off = getOffset(tile);
+    int root = owner(off);
+
+    CTFTensor<T>* t = allocateTile(off);
+
+    if (this->arena.rank != root)
+    {
+        sendPairs(comm, root, pairs);
+    }
+    else
+    {
+        vector<tkv_pair<T>> all(pairs), received;
+        for (int r = 0;r < this->arena.size;r++)
+        {
+            if (r == root) continue;
+            recvPairs(comm, r, received);
+            all.insert(all.end(), received.begin(), received.end());
+        }
+        t->writeRemoteData(all);
+    }
+
+    updateNorm(off);
+}
+
+template <class T>
+void BlockSparseTensor<T>::writeRemoteData(const vector<int>& tile)
+{
+    writeRemoteData(tile, vector<tkv_pair<T>>());
+}
+
+template <class T>
+void BlockSparseTensor<T>::updateNorms()
+{
+    for (int i = 0;i < tensors.size();i++)
+    {
+        if (tensors[i].tensor) norms[i] = tensors[i].tensor->norm(2);
+    }
+
+    shareNorms();
+}
+
+template <class T>
+void BlockSparseTensor<T>::screen(double cutoff)
+{
+    for (int i = tensors.size()-1;i >= 0;i--)
+    {
+        if (norms[i] <= cutoff) freeTile(offsets[i]);
+    }
+}
+
+template <class T>
+BlockSparseTensor<T>& BlockSparseTensor<T>::scalar() const
+{
+    if (!scalar_) scalar_.reset(new BlockSparseTensor<T>("scalar", *this, (T)0));
+    return *scalar_;
+}
+
+template <class T>
+void BlockSparseTensor<T>::checkTiles(const string& idx, vector<const vector<int>*>& tiles) const
+{
+    for (int i = 0;i < ndim;i++)
+    {
+        unsigned char c = idx[i];
+        if (tiles[c] == NULL)
+        {
+            tiles[c] = &len[i];
+        }
+        else if (*tiles[c] != len[i])
+        {
+            throw LengthMismatchError();
+        }
+    }
+}
+
+template <class T>
+bool BlockSparseTensor<T>::assignTiles(const string& idx, int64_t off, vector<int>& assigned) const
+{
+    vector<int> tile = getTile(off);
+
+    for (int i = 0;i < ndim;i++)
+    {
+        unsigned char c = idx[i];
+        if (assigned[c] == -1)
+        {
+            assigned[c] = tile[i];
+        }
+        else if (assigned[c] != tile[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <class T>
+void BlockSparseTensor<T>::matchTiles(T alpha, const BlockSparseTensor<T>& A, const string& idx_A,
+                                               const BlockSparseTensor<T>* B, const string& idx_B,
+                                                                              const string& idx_C,
+                                      double threshold, vector<TileOp>& ops) const
+{
+    assert(A.arena.size == this->arena.size);
+    assert(!B || B->arena.size == this->arena.size);
+
+    vector<const vector<int>*> tiles(256, NULL);
+    A.checkTiles(idx_A, tiles);
+    if (B) B->checkTiles(idx_B, tiles);
+    checkTiles(idx_C, tiles);
+
+    /*
+     * Letters which must agree between tiles of A and B, and letters of C
+     * which appear in neither, over which the result is replicated
+     */
+    string shared, only_C;
+    if (B)
+    {
+        for (char c : idx_B)
+        {
+            if (contains(idx_A, c) && !contains(shared, c)) shared += c;
+        }
+    }
+    for (char c : idx_C)
+    {
+        if (!contains(idx_A, c) && !contains(idx_B, c) && !contains(only_C, c)) only_C += c;
+    }
+
+    /*
+     * Tiles of B, grouped by the tiles of the shared letters
+     */
+    map<vector<int>,vector<int>> B_tiles;
+    if (B)
+    {
+        for (int i_B = 0;i_B < B->tensors.size();i_B++)
+        {
+            vector<int> assigned(256, -1);
+            if (!B->assignTiles(idx_B, B->offsets[i_B], assigned)) continue;
+
+            vector<int> key;
+            for (char c : shared) key.push_back(assigned[(unsigned char)c]);
+            B_tiles[key].push_back(i_B);
+        }
+    }
+
+    for (int i_A = 0;i_A < A.tensors.size();i_A++)
+    {
+        int64_t off_A = A.offsets[i_A];
+
+        vector<int> assigned_A(256, -1);
+        if (!A.assignTiles(idx_A, off_A, assigned_A)) continue;
+
+        vector<int> key;
+        for (char c : shared) key.push_back(assigned_A[(unsigned char)c]);
+
+        static const vector<int> no_B(1, -1);
+        auto it = B_tiles.find(key);
+        if (B && it == B_tiles.end()) continue;
+        const vector<int>& is_B = (B ? it->second : no_B);
+
+        for (int i_B : is_B)
+        {
+            vector<int> assigned(assigned_A);
+            int64_t off_B = -1;
+
+            if (B)
+            {
+                if (aquarius::abs(alpha)*A.norms[i_A]*B->norms[i_B] <= threshold) continue;
+                off_B = B->offsets[i_B];
+                B->assignTiles(idx_B, off_B, assigned);
+            }
+
+            /*
+             * Loop over all tiles of the letters only in C
+             */
+            for (char c : only_C) assigned[(unsigned char)c] = 0;
+
+            for (bool done = false;!done;)
+            {
+                vector<int> tile_C(ndim);
+                for (int i = 0;i < ndim;i++) tile_C[i] = assigned[(unsigned char)idx_C[i]];
+
+                /*
+                 * A letter repeated in C may only be assigned one tile
+                 */
+                vector<int> check(256, -1);
+                if (assignTiles(idx_C, getOffset(tile_C), check))
+                {
+                    ops.push_back({getOffset(tile_C), off_A, off_B});
+                }
+
+                done = true;
+                for (char c : only_C)
+                {
+                    int& t = assigned[(unsigned char)c];
+                    if (++t < tiles[(unsigned char)c]->size())
+                    {
+                        done = false;
+                        break;
+                    }
+                    t = 0;
+                }
+            }
+        }
+    }
+
+    stable_sort(ops.begin(), ops.end(),
+                [](const TileOp& a, const TileOp& b) { return a.C < b.C; });
+}
+
+template <class T>
+void BlockSparseTensor<T>::finish(T beta, const set<int64_t>& written)
+{
+    for (int i = tensors.size()-1;i >= 0;i--)
+    {
+        if (!written.count(offsets[i]))
+        {
+            if (beta == (T)0)
+            {
+                freeTile(offsets[i]);
+                continue;
+            }
+            else if (beta == (T)1)
+            {
+                continue;
+            }
+            else if (tensors[i].tensor)
+            {
+                *tensors[i].tensor *= beta;
+            }
+        }
+
+        if (tensors[i].tensor) norms[i] = tensors[i].tensor->norm(2);
+    }
+
+    shareNorms();
+}
+
+template <class T>
+void BlockSparseTensor<T>::sum(T alpha, T beta)
+{
+    /*
+     * Adding a constant fills in every tile, while zeroing the tensor
+     * frees every tile
+     */
+    if (alpha != (T)0)
+    {
+        for (int64_t off = 0;off < getNumTiles();off++) allocateTile(off);
+    }
+    else if (beta == (T)0)
+    {
+        while (!offsets.empty()) freeTile(offsets.back());
+        return;
+    }
+
+    IndexableCompositeTensor<BlockSparseTensor<T>,CTFTensor<T>,T>::sum(alpha, beta);
+
+    updateNorms();
+}
+
+/*
+ * Element-wise operations apply to the stored tiles of this tensor for which
+ * the operands are also stored, as for other composite tensors. Tiles at
+ * the same offset have the same owner, so these need no communication.
+ */
+template <class T>
+void BlockSparseTensor<T>::div(T alpha, bool conja, const BlockSparseTensor<T>& A,
+                                        bool conjb, const BlockSparseTensor<T>& B, T beta)
+{
+    for (int i = 0;i < tensors.size();i++)
+    {
+        int i_A = A.find(offsets[i]);
+        int i_B = B.find(offsets[i]);
+        if (!tensors[i].tensor || i_A == -1 || i_B == -1) continue;
+
+        tensors[i].tensor->div(alpha, conja, *A.tensors[i_A].tensor,
+                                      conjb, *B.tensors[i_B].tensor, beta);
+    }
+
+    updateNorms();
+}
+
+template <class T>
+void BlockSparseTensor<T>::invert(T alpha, bool conja, const BlockSparseTensor<T>& A, T beta)
+{
+    for (int i = 0;i < tensors.size();i++)
+    {
+        int i_A = A.find(offsets[i]);
+        if (!tensors[i].tensor || i_A == -1) continue;
+
+        tensors[i].tensor->invert(alpha, conja, *A.tensors[i_A].tensor, beta);
+    }
+
+    updateNorms();
+}
+
+template <class T>
+void BlockSparseTensor<T>::localDots(bool conja, const vector<const BlockSparseTensor<T>*>& A, bool conjb,
+                                     vector<T>& scalars) const
+{
+    for (int i = 0;i < tensors.size();i++)
+    {
+        if (!tensors[i].tensor) continue;
+
+        vector<const CTFTensor<T>*> A_i;
+        vector<int> which;
+        for (int k = 0;k < A.size();k++)
+        {
+            int i_A = A[k]->find(offsets[i]);
+            if (i_A == -1) continue;
+            A_i.push_back(A[k]->tensors[i_A].tensor);
+            which.push_back(k);
+        }
+
+        vector<T> sub(A_i.size(), (T)0);
+        tensors[i].tensor->localDots(conja, A_i, conjb, sub);
+        for (int k = 0;k < which.size();k++) scalars[which[k]] += sub[k];
+    }
+}
+
+template <class T>
+void BlockSparseTensor<T>::mult(T alpha, bool conja, const BlockSparseTensor<T>& A, const string& idx_A,
+                                         bool conjb, const BlockSparseTensor<T>& B, const string& idx_B,
+                                T beta,                                             const string& idx_C)
+{
+    vector<TileOp> ops;
+    matchTiles(alpha, A, idx_A, &B, idx_B, idx_C, threshold, ops);
+
+    set<pair<int64_t,int>> needed_A, needed_B;
+    for (auto& op : ops)
+    {
+        needed_A.insert(make_pair(op.A, owner(op.C)));
+        needed_B.insert(make_pair(op.B, owner(op.C)));
+    }
+
+    map<int64_t,unique_ptr<CTFTensor<T>>> copies_A, copies_B;
+    A.sendTiles(needed_A, copies_A);
+    B.sendTiles(needed_B, copies_B);
+
+    set<int64_t> written;
+    for (auto& op : ops)
+    {
+        CTFTensor<T>* C = allocateTile(op.C);
+
+        if (C)
+        {
+            C->mult(alpha, conja, A.tileAt(op.A, copies_A), idx_A,
+                           conjb, B.tileAt(op.B, copies_B), idx_B,
+                    (written.count(op.C) ? (T)1 : beta), idx_C);
+        }
+
+        written.insert(op.C);
+    }
+
+    finish(beta, written);
+}
+
+template <class T>
+void BlockSparseTensor<T>::sum(T alpha, bool conja, const BlockSparseTensor<T>& A, const string& idx_A,
+                               T beta,                                             const string& idx_B)
+{
+    vector<TileOp> ops;
+    matchTiles(alpha, A, idx_A, NULL, "", idx_B, 0, ops);
+
+    set<pair<int64_t,int>> needed_A;
+    for (auto& op : ops) needed_A.insert(make_pair(op.A, owner(op.C)));
+
+    map<int64_t,unique_ptr<CTFTensor<T>>> copies_A;
+    A.sendTiles(needed_A, copies_A);
+
+    set<int64_t> written;
+    for (auto& op : ops)
+    {
+        CTFTensor<T>* C = allocateTile(op.C);
+
+        if (C)
+        {
+            C->sum(alpha, conja, A.tileAt(op.A, copies_A), idx_A,
+                   (written.count(op.C) ? (T)1 : beta), idx_B);
+        }
+
+        written.insert(op.C);
+    }
+
+    finish(beta, written);
+}
+
+template <class T>
+void BlockSparseTensor<T>::scale(T alpha, const string& idx_A)
+{
+    for (int i = 0;i < tensors.size();i++)
+    {
+        /*
+         * Only tiles on the diagonal of repeated indices contain any of the
+         * scaled elements
+         */
+        vector<int> assigned(256, -1);
+        if (!tensors[i].tensor || !assignTiles(idx_A, offsets[i], assigned)) continue;
+
+        tensors[i].tensor->scale(alpha, idx_A);
+        norms[i] = tensors[i].tensor->norm(2);
+    }
+
+    shareNorms();
+}
+
+template <class T>
+T BlockSparseTensor<T>::dot(bool conja, const BlockSparseTensor<T>& A, const string& idx_A,
+                            bool conjb,                                const string& idx_B) const
+{
+    /*
+     * Match the tiles of A against those of this tensor, with a scalar
+     * result; only exactly zero products are skipped. Each product is
+     * formed by the owner of the tile of this tensor.
+     */
+    vector<TileOp> ops;
+    scalar().matchTiles((T)1, A, idx_A, this, idx_B, "", -1, ops);
+
+    set<pair<int64_t,int>> needed_A;
+    for (auto& op : ops) needed_A.insert(make_pair(op.A, owner(op.B)));
+
+    map<int64_t,unique_ptr<CTFTensor<T>>> copies_A;
+    A.sendTiles(needed_A, copies_A);
+
+    T s = 0;
+    for (auto& op : ops)
+    {
+        if (!isLocal(op.B)) continue;
+
+        s += tileAt(op.B).dot(conja, A.tileAt(op.A, copies_A), idx_A,
+                              conjb,                           idx_B);
+    }
+
+    this->arena.comm().Allreduce(&s, 1, MPI_SUM);
+
+    return s;
+}
+
+template <class T>
+real_type_t<T> BlockSparseTensor<T>::norm(int p) const
+{
+    real_type_t<T> nrm = 0;
+
+    /*
+     * The 2-norms of all tiles are known everywhere, while the others are
+     * reduced over the owners
+     */
+    for (int i = 0;i < tensors.size();i++)
+    {
+        if (p == 2)
+        {
+            nrm += norms[i]*norms[i];
+        }
+        else if (!tensors[i].tensor)
+        {
+            continue;
+        }
+        else if (p == 0)
+        {
+            nrm = max(nrm, tensors[i].tensor->norm(p));
+        }
+        else if (p == 1)
+        {
+            nrm += tensors[i].tensor->norm(p);
+        }
+    }
+
+    if (p == 2) nrm = sqrt(nrm);
+    if (p == 0) this->arena.comm().Allreduce(&nrm, 1, MPI_MAX);
+    if (p == 1) this->arena.comm().Allreduce(&nrm, 1, MPI_SUM);
+
+    return nrm;
+}
+
+INSTANTIATE_ALL_SPECIALIZATIONS(BlockSparseTensor);
+
+}
+}
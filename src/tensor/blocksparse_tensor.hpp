@@ -0,0 +1,257 @@
+#ifndef _AQUARIUS_TENSOR_BLOCKSPARSE_TENSOR_HPP_
+#define _AQUARIUS_TENSOR_BLOCKSPARSE_TENSOR_HPP_
+
+#include "util/global.hpp"
+
+#include "task/task.hpp"
+
+#include "composite_tensor.hpp"
+#include "ctf_tensor.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+/*
+ * A tensor divided into tiles along each dimension, of which only the
+ * non-negligible ones are stored. Tiles which have never been written are
+ * zero and take no memory, and tiles are allocated as needed by writing to
+ * them or by operations which produce them.
+ *
+ * The Frobenius norm of each tile is kept, and contractions skip any pair
+ * of tiles for which |alpha|*norm(A)*norm(B) does not exceed the threshold
+ * of the output tensor. Summation and scaling are exact.
+ *
+ * Indices which are contracted, summed, or otherwise matched between
+ * tensors must be divided into the same tiles. Tiles are not symmetric,
+ * so all indices are NS.
+ *
+ * Each tile is stored by a single process, its owner, on an arena of that
+ * process alone, so that small tiles are held densely and contracted
+ * locally. Tiles are dealt out to the processes cyclically by offset. Every
+ * process knows which tiles exist and their norms, but the entries of
+ * tensors for tiles owned by other processes are NULL. Each tile of the
+ * output of an operation is computed by its owner, which first receives any
+ * tiles of the operands which it does not own. All operations are
+ * collective, and the operands must be on the same arena.
+ */
+template <typename T>
+class BlockSparseTensor : public IndexableCompositeTensor<BlockSparseTensor<T>,CTFTensor<T>,T>,
+                          public Distributed
+{
+    INHERIT_FROM_INDEXABLE_COMPOSITE_TENSOR(BlockSparseTensor<T>,CTFTensor<T>,T)
+
+    protected:
+        vector<vector<int>> len;
+        Arena local;
+        /*
+         * Only the stored tiles are kept: tensors[i] is the tile at offset
+         * offsets[i] with norm norms[i], in order of increasing offset
+         */
+        vector<int64_t> offsets;
+        vector<real_type_t<T>> norms;
+        double threshold;
+        mutable unique_ptr<BlockSparseTensor<T>> scalar_;
+
+        /*
+         * A single tile contraction C[idx_C] = alpha*A[idx_A]*B[idx_B]
+         * (+ beta*C[idx_C] the first time tile C is written)
+         */
+        struct TileOp
+        {
+            int64_t C, A, B;
+        };
+
+        int64_t getNumTiles() const;
+
+        vector<int> getTile(int64_t off) const;
+
+        int64_t getOffset(const vector<int>& tile) const;
+
+        vector<int> getTileLengths(int64_t off) const;
+
+        int owner(int64_t off) const { return off%this->arena.size; }
+
+        bool isLocal(int64_t off) const { return owner(off) == this->arena.rank; }
+
+        /*
+         * The position in tensors of the tile at off, or -1 if it is not
+         * stored
+         */
+        int find(int64_t off) const;
+
+        /*
+         * The tile at off, which must be owned by this process
+         */
+        const CTFTensor<T>& tileAt(int64_t off) const;
+
+        /*
+         * The tile at off, either owned by this process or received into
+         * copies by sendTiles
+         */
+        const CTFTensor<T>& tileAt(int64_t off, const map<int64_t,unique_ptr<CTFTensor<T>>>& copies) const;
+
+        /*
+         * Add the tile at off to the stored tiles if it is not there already,
+         * and return it on its owner (NULL elsewhere)
+         */
+        CTFTensor<T>* allocateTile(int64_t off);
+
+        void freeTile(int64_t off);
+
+        void updateNorm(int64_t off);
+
+        /*
+         * Make the norms of the tiles, as set by their owners, known to
+         * every process
+         */
+        void shareNorms();
+
+        /*
+         * For each (offset, rank) in needed, send the tile at offset to
+         * process rank unless it already owns it. Received tiles are placed
+         * in copies. Every process walks through needed in the same order,
+         * so the transfers cannot deadlock.
+         */
+        void sendTiles(const set<pair<int64_t,int>>& needed,
+                       map<int64_t,unique_ptr<CTFTensor<T>>>& copies) const;
+
+        /*
+         * Check that every letter is divided into the same tiles everywhere
+         * that it appears, and record the division of each letter
+         */
+        void checkTiles(const string& idx, vector<const vector<int>*>& tiles) const;
+
+        /*
+         * Assign the tile indices of the tile at off to the letters in idx,
+         * and return false if a repeated letter would be assigned different
+         * tiles (in which case the tile does not take part)
+         */
+        bool assignTiles(const string& idx, int64_t off, vector<int>& assigned) const;
+
+        /*
+         * Append to ops the tiles of this tensor, for each product of tiles
+         * of A and B, that the product contributes to. If B is NULL then
+         * only A is considered. Products for which |alpha|*norm(A)*norm(B)
+         * does not exceed threshold are skipped.
+         */
+        void matchTiles(T alpha, const BlockSparseTensor<T>& A, const string& idx_A,
+                                 const BlockSparseTensor<T>* B, const string& idx_B,
+                                                                const string& idx_C,
+                        double threshold, vector<TileOp>& ops) const;
+
+        /*
+         * Scale the tiles which were not written by an operation by beta,
+         * freeing them if beta is zero, and update the norms
+         */
+        void finish(T beta, const set<int64_t>& written);
+
+    public:
+        BlockSparseTensor(const BlockSparseTensor<T>& other);
+
+        BlockSparseTensor(const string& name, const BlockSparseTensor<T>& other);
+
+        BlockSparseTensor(const string& name, const BlockSparseTensor<T>& other, T scalar);
+
+        /*
+         * len[i] gives the length of each tile along dimension i. All tiles
+         * are initially zero.
+         */
+        BlockSparseTensor(const string& name, const Arena& arena, int ndim,
+                          const vector<vector<int>>& len);
+
+        const vector<vector<int>>& getLengths() const { return len; }
+
+        double getThreshold() const { return threshold; }
+
+        void setThreshold(double threshold) { this->threshold = threshold; }
+
+        bool exists(const vector<int>& tile) const
+        {
+            return find(getOffset(tile)) != -1;
+        }
+
+        bool isLocal(const vector<int>& tile) const
+        {
+            return isLocal(getOffset(tile));
+        }
+
+        /*
+         * Allocate (and zero) the tile if it does not exist
+         */
+        void allocate(const vector<int>& tile);
+
+        /*
+         * A tile owned by this process. Tiles which are modified through the
+         * returned reference must be followed by a call to updateNorms.
+         */
+        CTFTensor<T>& operator()(const vector<int>& tile);
+
+        const CTFTensor<T>& operator()(const vector<int>& tile) const;
+
+        real_type_t<T> getNorm(const vector<int>& tile) const
+        {
+            int i = find(getOffset(tile));
+            return (i == -1 ? 0 : norms[i]);
+        }
+
+        void updateNorms();
+
+        /*
+         * Free all tiles with a norm not larger than cutoff
+         */
+        void screen(double cutoff);
+
+        /*
+         * The elements of the tile held by this process, i.e. none unless it
+         * owns the tile
+         */
+        void getLocalData(const vector<int>& tile, vector<tkv_pair<T>>& pairs) const;
+
+        /*
+         * Read the elements at the keys in pairs from any process (zero if
+         * the tile does not exist)
+         */
+        void getRemoteData(const vector<int>& tile, vector<tkv_pair<T>>& pairs) const;
+
+        void getRemoteData(const vector<int>& tile) const;
+
+        /*
+         * Write the pairs from every process, allocating the tile if needed
+         */
+        void writeRemoteData(const vector<int>& tile, const vector<tkv_pair<T>>& pairs);
+
+        void writeRemoteData(const vector<int>& tile);
+
+        BlockSparseTensor<T>& scalar() const;
+
+        void sum(T alpha, T beta);
+
+        void div(T alpha, bool conja, const BlockSparseTensor<T>& A,
+                          bool conjb, const BlockSparseTensor<T>& B, T beta);
+
+        void invert(T alpha, bool conja, const BlockSparseTensor<T>& A, T beta);
+
+        void localDots(bool conja, const vector<const BlockSparseTensor<T>*>& A, bool conjb,
+                       vector<T>& scalars) const;
+
+        void mult(T alpha, bool conja, const BlockSparseTensor<T>& A, const string& idx_A,
+                           bool conjb, const BlockSparseTensor<T>& B, const string& idx_B,
+                  T beta,                                             const string& idx_C);
+
+        void sum(T alpha, bool conja, const BlockSparseTensor<T>& A, const string& idx_A,
+                 T beta,                                             const string& idx_B);
+
+        void scale(T alpha, const string& idx_A);
+
+        T dot(bool conja, const BlockSparseTensor<T>& A, const string& idx_A,
+              bool conjb,                                const string& idx_B) const;
+
+        real_type_t<T> norm(int p) const;
+};
+
+}
+}
+
+#endif
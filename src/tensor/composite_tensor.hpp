@@ -163,6 +163,114 @@ class CompositeTensor : public Tensor<Derived,T>
             return tensors[idx] != NULL;
         }
 
+        /*
+         * Save each owned component to file.<component>
+         */
+        void save(const string& file) const
+        {
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    tensors[i].tensor->save(file + "." + str(i));
+                }
+            }
+        }
+
+        bool load(const string& file)
+        {
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    if (!tensors[i].tensor->load(file + "." + str(i))) return false;
+                }
+            }
+
+            return true;
+        }
+
+        /*
+         * Copy each owned component into the corresponding component of
+         * other, which has the same structure but may live on a smaller arena
+         * (see CTFTensor::copyTo). Processes outside of other's arena pass
+         * NULL.
+         */
+        void copyTo(Derived* other) const
+        {
+            CompositeTensor<Derived,Base,T>* other_ = other;
+
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    tensors[i].tensor->copyTo(other_ ? other_->tensors[i].tensor : NULL);
+                }
+            }
+        }
+
+        /*
+         * The reverse of copyTo: overwrite each owned component with the
+         * corresponding component of other, which may live on a smaller
+         * arena. Processes outside of other's arena pass NULL.
+         */
+        void copyFrom(const Derived* other)
+        {
+            const CompositeTensor<Derived,Base,T>* other_ = other;
+
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    tensors[i].tensor->copyFrom(other_ ? other_->tensors[i].tensor : NULL);
+                }
+            }
+        }
+
+        /*
+         * Keep each owned component on disk or in single precision whenever
+         * it is not in use (see CTFTensor::setStorage)
+         */
+        void setStorage(Storage storage)
+        {
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    tensors[i].tensor->setStorage(storage);
+                }
+            }
+        }
+
+        Storage getStorage() const
+        {
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    return tensors[i].tensor->getStorage();
+                }
+            }
+
+            return IN_CORE;
+        }
+
+        /*
+         * Convert each owned component from the corresponding component of
+         * a composite tensor of the same structure in another precision
+         */
+        template <typename Other>
+        void convert(const Other& other)
+        {
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    tensors[i].tensor->convert(other(i));
+                }
+            }
+        }
+
         /**********************************************************************
          *
          * Subtensor indexing
@@ -291,6 +399,29 @@ class CompositeTensor : public Tensor<Derived,T>
 
             return s;
         }
+
+        void localDots(bool conja, const vector<const Derived*>& A, bool conjb, vector<T>& scalars) const
+        {
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] == NULL || tensors[i].ref != -1) continue;
+
+                vector<const Base*> A_i;
+                vector<int> which;
+                for (int k = 0;k < A.size();k++)
+                {
+                    if (A[k]->exists(i))
+                    {
+                        A_i.push_back(&(*A[k])(i));
+                        which.push_back(k);
+                    }
+                }
+
+                vector<T> sub(A_i.size(), (T)0);
+                tensors[i].tensor->localDots(conja, A_i, conjb, sub);
+                for (int k = 0;k < which.size();k++) scalars[which[k]] += sub[k];
+            }
+        }
 };
 
 template <class Derived, class Base, class T>
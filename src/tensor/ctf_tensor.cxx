@@ -1,5 +1,9 @@
 #include "ctf_tensor.hpp"
 
+#include <unistd.h>
+
+#include "time/ledger.hpp"
+
 namespace aquarius
 {
 namespace tensor
@@ -8,6 +12,18 @@ namespace tensor
 template <typename T>
 map<const tCTF_World<T>*,pair<int,CTFTensor<T>*>> CTFTensor<T>::scalars;
 
+template <typename T>
+list<typename CTFTensor<T>::PoolEntry> CTFTensor<T>::pool;
+
+template <typename T>
+PoolStatistics CTFTensor<T>::poolStats;
+
+template <typename T>
+int64_t CTFTensor<T>::poolLimit = 0;
+
+template <typename T>
+int64_t CTFTensor<T>::denseLimit = 1l<<30;
+
 /*
  * Create a scalar (0-dimensional tensor)
  */
@@ -16,7 +32,7 @@ CTFTensor<T>::CTFTensor(const string& name, const Arena& arena, T scalar)
 : IndexableTensor< CTFTensor<T>,T >(name), Distributed(arena), len(0), sym(0)
 {
     allocate();
-    *dt = scalar;
+    set(scalar);
     register_scalar();
 }
 
@@ -29,7 +45,7 @@ CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, T scalar)
   len(0), sym(0)
 {
     allocate();
-    *dt = scalar;
+    set(scalar);
     register_scalar();
 }
 
@@ -41,15 +57,22 @@ CTFTensor<T>::CTFTensor(const CTFTensor<T>& A, bool copy, bool zero)
 : IndexableTensor< CTFTensor<T>,T >(A.name, A.ndim), Distributed(A.arena),
   len(A.len), sym(A.sym)
 {
-    allocate();
-
-    if (copy)
+    if (copy && !A.ooc)
     {
-        *this = A;
+        share(A);
     }
-    else if (zero)
+    else
     {
-        *dt = (T)0;
+        allocate();
+
+        if (copy)
+        {
+            *this = A;
+        }
+        else if (zero)
+        {
+            set((T)0);
+        }
     }
 
     register_scalar();
@@ -63,15 +86,22 @@ CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, bool copy, bo
 : IndexableTensor< CTFTensor<T>,T >(name, A.ndim), Distributed(A.arena),
   len(A.len), sym(A.sym)
 {
-    allocate();
-
-    if (copy)
+    if (copy && !A.ooc)
     {
-        *this = A;
+        share(A);
     }
-    else if (zero)
+    else
     {
-        *dt = (T)0;
+        allocate();
+
+        if (copy)
+        {
+            *this = A;
+        }
+        else if (zero)
+        {
+            set((T)0);
+        }
     }
 
     register_scalar();
@@ -83,6 +113,11 @@ CTFTensor<T>::CTFTensor(const string& name, CTFTensor<T>* A)
   len(A->len), sym(A->sym)
 {
     dt = A->dt;
+    dense = A->dense;
+    ooc = move(A->ooc);
+    owner = move(A->owner);
+    A->dt = NULL;
+    A->dense = NULL;
     delete A;
     register_scalar();
 }
@@ -114,7 +149,7 @@ CTFTensor<T>::CTFTensor(const string& name, const Arena& arena, int ndim, const
     #endif //VALIDATE_INPUTS
 
     allocate();
-    if (zero) *dt = (T)0;
+    if (zero) set((T)0);
 
     register_scalar();
 }
@@ -123,24 +158,424 @@ template <typename T>
 CTFTensor<T>::~CTFTensor()
 {
     unregister_scalar();
+
+    if (ooc && ooc->storage == ON_DISK) std::remove(ooc->file.c_str());
+
     free();
 }
 
+/*
+ * Reused storage is zeroed and renamed, as new storage would be
+ */
+template <typename T>
+mutex& CTFTensor<T>::poolMutex()
+{
+    static mutex m;
+    return m;
+}
+
+template <typename T>
+recursive_mutex& CTFTensor<T>::scalarsMutex()
+{
+    static recursive_mutex m;
+    return m;
+}
+
+template <typename T>
+mutex& CTFTensor<T>::ownerMutex()
+{
+    static mutex m;
+    return m;
+}
+
 template <typename T>
 void CTFTensor<T>::allocate()
 {
-    dt = new tCTF_Tensor<T>(ndim, len.data(), sym.data(), arena.ctf<T>(), this->name.c_str(), 1);
+    lock_guard<mutex> lock(poolMutex());
+
+    for (auto it = pool.begin();it != pool.end();++it)
+    {
+        if (sameArena(it->arena, arena) && it->len == len && it->sym == sym)
+        {
+            dt = it->dt;
+            dense = NULL;
+            if (dt) dt->name = this->name.c_str();
+            if (it->dense)
+            {
+                dense = new DenseTensor<T>(this->name, move(*it->dense));
+                delete it->dense;
+            }
+            poolStats.bytes -= it->bytes;
+            poolStats.hits++;
+            pool.erase(it);
+            set((T)0);
+            return;
+        }
+    }
+
+    poolStats.misses++;
+
+    /*
+     * A miss means new storage, so the pool gives up enough of what it holds
+     * for the two together to stay within the limit
+     */
+    evict(arena, poolLimit-localBytes());
+
+    double unpacked = sizeof(T);
+    for (int i = 0;i < this->ndim;i++) unpacked *= len[i];
+
+    if (arena.size == 1 && unpacked <= denseLimit)
+    {
+        dt = NULL;
+
+        /*
+         * Only this process uses a single-process arena, so its pool can be
+         * emptied without getting out of step with any other
+         */
+        try
+        {
+            dense = new DenseTensor<T>(this->name, ndim, len, sym, false);
+        }
+        catch (bad_alloc&)
+        {
+            evict(arena, 0);
+            dense = new DenseTensor<T>(this->name, ndim, len, sym, false);
+        }
+    }
+    else
+    {
+        dt = new tCTF_Tensor<T>(ndim, len.data(), sym.data(), arena.ctf<T>(), this->name.c_str(), 1);
+        dense = NULL;
+    }
 }
 
+/*
+ * The most recently freed storage is at the front of the pool, and that
+ * freed longest ago is evicted first
+ */
 template <typename T>
 void CTFTensor<T>::free()
 {
+    if (!dt && !dense) return;
+
+    {
+        lock_guard<mutex> lock(ownerMutex());
+
+        bool shared = isShared();
+        owner.reset();
+
+        if (shared)
+        {
+            dt = NULL;
+            dense = NULL;
+            return;
+        }
+    }
+
+    lock_guard<mutex> lock(poolMutex());
+
+    int64_t bytes = localBytes();
+    if (bytes > poolLimit)
+    {
+        delete dt;
+        delete dense;
+        return;
+    }
+
+    evict(arena, poolLimit-bytes);
+
+    pool.push_front(PoolEntry{arena, len, sym, dt, dense, bytes});
+    poolStats.bytes += bytes;
+    poolStats.peak = max(poolStats.peak, poolStats.bytes);
+}
+
+template <typename T>
+void CTFTensor<T>::evict(const Arena& arena, int64_t limit)
+{
+    int64_t held = 0;
+    for (auto& e : pool)
+    {
+        if (sameArena(e.arena, arena)) held += e.bytes;
+    }
+
+    for (auto it = pool.end();held > limit && it != pool.begin();)
+    {
+        --it;
+        if (!sameArena(it->arena, arena)) continue;
+
+        held -= it->bytes;
+        poolStats.bytes -= it->bytes;
+        poolStats.evictions++;
+        delete it->dt;
+        delete it->dense;
+        it = pool.erase(it);
+    }
+}
+
+template <typename T>
+int64_t CTFTensor<T>::localBytes() const
+{
+    int64_t size = 1;
+    for (int i = 0;i < this->ndim;)
+    {
+        int j; for (j = i;j < this->ndim-1 && sym[j] != NS;j++);
+        int n = j-i+1;
+        if (sym[i] == SY) size *= binom(len[i]+n-1, n);
+        else if (sym[i] == NS) size *= len[i];
+        else size *= binom(len[i], n);
+        i = j+1;
+    }
+    return size*sizeof(T)/arena.size;
+}
+
+template <typename T>
+void CTFTensor<T>::setPoolLimit(int64_t bytes)
+{
+    lock_guard<mutex> lock(poolMutex());
+    poolLimit = bytes;
+}
+
+template <typename T>
+void CTFTensor<T>::setDenseLimit(int64_t bytes)
+{
+    denseLimit = bytes;
+}
+
+template <typename T>
+tCTF_Tensor<T>& CTFTensor<T>::ctfData(unique_ptr<tCTF_Tensor<T>>& tmp) const
+{
+    if (dt) return *dt;
+
+    tmp.reset(new tCTF_Tensor<T>(this->ndim, len.data(), sym.data(),
+                                 const_cast<tCTF_World<T>&>(arena.ctf<T>()), this->name.c_str(), 1));
+
+    vector<tkv_pair<T>> pairs;
+    dense->getLocalData(pairs);
+    tmp->write(pairs.size(), pairs.data());
+
+    return *tmp;
+}
+
+template <typename T>
+void CTFTensor<T>::writeBack(const unique_ptr<tCTF_Tensor<T>>& tmp)
+{
+    if (!tmp) return;
+
+    int64_t npair;
+    tkv_pair<T> *data;
+    tmp->read_local(&npair, &data);
+    dense->writeRemoteData(vector<tkv_pair<T>>(data, data+npair));
+    if (npair > 0) ::free(data);
+}
+
+template <typename T>
+void CTFTensor<T>::clearPool()
+{
+    lock_guard<mutex> lock(poolMutex());
+
+    for (auto& e : pool)
+    {
+        delete e.dt;
+        delete e.dense;
+    }
+    pool.clear();
+    poolStats.bytes = 0;
+}
+
+template <typename T>
+void CTFTensor<T>::setStorage(Storage storage)
+{
+    if (storage == SINGLE_PRECISION && !is_same<T,double>::value) storage = IN_CORE;
+
+    if (storage == getStorage()) return;
+
+    if (ooc)
+    {
+        pageIn();
+        if (ooc->storage == ON_DISK) std::remove(ooc->file.c_str());
+        ooc.reset();
+    }
+
+    if (storage == IN_CORE) return;
+
+    unshare();
+
+    ooc.reset(new OutOfCoreState());
+    ooc->storage = storage;
+
+    if (storage == ON_DISK)
+    {
+        static int nfile = 0;
+        ooc->file = OutOfCore::directory() + "/aquarius." + str(getpid()) + "." + str(nfile++);
+    }
+
+    pageOut();
+}
+
+template <typename T>
+vector<tkv_pair<T>> CTFTensor<T>::readPages(const string& file)
+{
+    FILE* fp = fopen(file.c_str(), "rb");
+    if (!fp) throw runtime_error("Could not open " + file + " for reading");
+
+    fseek(fp, 0, SEEK_END);
+    size_t npair = ftell(fp)/sizeof(tkv_pair<T>);
+    fseek(fp, 0, SEEK_SET);
+
+    vector<tkv_pair<T>> pairs(npair);
+    if (fread(pairs.data(), sizeof(tkv_pair<T>), npair, fp) != npair)
+        throw runtime_error("Could not read " + file);
+
+    fclose(fp);
+
+    return pairs;
+}
+
+/*
+ * Every process of the arena must page in at the same time, since writing
+ * the elements back into a CTF tensor is collective
+ */
+template <typename T>
+void CTFTensor<T>::pageIn() const
+{
+    if (!ooc || dt || dense) return;
+
+    vector<tkv_pair<T>> pairs;
+    if (ooc->storage == ON_DISK)
+    {
+        pairs = readPages(ooc->file);
+    }
+    else
+    {
+        vector<tkv_pair<float>> single;
+        ooc->single->getLocalData(single);
+        pairs.reserve(single.size());
+        for (auto& p : single) pairs.push_back(tkv_pair<T>(p.k, (T)p.d));
+    }
+
+    const_cast<CTFTensor<T>&>(*this).allocate();
+    if (dense) dense->writeRemoteData(pairs);
+    else dt->write(pairs.size(), pairs.data());
+
+    ooc->dirty = false;
+}
+
+template <typename T>
+void CTFTensor<T>::pageOut() const
+{
+    if (!ooc || ooc->pins > 0 || (!dt && !dense)) return;
+
+    if (ooc->dirty)
+    {
+        vector<tkv_pair<T>> pairs;
+        if (dense)
+        {
+            dense->getLocalData(pairs);
+        }
+        else
+        {
+            int64_t npair;
+            tkv_pair<T> *data;
+            dt->read_local(&npair, &data);
+            pairs.assign(data, data+npair);
+            if (npair > 0) ::free(data);
+        }
+
+        if (ooc->storage == ON_DISK)
+        {
+            FILE* fp = fopen(ooc->file.c_str(), "wb");
+            if (!fp) throw runtime_error("Could not open " + ooc->file + " for writing");
+
+            if (fwrite(pairs.data(), sizeof(tkv_pair<T>), pairs.size(), fp) != pairs.size())
+                throw runtime_error("Could not write " + ooc->file);
+
+            fclose(fp);
+        }
+        else
+        {
+            if (!ooc->single)
+                ooc->single.reset(new CTFTensor<float>(this->name, this->arena, this->ndim, len, sym, false));
+
+            vector<tkv_pair<float>> single;
+            single.reserve(pairs.size());
+            for (auto& p : pairs) single.push_back(tkv_pair<float>(p.k, (float)real(p.d)));
+            ooc->single->writeRemoteData(single);
+        }
+
+        ooc->dirty = false;
+    }
+
+    /*
+     * The storage is not pooled, since the point is to release the memory
+     */
     delete dt;
+    delete dense;
+    dt = NULL;
+    dense = NULL;
+}
+
+template <typename T>
+void CTFTensor<T>::share(const CTFTensor<T>& A)
+{
+    lock_guard<mutex> lock(ownerMutex());
+
+    if (!A.owner) A.owner = make_shared<char>();
+
+    owner = A.owner;
+    dt = A.dt;
+    dense = A.dense;
+}
+
+template <typename T>
+void CTFTensor<T>::unshare()
+{
+    /*
+     * Of two copies unsharing at once, only the first duplicates the
+     * storage; the other is then the sole owner of the original
+     */
+    lock_guard<mutex> lock(ownerMutex());
+
+    if (!isShared()) return;
+
+    if (dense) dense = new DenseTensor<T>(*dense);
+    else dt = new tCTF_Tensor<T>(*dt, true);
+
+    owner.reset();
+}
+
+template <typename T>
+void CTFTensor<T>::pin(bool modify) const
+{
+    if (modify) const_cast<CTFTensor<T>&>(*this).unshare();
+
+    if (!ooc) return;
+
+    ooc->pins++;
+    pageIn();
+    if (modify) ooc->dirty = true;
+}
+
+template <typename T>
+void CTFTensor<T>::unpin() const
+{
+    if (!ooc) return;
+
+    assert(ooc->pins > 0);
+    if (--ooc->pins == 0) pageOut();
+}
+
+template <typename T>
+void CTFTensor<T>::set(T val)
+{
+    if (dense) dense->sum(val, (T)0);
+    else *dt = val;
 }
 
 template <typename T>
 void CTFTensor<T>::register_scalar()
 {
+    lock_guard<recursive_mutex> lock(scalarsMutex());
+
     if (scalars.find(&arena.ctf<T>()) == scalars.end())
     {
         /*
@@ -159,6 +594,8 @@ void CTFTensor<T>::register_scalar()
 template <typename T>
 void CTFTensor<T>::unregister_scalar()
 {
+    lock_guard<recursive_mutex> lock(scalarsMutex());
+
     /*
      * The last tensor (besides the scalar in scalars)
      * will delete the entry, so if it does not exist
@@ -182,33 +619,64 @@ void CTFTensor<T>::unregister_scalar()
 template <typename T>
 CTFTensor<T>& CTFTensor<T>::scalar() const
 {
+    lock_guard<recursive_mutex> lock(scalarsMutex());
     return *scalars[&arena.ctf<T>()].second;
 }
 
+template <typename T>
+const CTFTensor<T>& CTFTensor<T>::conjugated(bool conja, const CTFTensor<T>& A,
+                                             unique_ptr<CTFTensor<T>>& tmp)
+{
+    if (!conja || !is_complex<T>::value) return A;
+
+    tmp.reset(new CTFTensor<T>(A));
+
+    vector<tkv_pair<T>> pairs;
+    tmp->getLocalData(pairs);
+    for (auto& p : pairs) p.d = conj(p.d);
+    tmp->writeRemoteData(pairs);
+
+    return *tmp;
+}
+
 template <typename T>
 void CTFTensor<T>::resize(int ndim, const vector<int>& len, const vector<int>& sym, bool zero)
 {
     assert(len.size() == ndim);
     assert(sym.size() == ndim);
 
+    Resident r(*this);
+
     this->ndim = ndim;
     this->len = len;
     this->sym = sym;
 
     free();
     allocate();
-    if (zero) *dt = (T)0;
+    if (zero) set((T)0);
 }
 
 template <typename T>
 T* CTFTensor<T>::getRawData(int64_t& size)
 {
+    unshare();
+    pageIn();
+    if (ooc) ooc->dirty = true;
+
     return const_cast<T*>(const_cast<const CTFTensor<T>&>(*this).getRawData(size));
 }
 
 template <typename T>
 const T* CTFTensor<T>::getRawData(int64_t& size) const
 {
+    pageIn();
+
+    if (dense)
+    {
+        size = dense->getSize();
+        return dense->getData();
+    }
+
     long_int size_;
     T* data = dt->get_raw_data(&size_);
     size = size_;
@@ -238,6 +706,14 @@ void CTFTensor<T>::slice(T alpha, bool conja, const CTFTensor<T>& A, const vecto
 {
     assert(this->ndim == A.ndim);
 
+    Resident r(*this), r_A(A);
+
+    if (dense && A.dense)
+    {
+        dense->slice(alpha, conja, *A.dense, start_A, beta, start_B, len);
+        return;
+    }
+
     vector<int> end_A(this->ndim);
     vector<int> end_B(this->ndim);
 
@@ -252,7 +728,10 @@ void CTFTensor<T>::slice(T alpha, bool conja, const CTFTensor<T>& A, const vecto
         assert(end_B[i] <= this->len[i]);
     }
 
-    dt->slice(start_B.data(), end_B.data(), beta, *A.dt, start_A.data(), end_A.data(), alpha);
+    unique_ptr<tCTF_Tensor<T>> ctf_A, ctf_B;
+    ctfData(ctf_B).slice(start_B.data(), end_B.data(), beta,
+                         A.ctfData(ctf_A), start_A.data(), end_A.data(), alpha);
+    writeBack(ctf_B);
 }
 
 
@@ -272,6 +751,16 @@ template <typename T>
 void CTFTensor<T>::div(T alpha, bool conja, const CTFTensor<T>& A,
                                  bool conjb, const CTFTensor<T>& B, T beta)
 {
+    Resident r(*this), r_A(A), r_B(B);
+
+    assert(!dense == !A.dense && !dense == !B.dense);
+
+    if (dense)
+    {
+        dense->div(alpha, conja, *A.dense, conjb, *B.dense, beta);
+        return;
+    }
+
     const_cast<tCTF_Tensor<T>*>(A.dt)->align(*dt);
     const_cast<tCTF_Tensor<T>*>(B.dt)->align(*dt);
 
@@ -360,6 +849,16 @@ void CTFTensor<T>::div(T alpha, bool conja, const CTFTensor<T>& A,
 template <typename T>
 void CTFTensor<T>::invert(T alpha, bool conja, const CTFTensor<T>& A, T beta)
 {
+    Resident r(*this), r_A(A);
+
+    assert(!dense == !A.dense);
+
+    if (dense)
+    {
+        dense->invert(alpha, conja, *A.dense, beta);
+        return;
+    }
+
     dt->align(*A.dt);
     int64_t size, size_A;
     T* raw_data = getRawData(size);
@@ -390,18 +889,27 @@ void CTFTensor<T>::invert(T alpha, bool conja, const CTFTensor<T>& A, T beta)
 template <typename T>
 void CTFTensor<T>::print(FILE* fp, double cutoff) const
 {
-    dt->print(fp, cutoff);
+    Resident r(*this);
+    if (dense) dense->print(fp, cutoff);
+    else dt->print(fp, cutoff);
 }
 
 template <typename T>
 void CTFTensor<T>::compare(FILE* fp, const CTFTensor<T>& other, double cutoff) const
 {
-    dt->compare(*other.dt, fp, cutoff);
+    Resident r(*this), r_other(other);
+    assert(!dense == !other.dense);
+    if (dense) dense->compare(fp, *other.dense, cutoff);
+    else dt->compare(*other.dt, fp, cutoff);
 }
 
 template <typename T>
 real_type_t<T> CTFTensor<T>::norm(int p) const
 {
+    Resident r(*this);
+
+    if (dense) return dense->norm(p);
+
     T ans = (T)0;
     if (p == 00)
     {
@@ -435,7 +943,29 @@ void CTFTensor<T>::mult(T alpha, bool conja, const CTFTensor<T>& A, const string
                                   bool conjb, const CTFTensor<T>& B, const string& idx_B,
                          T  beta,                                     const string& idx_C)
 {
-    (*this->dt)[idx_C.c_str()]*beta += alpha*(*A.dt)[idx_A.c_str()]*(*B.dt)[idx_B.c_str()];
+    #ifdef PROFILE
+    time::LedgerScope ledger("mult", {this->name, A.name, B.name}, {idx_C, idx_A, idx_B},
+                             {len, A.len, B.len}, {sym, A.sym, B.sym});
+    #endif
+
+    Resident r(*this), r_A(A), r_B(B);
+
+    if (dense && A.dense && B.dense)
+    {
+        dense->mult(alpha, conja, *A.dense, idx_A,
+                           conjb, *B.dense, idx_B,
+                     beta,                  idx_C);
+        return;
+    }
+
+    unique_ptr<CTFTensor<T>> tmp_A, tmp_B;
+    const CTFTensor<T>& A_ = conjugated(conja, A, tmp_A);
+    const CTFTensor<T>& B_ = conjugated(conjb, B, tmp_B);
+
+    unique_ptr<tCTF_Tensor<T>> ctf_A, ctf_B, ctf_C;
+    ctfData(ctf_C)[idx_C.c_str()]*beta += alpha*A_.ctfData(ctf_A)[idx_A.c_str()]*
+                                                B_.ctfData(ctf_B)[idx_B.c_str()];
+    writeBack(ctf_C);
 /*    dt->contract(alpha, *A.dt, idx_A.c_str(),
                         *B.dt, idx_B.c_str(),
                   beta,        idx_C.c_str());*/
@@ -444,23 +974,128 @@ void CTFTensor<T>::mult(T alpha, bool conja, const CTFTensor<T>& A, const string
 template <typename T>
 void CTFTensor<T>::sum(T alpha, T beta)
 {
+    Resident r(*this);
+
+    if (dense)
+    {
+        dense->sum(alpha, beta);
+        return;
+    }
+
     CTFTensor<T>& s = scalar();
     if (arena.rank == 0) s.writeRemoteData(vector<tkv_pair<T>>(1, tkv_pair<T>(0, alpha)));
     else s.writeRemoteData();
     beta*(*this) += s;
 }
 
+template <typename T>
+void CTFTensor<T>::stack(const vector<const CTFTensor<T>*>& parts, CTFTensor<T>& stacked)
+{
+    const vector<int>& len = parts[0]->len;
+    int64_t size = 1;
+    for (int l : len) size *= l;
+
+    vector<tkv_pair<T>> all, pairs;
+    for (int k = 0;k < parts.size();k++)
+    {
+        assert(parts[k]->len == len && parts[k]->sym == parts[0]->sym);
+        parts[k]->getLocalData(pairs);
+        for (auto& p : pairs) all.push_back(tkv_pair<T>(p.k+k*size, p.d));
+    }
+
+    stacked.writeRemoteData(all);
+}
+
+template <typename T>
+void CTFTensor<T>::unstack(const CTFTensor<T>& stacked, const vector<CTFTensor<T>*>& parts)
+{
+    const vector<int>& len = parts[0]->len;
+    int64_t size = 1;
+    for (int l : len) size *= l;
+
+    vector<tkv_pair<T>> pairs;
+    stacked.getLocalData(pairs);
+
+    vector<vector<tkv_pair<T>>> split(parts.size());
+    for (auto& p : pairs) split[p.k/size].push_back(tkv_pair<T>(p.k%size, p.d));
+
+    for (int k = 0;k < parts.size();k++)
+    {
+        assert(parts[k]->len == len && parts[k]->sym == parts[0]->sym);
+        parts[k]->writeRemoteData(split[k]);
+    }
+}
+
+template <typename T>
+void CTFTensor<T>::multMany(T alpha, bool conja, const CTFTensor<T>& A, const string& idx_A,
+                                     bool conjb, const vector<const CTFTensor<T>*>& B, const string& idx_B,
+                            T  beta,                                             const vector<CTFTensor<T>*>& C,
+                                                                                 const string& idx_C)
+{
+    assert(B.size() == C.size());
+
+    if (C.size() <= 1)
+    {
+        if (!C.empty()) C[0]->mult(alpha, conja, A, idx_A, conjb, *B[0], idx_B, beta, idx_C);
+        return;
+    }
+
+    /*
+     * The stacked index takes a letter which is not used otherwise
+     */
+    char k = 'A';
+    while (contains(idx_A, k) || contains(idx_B, k) || contains(idx_C, k)) k++;
+
+    int n = C.size();
+    vector<int> len_B(B[0]->len), sym_B(B[0]->sym);
+    vector<int> len_C(C[0]->len), sym_C(C[0]->sym);
+    len_B.push_back(n);
+    sym_B.push_back(NS);
+    len_C.push_back(n);
+    sym_C.push_back(NS);
+
+    CTFTensor<T> Bs(B[0]->name, B[0]->arena, len_B.size(), len_B, sym_B, true);
+    CTFTensor<T> Cs(C[0]->name, C[0]->arena, len_C.size(), len_C, sym_C, true);
+
+    stack(B, Bs);
+    if (beta != (T)0) stack(vector<const CTFTensor<T>*>(C.begin(), C.end()), Cs);
+
+    Cs.mult(alpha, conja, A, idx_A, conjb, Bs, idx_B+k, beta, idx_C+k);
+
+    unstack(Cs, C);
+}
+
 template <typename T>
 void CTFTensor<T>::sum(T alpha, bool conja, const CTFTensor<T>& A, const string& idx_A,
                         T  beta,                                     const string& idx_B)
 {
-    (*this->dt)[idx_B.c_str()]*beta += alpha*(*A.dt)[idx_A.c_str()];
+    #ifdef PROFILE
+    time::LedgerScope ledger("sum", {this->name, A.name}, {idx_B, idx_A},
+                             {len, A.len}, {sym, A.sym});
+    #endif
+
+    Resident r(*this), r_A(A);
+
+    if (dense && A.dense)
+    {
+        dense->sum(alpha, conja, *A.dense, idx_A, beta, idx_B);
+        return;
+    }
+
+    unique_ptr<CTFTensor<T>> tmp_A;
+    const CTFTensor<T>& A_ = conjugated(conja, A, tmp_A);
+
+    unique_ptr<tCTF_Tensor<T>> ctf_A, ctf_B;
+    ctfData(ctf_B)[idx_B.c_str()]*beta += alpha*A_.ctfData(ctf_A)[idx_A.c_str()];
+    writeBack(ctf_B);
 }
 
 template <typename T>
 void CTFTensor<T>::scale(T alpha, const string& idx_A)
 {
-    (*this->dt)[idx_A.c_str()] = alpha*(*this->dt)[idx_A.c_str()];
+    Resident r(*this);
+    if (dense) dense->scale(alpha, idx_A);
+    else (*this->dt)[idx_A.c_str()] = alpha*(*this->dt)[idx_A.c_str()];
 }
 
 template <typename T>
@@ -477,43 +1112,521 @@ T CTFTensor<T>::dot(bool conja, const CTFTensor<T>& A, const string& idx_A,
     return val[0];
 }
 
+/*
+ * The local elements of A (aligned to this tensor) and of this tensor are
+ * read in the same order, and the sum over the packed elements is scaled by
+ * the number of elements each represents. This is not a constant for
+ * symmetric (SY) indices, in which case the full contraction is done and
+ * the result counted on only one process.
+ */
+template <typename T>
+void CTFTensor<T>::localDots(bool conja, const vector<const CTFTensor<T>*>& A, bool conjb,
+                             vector<T>& scalars) const
+{
+    Resident r(*this);
+
+    if (dense)
+    {
+        for (int k = 0;k < A.size();k++)
+        {
+            Resident r_A(*A[k]);
+
+            if (A[k]->dense)
+            {
+                vector<T> s(1, (T)0);
+                dense->localDots(conja, {A[k]->dense}, conjb, s);
+                scalars[k] += s[0];
+            }
+            else
+            {
+                scalars[k] += dot(conja, *A[k], this->implicit(), conjb, this->implicit());
+            }
+        }
+        return;
+    }
+
+    double factor = 1;
+    bool exact = true;
+    for (int i = 0;i < this->ndim;)
+    {
+        int j; for (j = i;sym[j] != NS;j++) if (sym[j] == SY) exact = false;
+        factor *= factorial(j-i+1);
+        i = j+1;
+    }
+
+    vector<tkv_pair<T>> pairs, pairs_A;
+    if (exact) getLocalData(pairs);
+
+    for (int k = 0;k < A.size();k++)
+    {
+        Resident r_A(*A[k]);
+
+        if (!exact || A[k]->len != len || A[k]->sym != sym)
+        {
+            T val = dot(conja, *A[k], this->implicit(), conjb, this->implicit());
+            if (this->arena.rank == 0) scalars[k] += val;
+            continue;
+        }
+
+        const_cast<tCTF_Tensor<T>*>(A[k]->dt)->align(*dt);
+        A[k]->getLocalData(pairs_A);
+        assert(pairs_A.size() == pairs.size());
+
+        T s = 0;
+        for (int64_t i = 0;i < pairs.size();i++)
+        {
+            assert(pairs_A[i].k == pairs[i].k);
+            s += (conja ? conj(pairs_A[i].d) : pairs_A[i].d)*
+                 (conjb ? conj(pairs  [i].d) : pairs  [i].d);
+        }
+
+        scalars[k] += (T)factor*s;
+    }
+}
+
 template <typename T>
 void CTFTensor<T>::weight(const vector<const vector<T>*>& d, double shift)
+{
+    weight(d, shift, NULL);
+}
+
+template <typename T>
+void CTFTensor<T>::weightAndAdd(const vector<const vector<T>*>& d, CTFTensor<T>& B, double shift)
+{
+    assert(len == B.len && sym == B.sym);
+    Resident r_B(B);
+    weight(d, shift, &B);
+}
+
+template <typename T>
+void CTFTensor<T>::weight(const vector<const vector<T>*>& d, double shift, CTFTensor<T>* sum)
 {
     if (this->ndim == 0) return;
 
     assert(d.size() == this->ndim);
     for (int i = 0;i < d.size();i++) assert(d[i]->size() == len[i]);
 
-    vector<tkv_pair<T>> pairs;
-    getLocalData(pairs);
+    Resident r(*this);
+
+    if (dense)
+    {
+        if (sum) dense->weightAndAdd(d, *sum->dense, shift);
+        else dense->weight(d, shift);
+        return;
+    }
+
+    /*
+     * The residual is redistributed to match the sum rather than the other
+     * way around, so that the sum can be updated in place on the same local
+     * buffer
+     */
+    if (sum)
+    {
+        assert(!sum->dense);
+        dt->align(*sum->dt);
+    }
+
+    int64_t size, size_sum;
+    T* restrict raw_data = getRawData(size);
+
+    vector<LocalRow> rows;
+    localRows(rows);
+
+    T* restrict raw_data_sum = NULL;
+    if (sum)
+    {
+        raw_data_sum = sum->getRawData(size_sum);
+        assert(size == size_sum);
+    }
+
+    /*
+     * As for the dense backend, the denominators of all but the first index
+     * are added once per row and the rest in a vectorized inner loop
+     */
+    const T* d0 = d[0]->data();
+    int64_t nrow = rows.size();
 
-    for (int i = 0;i < pairs.size();i++)
+    #pragma omp parallel for
+    for (int64_t r = 0;r < nrow;r++)
     {
-        int64_t k = pairs[i].k;
+        const LocalRow& row = rows[r];
 
-        T den = 0;
-        for (int j = 0;j < this->ndim;j++)
+        T base = (T)shift;
+        int64_t k = row.key/len[0];
+        for (int j = 1;j < this->ndim;j++)
         {
-            int o = k%len[j];
-            k = k/len[j];
-            den += (*d[j])[o];
+            base += (*d[j])[k%len[j]];
+            k /= len[j];
         }
 
-        if (aquarius::abs(den+shift) < 1e-4)
+        const T* restrict d0_row = d0+row.key%len[0];
+        T* restrict data_row = raw_data+row.pos;
+        int n = row.n, stride = row.stride;
+
+        #pragma omp simd
+        for (int i = 0;i < n;i++)
         {
-            pairs[i].d = 0;
+            T den = base+d0_row[i*stride];
+            data_row[i] = (aquarius::abs(den) < 1e-4 ? (T)0 : data_row[i]/den);
         }
-        else
+
+        if (raw_data_sum)
+        {
+            T* restrict sum_row = raw_data_sum+row.pos;
+
+            #pragma omp simd
+            for (int i = 0;i < n;i++) sum_row[i] += data_row[i];
+        }
+    }
+}
+
+/*
+ * CTF does not expose the layout of its local buffer, so it is read off a
+ * copy of the tensor (which has the same distribution) whose buffer holds
+ * the position of each element. This is purely local. Positions are
+ * written in pieces small enough to be exact in the element type.
+ */
+template <typename T>
+void CTFTensor<T>::localRows(vector<LocalRow>& rows) const
+{
+    rows.clear();
+
+    int64_t size;
+    dt->get_raw_data(&size);
+    if (size == 0) return;
+
+    int bits = min(numeric_limits<real_type_t<T>>::digits-1, 30);
+    int64_t mask = (1l<<bits)-1;
+
+    vector<pair<int64_t,int64_t>> pos;
+
+    for (int shift = 0;shift == 0 || (size-1)>>shift > 0;shift += bits)
+    {
+        unique_ptr<tCTF_Tensor<T>> probe(new tCTF_Tensor<T>(*dt, true));
+
+        long_int size_;
+        T* raw_data = probe->get_raw_data(&size_);
+        assert(size_ == size);
+
+        #pragma omp parallel for
+        for (int64_t i = 0;i < size;i++) raw_data[i] = (T)(double)((i>>shift)&mask);
+
+        int64_t npair;
+        tkv_pair<T> *data;
+        probe->read_local(&npair, &data);
+
+        if (shift == 0) pos.resize(npair, make_pair(0, 0));
+        assert(pos.size() == npair);
+
+        for (int64_t i = 0;i < npair;i++)
+        {
+            pos[i].first += ((int64_t)std::real(data[i].d))<<shift;
+            pos[i].second = data[i].k;
+        }
+
+        if (npair > 0) ::free(data);
+    }
+
+    sort(pos.begin(), pos.end());
+
+    int64_t npos = pos.size();
+    for (int64_t i = 0;i < npos;)
+    {
+        int64_t p = pos[i].first, key = pos[i].second;
+
+        int n = 1, stride = 0;
+        if (i+1 < npos && pos[i+1].first == p+1 &&
+            pos[i+1].second > key && pos[i+1].second/len[0] == key/len[0])
+        {
+            stride = pos[i+1].second-key;
+
+            while (i+n < npos && pos[i+n].first == p+n &&
+                   pos[i+n].second == key+n*stride &&
+                   pos[i+n].second/len[0] == key/len[0]) n++;
+        }
+
+        rows.push_back(LocalRow{p, key, n, stride});
+        i += n;
+    }
+}
+
+template <typename T>
+void CTFTensor<T>::getPackedKeys(vector<int64_t>& keys) const
+{
+    keys.clear();
+
+    for (int i = 0;i < this->ndim;i++)
+    {
+        if (len[i] == 0) return;
+    }
+
+    vector<int> idx(this->ndim, 0);
+
+    first_packed_indices(this->ndim, len.data(), sym.data(), idx.data());
+
+    do
+    {
+        int64_t key = 0, stride = 1;
+        for (int i = 0;i < this->ndim;i++)
+        {
+            key += idx[i]*stride;
+            stride *= len[i];
+        }
+        keys.push_back(key);
+    }
+    while (next_packed_indices(this->ndim, len.data(), sym.data(), idx.data()));
+
+    sort(keys.begin(), keys.end());
+}
+
+/*
+ * Keys are offset by the total (unpacked) size of the preceding tensors so
+ * that all of the elements can be gathered and sorted together
+ */
+template <typename T>
+void CTFTensor<T>::getAllData(const vector<const CTFTensor<T>*>& A, vector<vector<T>>& vals)
+{
+    vals.clear();
+    vals.resize(A.size());
+    if (A.empty()) return;
+
+    const Arena& arena = A[0]->arena;
+
+    vector<int64_t> offset(A.size()+1, 0);
+    vector<tkv_pair<T>> local, pairs;
+    for (int i = 0;i < A.size();i++)
+    {
+        assert(&A[i]->arena.comm() == &arena.comm());
+
+        int64_t size = 1;
+        for (int j = 0;j < A[i]->ndim;j++) size *= A[i]->len[j];
+        offset[i+1] = offset[i]+size;
+
+        A[i]->getLocalData(pairs);
+        for (auto& p : pairs) p.k += offset[i];
+        local.insert(local.end(), pairs.begin(), pairs.end());
+    }
+
+    vector<MPI_Int> counts(arena.size);
+    MPI_Int count = local.size();
+    arena.comm().Allgather(&count, counts.data(), 1);
+
+    vector<MPI_Int> displs(arena.size, 0);
+    for (int i = 1;i < arena.size;i++) displs[i] = displs[i-1]+counts[i-1];
+
+    Datatype PAIR_TYPE = MPI_TYPE_<char>::value()*sizeof(tkv_pair<T>);
+    pairs.resize(displs.back()+counts.back());
+    arena.comm().Allgather(local.data(), count, pairs.data(), counts.data(), displs.data(), PAIR_TYPE);
+
+    sort(pairs.begin(), pairs.end());
+
+    int i = 0;
+    for (auto& p : pairs)
+    {
+        while (p.k >= offset[i+1]) i++;
+        vals[i].push_back(p.d);
+    }
+}
+
+template <typename T>
+void CTFTensor<T>::sumAllData(const vector<CTFTensor<T>*>& A, const vector<vector<T>>& vals)
+{
+    assert(A.size() == vals.size());
+    if (A.empty()) return;
+
+    const Arena& arena = A[0]->arena;
+
+    vector<vector<int64_t>> keys(A.size());
+    vector<T> all;
+    for (int i = 0;i < A.size();i++)
+    {
+        assert(&A[i]->arena.comm() == &arena.comm());
+
+        A[i]->getPackedKeys(keys[i]);
+        assert(keys[i].size() == vals[i].size());
+        all.insert(all.end(), vals[i].begin(), vals[i].end());
+    }
+
+    int64_t total = all.size();
+    vector<MPI_Int> counts(arena.size);
+    for (int r = 0;r < arena.size;r++)
+    {
+        counts[r] = (total*(r+1))/arena.size - (total*r)/arena.size;
+    }
+
+    int64_t start = (total*arena.rank)/arena.size;
+    vector<T> mine(counts[arena.rank]);
+    arena.comm().Reduce_scatter(all.data(), mine.data(), counts.data(), MPI_SUM);
+
+    /*
+     * Every process must take part in the write to each tensor, even if it
+     * has no elements of that tensor to write
+     */
+    int64_t first = 0;
+    for (int i = 0;i < A.size();i++)
+    {
+        int64_t n = keys[i].size();
+        int64_t begin = max(start, first);
+        int64_t end = min(start+(int64_t)mine.size(), first+n);
+
+        vector<tkv_pair<T>> pairs;
+        for (int64_t j = begin;j < end;j++)
         {
-            pairs[i].d /= (den+shift);
+            pairs.push_back(tkv_pair<T>(keys[i][j-first], mine[j-start]));
         }
+
+        A[i]->writeRemoteData(pairs);
+
+        first += n;
+    }
+}
+
+/*
+ * File layout: ndim, len[ndim], sym[ndim], npair, then npair key-value pairs
+ */
+template <typename T>
+void CTFTensor<T>::save(const string& file) const
+{
+    vector<tkv_pair<T>> pairs;
+    getLocalData(pairs);
+
+    int64_t npair = pairs.size();
+    vector<int64_t> npairs(this->arena.size);
+    this->arena.comm().Allgather(&npair, npairs.data(), 1);
+
+    int64_t total = 0, offset = 0;
+    for (int i = 0;i < this->arena.size;i++)
+    {
+        if (i < this->arena.rank) offset += npairs[i];
+        total += npairs[i];
+    }
+
+    vector<int64_t> header;
+    header.push_back(this->ndim);
+    header.insert(header.end(), len.begin(), len.end());
+    header.insert(header.end(), sym.begin(), sym.end());
+    header.push_back(total);
+
+    MPI_File fh;
+    if (MPI_File_open(const_cast<MPI_Comm&>((const MPI_Comm&)this->arena.comm()),
+                      const_cast<char*>(file.c_str()),
+                      MPI_MODE_CREATE|MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        throw runtime_error("Could not open " + file + " for writing");
+
+    MPI_File_set_size(fh, 0);
+
+    if (this->arena.rank == 0)
+    {
+        MPI_File_write_at(fh, 0, header.data(), header.size()*sizeof(int64_t),
+                          MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    /*
+     * Write in chunks to keep the byte counts within the range of an int
+     */
+    const int64_t chunk = (1<<30)/sizeof(tkv_pair<T>);
+    MPI_Offset disp = header.size()*sizeof(int64_t) + offset*sizeof(tkv_pair<T>);
+    for (int64_t i = 0;i < npair;i += chunk)
+    {
+        int64_t n = min(chunk, npair-i);
+        MPI_File_write_at(fh, disp + i*sizeof(tkv_pair<T>), pairs.data()+i,
+                          n*sizeof(tkv_pair<T>), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    MPI_File_close(&fh);
+}
+
+template <typename T>
+bool CTFTensor<T>::load(const string& file)
+{
+    MPI_File fh;
+    if (MPI_File_open(const_cast<MPI_Comm&>((const MPI_Comm&)this->arena.comm()),
+                      const_cast<char*>(file.c_str()),
+                      MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        return false;
+
+    vector<int64_t> header(2*this->ndim+2, -1);
+    MPI_File_read_at_all(fh, 0, header.data(), header.size()*sizeof(int64_t),
+                         MPI_BYTE, MPI_STATUS_IGNORE);
+
+    bool match = header[0] == this->ndim;
+    for (int i = 0;match && i < this->ndim;i++)
+    {
+        match = header[1+i] == len[i] && header[1+this->ndim+i] == sym[i];
     }
 
+    if (!match)
+    {
+        MPI_File_close(&fh);
+        return false;
+    }
+
+    /*
+     * Read an even share of the pairs regardless of how they were written
+     */
+    int64_t total = header.back();
+    int64_t begin = (total*this->arena.rank)/this->arena.size;
+    int64_t end = (total*(this->arena.rank+1))/this->arena.size;
+
+    vector<tkv_pair<T>> pairs(end-begin);
+
+    const int64_t chunk = (1<<30)/sizeof(tkv_pair<T>);
+    MPI_Offset disp = header.size()*sizeof(int64_t) + begin*sizeof(tkv_pair<T>);
+    for (int64_t i = 0;i < end-begin;i += chunk)
+    {
+        int64_t n = min(chunk, end-begin-i);
+        MPI_File_read_at(fh, disp + i*sizeof(tkv_pair<T>), pairs.data()+i,
+                         n*sizeof(tkv_pair<T>), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    MPI_File_close(&fh);
+
+    writeRemoteData(pairs);
+
+    return true;
+}
+
+template <typename T>
+void CTFTensor<T>::copyTo(CTFTensor<T>* other) const
+{
+    vector<tkv_pair<T>> pairs;
+    if (other) other->getLocalData(pairs);
+    getRemoteData(pairs);
+    if (other) other->writeRemoteData(pairs);
+}
+
+template <typename T>
+void CTFTensor<T>::copyFrom(const CTFTensor<T>* other)
+{
+    vector<tkv_pair<T>> pairs;
+    if (other) other->getLocalData(pairs);
     writeRemoteData(pairs);
 }
 
-INSTANTIATE_SPECIALIZATIONS(CTFTensor);
+INSTANTIATE_ALL_SPECIALIZATIONS(CTFTensor);
+
+void printPoolStatistics(const Arena& arena)
+{
+    vector<PoolStatistics> stats = {CTFTensor<float>::getPoolStatistics(),
+                                    CTFTensor<double>::getPoolStatistics(),
+                                    CTFTensor<complex<double>>::getPoolStatistics()};
+    vector<string> types = {"float", "double", "complex"};
+
+    task::Logger::log(arena) << printos("%-8s %12s %12s %12s %12s\n", "pool",
+                                        "hits", "misses", "evictions", "peak (MB)") << endl;
+
+    for (int i = 0;i < stats.size();i++)
+    {
+        int64_t peak = stats[i].peak;
+        arena.comm().Allreduce(&peak, 1, MPI_MAX);
+
+        if (stats[i].hits == 0 && stats[i].misses == 0) continue;
+
+        task::Logger::log(arena) << printos("%-8s %12ld %12ld %12ld %12.1f\n", types[i].c_str(),
+                                            stats[i].hits, stats[i].misses, stats[i].evictions,
+                                            peak/1048576.0) << endl;
+    }
+}
 
 }
 }
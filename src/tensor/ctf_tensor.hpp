@@ -6,19 +6,129 @@
 #include "task/task.hpp"
 
 #include "indexable_tensor.hpp"
+#include "dense_tensor.hpp"
 
 namespace aquarius
 {
 namespace tensor
 {
 
+/*
+ * Settings for tensors kept on disk, from the "ooc" section of the input:
+ * the directory (on node-local disk) for their files
+ */
+struct OutOfCore
+{
+    static string& directory()
+    {
+        static string dir = (getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+        return dir;
+    }
+};
+
+struct PoolStatistics
+{
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    int64_t bytes = 0;
+    int64_t peak = 0;
+};
+
 template <typename T>
 class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 {
     INHERIT_FROM_INDEXABLE_TENSOR(CTFTensor<T>,T)
 
     protected:
-        tCTF_Tensor<T>* dt;
+        /*
+         * Exactly one of dt and dense is used: tensors on single-process
+         * arenas whose unpacked size is at most denseLimit are stored
+         * densely and bypass CTF, and all others are packed by CTF. Both are
+         * NULL while an out-of-core tensor is not in use.
+         */
+        mutable tCTF_Tensor<T>* dt;
+        mutable DenseTensor<T>* dense;
+
+        /*
+         * Copies share the storage of the original (copy-on-write), in
+         * which case all of the sharing tensors hold the same owner. The
+         * storage is duplicated when one of them is about to be modified
+         * and only freed by the last one.
+         */
+        mutable shared_ptr<char> owner;
+
+        /*
+         * On disk, each process writes the key-value pairs that it stores to
+         * its own file, and reads them back when the tensor is next used. In
+         * single precision, the elements are kept in a single-precision copy
+         * of the tensor.
+         */
+        struct OutOfCoreState
+        {
+            Storage storage;
+            string file;
+            unique_ptr<CTFTensor<float>> single;
+            int pins = 0;
+            bool dirty = true;
+        };
+        mutable unique_ptr<OutOfCoreState> ooc;
+
+        /*
+         * Freed storage is kept in a pool and handed to the next tensor of
+         * the same shape on the same arena, which saves both the allocation
+         * and CTF's mapping of the tensor. Every process of an arena sees the
+         * same sequence of allocations on it, so the pool (and the limit on
+         * it) is kept separately for each arena to keep the processes in
+         * step.
+         */
+        struct PoolEntry
+        {
+            Arena arena;
+            vector<int> len;
+            vector<int> sym;
+            tCTF_Tensor<T>* dt;
+            DenseTensor<T>* dense;
+            int64_t bytes;
+        };
+        static list<PoolEntry> pool;
+        static PoolStatistics poolStats;
+        static int64_t poolLimit;
+
+        /*
+         * Guard the pool (with its statistics), the scalars, and the owners
+         * of shared storage, so that different tensors may be operated on
+         * by several threads at once (see SymmetryBlockedTensor::setConcurrent)
+         */
+        static mutex& poolMutex();
+
+        static recursive_mutex& scalarsMutex();
+
+        static mutex& ownerMutex();
+
+        /*
+         * Free the storage freed longest ago on the given arena until at most
+         * limit bytes are pooled for it. Only used while holding poolMutex().
+         */
+        static void evict(const Arena& arena, int64_t limit);
+
+        /*
+         * Since only the shape decides, tensors of the same shape are always
+         * stored the same way. Operations which mix the two go through CTF,
+         * with temporary CTF copies of the (small) dense operands.
+         */
+        static int64_t denseLimit;
+
+        static bool sameArena(const Arena& a, const Arena& b)
+        {
+            return (a.size == 1 && b.size == 1) || &a.comm() == &b.comm();
+        }
+
+        /*
+         * The memory taken on each process, assuming an even distribution
+         */
+        int64_t localBytes() const;
+
         vector<int> len;
         vector<int> sym;
         static map<const tCTF_World<T>*,pair<int,CTFTensor<T>*>> scalars;
@@ -27,12 +137,87 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 
         void free();
 
+        /*
+         * The CTF tensor holding this tensor's data, which for a dense tensor
+         * is a temporary copy kept alive by tmp
+         */
+        tCTF_Tensor<T>& ctfData(unique_ptr<tCTF_Tensor<T>>& tmp) const;
+
+        /*
+         * Copy the result of an operation on a temporary from ctfData back
+         * into the dense storage, if there was one
+         */
+        void writeBack(const unique_ptr<tCTF_Tensor<T>>& tmp);
+
+        /*
+         * Copy tensors of the same shape into (or out of) consecutive slices
+         * of stacked, which has one more (last) index running over them
+         */
+        static void stack(const vector<const CTFTensor<T>*>& parts, CTFTensor<T>& stacked);
+
+        static void unstack(const CTFTensor<T>& stacked, const vector<CTFTensor<T>*>& parts);
+
+        void set(T val);
+
         void register_scalar();
 
         void unregister_scalar();
 
+        static vector<tkv_pair<T>> readPages(const string& file);
+
+        void pageIn() const;
+
+        void pageOut() const;
+
+        /*
+         * Take on the storage of A, which is not out of core
+         */
+        void share(const CTFTensor<T>& A);
+
+        /*
+         * Give this tensor its own copy of shared storage
+         */
+        void unshare();
+
+        bool isShared() const { return owner.use_count() > 1; }
+
+        void pin(bool modify) const;
+
+        void unpin() const;
+
         CTFTensor<T>& scalar() const;
 
+        /*
+         * A run of consecutive elements of the local CTF buffer, starting at
+         * pos, whose keys are key, key+stride, ... and which differ only in
+         * the first index
+         */
+        struct LocalRow
+        {
+            int64_t pos;
+            int64_t key;
+            int n, stride;
+        };
+
+        /*
+         * Map the local buffer of the CTF tensor onto rows of elements, the
+         * offset tables which the weighting kernel works from
+         */
+        void localRows(vector<LocalRow>& rows) const;
+
+        /*
+         * Divide each element by d[0][i]+d[1][j]+...+shift, and add the
+         * result to sum if it is not NULL
+         */
+        void weight(const vector<const vector<T>*>& d, double shift, CTFTensor<T>* sum);
+
+        /*
+         * CTF does not conjugate operands itself, so return a conjugated
+         * copy of A (kept alive by tmp) if conj is set and T is complex
+         */
+        static const CTFTensor<T>& conjugated(bool conj, const CTFTensor<T>& A,
+                                              unique_ptr<CTFTensor<T>>& tmp);
+
         static void first_packed_indices(int ndim, const int* len, const int* sym, int* idx)
         {
             int i;
@@ -126,12 +311,81 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 
         ~CTFTensor();
 
+        /*
+         * Keeps an out-of-core tensor in memory for as long as the object
+         * lives, after which it is written back to disk or to single
+         * precision (only if it was given a non-const tensor) and freed.
+         * Each operation does this for the tensors it uses, so that a
+         * tensor is only in memory for the duration of an operation unless
+         * an enclosing Resident holds it.
+         * A non-const tensor is also unshared from any copies.
+         */
+        class Resident
+        {
+            protected:
+                const CTFTensor<T>& tensor;
+
+            public:
+                Resident(const CTFTensor<T>& tensor) : tensor(tensor) { tensor.pin(false); }
+
+                Resident(CTFTensor<T>& tensor) : tensor(tensor) { tensor.pin(true); }
+
+                Resident(const Resident&) = delete;
+
+                Resident& operator=(const Resident&) = delete;
+
+                ~Resident() { tensor.unpin(); }
+        };
+
+        /*
+         * Keep the elements on disk (in OutOfCore::directory()) or in single
+         * precision whenever the tensor is not in use. Tensors which are
+         * already single precision, and complex tensors (for which there is
+         * no single-precision CTF world), are kept in core instead of in
+         * single precision.
+         */
+        void setStorage(Storage storage);
+
+        Storage getStorage() const { return (ooc ? ooc->storage : IN_CORE); }
+
+        /*
+         * True if the tensor is stored densely and in core, so that
+         * operations on it bypass both CTF and the paging. Only such tensors
+         * may be operated on by several threads at once.
+         */
+        bool isDense() const { return dense && getStorage() == IN_CORE; }
+
+        /*
+         * Limit the memory held in the pool by each process for each arena.
+         * A limit of zero (the default until a TaskDAG sets it) disables the
+         * pool.
+         */
+        static void setPoolLimit(int64_t bytes);
+
+        /*
+         * Set the largest unpacked size of a tensor stored densely on a
+         * single-process arena. A limit of zero stores all tensors with CTF.
+         */
+        static void setDenseLimit(int64_t bytes);
+
+        static const PoolStatistics& getPoolStatistics() { return poolStats; }
+
+        /*
+         * Free all of the pooled storage, which must be done before the CTF
+         * worlds are torn down
+         */
+        static void clearPool();
+
         void resize(int ndim, const vector<int>& len, const vector<int>& sym, bool zero);
 
         const vector<int>& getLengths() const { return len; }
 
         const vector<int>& getSymmetry() const { return sym; }
 
+        /*
+         * The data of an out-of-core tensor stays in memory until it is next
+         * written back by the release of a Resident
+         */
         T* getRawData(int64_t& size);
 
         const T* getRawData(int64_t& size) const;
@@ -139,6 +393,14 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
         template <typename Container>
         void getLocalData(Container& pairs) const
         {
+            Resident r(*this);
+
+            if (dense)
+            {
+                dense->getLocalData(pairs);
+                return;
+            }
+
             int64_t npair;
             tkv_pair<T> *data;
             dt->read_local(&npair, &data);
@@ -149,52 +411,60 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
         template <typename Container>
         void getRemoteData(Container& pairs) const
         {
-            dt->read(pairs.size(), pairs.data());
+            Resident r(*this);
+            if (dense) dense->getRemoteData(pairs);
+            else dt->read(pairs.size(), pairs.data());
         }
 
         void getRemoteData() const
         {
-            dt->read(0, NULL);
+            Resident r(*this);
+            if (!dense) dt->read(0, NULL);
         }
 
         template <typename Container>
         void writeRemoteData(const Container& pairs)
         {
-            dt->write(pairs.size(), pairs.data());
+            Resident r(*this);
+            if (dense) dense->writeRemoteData(pairs);
+            else dt->write(pairs.size(), pairs.data());
         }
 
         void writeRemoteData()
         {
-            dt->write(0, NULL);
+            Resident r(*this);
+            if (!dense) dt->write(0, NULL);
         }
 
         template <typename Container>
         void writeRemoteData(double alpha, double beta, const Container& pairs)
         {
-            dt->write(pairs.size(), alpha, beta, pairs.data());
+            Resident r(*this);
+            if (dense) dense->writeRemoteData(alpha, beta, pairs);
+            else dt->write(pairs.size(), alpha, beta, pairs.data());
         }
 
         void writeRemoteData(double alpha, double beta)
         {
-            dt->write(0, alpha, beta, NULL);
+            Resident r(*this);
+            if (!dense) dt->write(0, alpha, beta, NULL);
         }
 
+        /*
+         * The keys of all of the packed elements, in increasing order
+         */
+        void getPackedKeys(vector<int64_t>& keys) const;
+
+        /*
+         * Every process receives all of the packed elements, in order of
+         * increasing key (see getAllData(A, vals))
+         */
         template <typename Container>
         void getAllData(Container& vals) const
         {
-            int64_t npair;
-            if (this->arena.rank == 0)
-            {
-                getAllData(vals, 0);
-                npair = vals.size();
-            }
-            else
-            {
-                getAllData(0);
-            }
-            this->arena.comm().Bcast(&npair, 1, 0);
-            if (this->arena.rank != 0) vals.resize(npair);
-            this->arena.comm().Bcast(vals, 0);
+            vector<vector<T>> all;
+            getAllData(vector<const CTFTensor<T>*>{this}, all);
+            vals.assign(all[0].begin(), all[0].end());
         }
 
         template <typename Container>
@@ -202,35 +472,15 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
         {
             assert(this->arena.rank == rank);
 
-            for (int i = 0;i < ndim;i++)
-            {
-                if (len[i] == 0)
-                {
-                    vals.clear();
-                    return;
-                }
-            }
+            vector<int64_t> keys;
+            getPackedKeys(keys);
 
             vector<tkv_pair<T>> pairs;
-            vector<int> idx(ndim, 0);
+            pairs.reserve(keys.size());
+            for (int64_t key : keys) pairs.push_back(tkv_pair<T>(key, (T)0));
 
-            first_packed_indices(ndim, len.data(), sym.data(), idx.data());
+            getRemoteData(pairs);
 
-            do
-            {
-                int64_t key = 0, stride = 1;
-                for (int i = 0;i < ndim;i++)
-                {
-                    key += idx[i]*stride;
-                    stride *= len[i];
-                }
-                pairs.push_back(tkv_pair<T>(key, (T)0));
-            }
-            while (next_packed_indices(ndim, len.data(), sym.data(), idx.data()));
-
-            dt->read(pairs.size(), pairs.data());
-
-            sort(pairs.begin(), pairs.end());
             size_t npair = pairs.size();
             vals.resize(npair);
 
@@ -243,9 +493,26 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
         void getAllData(int rank) const
         {
             assert(this->arena.rank != rank);
-            dt->read(0, NULL);
+            getRemoteData();
         }
 
+        /*
+         * Every process receives all of the packed elements of each of the
+         * tensors in A, which must share an arena. Each process contributes
+         * only the elements that it stores, and there is a single collective
+         * for all of the tensors rather than a gather to and broadcast from
+         * one process.
+         */
+        static void getAllData(const vector<const CTFTensor<T>*>& A, vector<vector<T>>& vals);
+
+        /*
+         * Sum vals, which hold the packed elements of each of the tensors in
+         * A, over all processes and write the result. The sum is
+         * reduce-scattered, so that each process writes an equal share of the
+         * elements.
+         */
+        static void sumAllData(const vector<CTFTensor<T>*>& A, const vector<vector<T>>& vals);
+
         void slice(T alpha, bool conja, const CTFTensor<T>& A,
                    const vector<int>& start_A, T beta);
 
@@ -263,6 +530,59 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 
         void weight(const vector<const vector<T>*>& d, double shift = 0);
 
+        /*
+         * Weight this tensor and add the result to B in the same pass
+         */
+        void weightAndAdd(const vector<const vector<T>*>& d, CTFTensor<T>& B, double shift = 0);
+
+        /*
+         * Write the tensor to a file with MPI-IO. Each process writes its
+         * local key-value pairs so that the file may be read back on any
+         * number of processes.
+         */
+        void save(const string& file) const;
+
+        /*
+         * Read a tensor written by save. Returns false if the file does not
+         * exist or holds a tensor of a different shape.
+         */
+        bool load(const string& file);
+
+        /*
+         * Copy this tensor into other, which may live on a different (smaller)
+         * arena. Collective over this tensor's arena; processes which do not
+         * belong to other's arena pass NULL. Disjoint groups of processes may
+         * pass different tensors, each on the group's own arena, to make
+         * several copies while reading this tensor only once.
+         */
+        void copyTo(CTFTensor<T>* other) const;
+
+        /*
+         * The reverse of copyTo: overwrite this tensor with the contents of
+         * other, where processes outside of other's arena pass NULL.
+         */
+        void copyFrom(const CTFTensor<T>* other);
+
+        /*
+         * Overwrite this tensor with the elements of a tensor of the same
+         * shape but a different precision
+         */
+        template <typename U>
+        void convert(const CTFTensor<U>& other)
+        {
+            Resident r(*this);
+
+            vector<tkv_pair<T>> pairs;
+            getLocalData(pairs);
+
+            vector<tkv_pair<U>> other_pairs(pairs.size());
+            for (size_t i = 0;i < pairs.size();i++) other_pairs[i].k = pairs[i].k;
+            other.getRemoteData(other_pairs);
+
+            for (size_t i = 0;i < pairs.size();i++) pairs[i].d = (T)other_pairs[i].d;
+            writeRemoteData(pairs);
+        }
+
         void print(FILE* fp, double cutoff = -1.0) const;
 
         void compare(FILE* fp, const CTFTensor<T>& other, double cutoff = 0.0) const;
@@ -273,6 +593,17 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
                            bool conjb, const CTFTensor<T>& B, const string& idx_B,
                   T  beta,                                     const string& idx_C);
 
+        /*
+         * C[k][idx_C] = alpha*A[idx_A]*B[k][idx_B] + beta*C[k][idx_C] for
+         * every k, as a single contraction with the B[k] and the C[k] stacked
+         * along an extra index, so that A is only read and redistributed
+         * once for all of them
+         */
+        static void multMany(T alpha, bool conja, const CTFTensor<T>& A, const string& idx_A,
+                                      bool conjb, const vector<const CTFTensor<T>*>& B, const string& idx_B,
+                             T  beta,                                             const vector<CTFTensor<T>*>& C,
+                                                                                  const string& idx_C);
+
         void sum(T alpha, T beta);
 
         void sum(T alpha, bool conja, const CTFTensor<T>& A, const string& idx_A,
@@ -282,8 +613,17 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 
         T dot(bool conja, const CTFTensor<T>& A, const string& idx_A,
               bool conjb,                         const string& idx_B) const;
+
+        void localDots(bool conja, const vector<const CTFTensor<T>*>& A, bool conjb,
+                       vector<T>& scalars) const;
 };
 
+/*
+ * Print the hits and misses of the tensor pools of all types, and the
+ * memory held in them (the maximum over processes)
+ */
+void printPoolStatistics(const Arena& arena);
+
 }
 }
 
@@ -0,0 +1,836 @@
+#include "dense_tensor.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+/*
+ * Call f(off_A, off_B) for every combination of index values, where the
+ * first index varies fastest. If parallel, the values of the last index are
+ * divided among threads, so each of them must address distinct elements of
+ * any array which is written to.
+ */
+template <typename Func>
+static void loop(const vector<int>& len, const vector<int64_t>& stride_A,
+                 const vector<int64_t>& stride_B, bool parallel, Func f)
+{
+    int ndim = len.size();
+
+    for (int i = 0;i < ndim;i++) if (len[i] == 0) return;
+
+    if (ndim == 0)
+    {
+        f(0, 0);
+        return;
+    }
+
+    int n = len[ndim-1];
+    #pragma omp parallel for if(parallel && n > 1)
+    for (int o = 0;o < n;o++)
+    {
+        vector<int> idx(ndim-1, 0);
+        int64_t off_A = o*stride_A[ndim-1];
+        int64_t off_B = o*stride_B[ndim-1];
+
+        while (true)
+        {
+            f(off_A, off_B);
+
+            int i;
+            for (i = 0;i < ndim-1;i++)
+            {
+                off_A += stride_A[i];
+                off_B += stride_B[i];
+                if (++idx[i] < len[i]) break;
+                off_A -= stride_A[i]*len[i];
+                off_B -= stride_B[i]*len[i];
+                idx[i] = 0;
+            }
+
+            if (i == ndim-1) break;
+        }
+    }
+}
+
+/*
+ * Return the first position and size of each group of indices which are
+ * related by symmetry
+ */
+static vector<pair<int,int>> symmetricGroups(const vector<int>& sym)
+{
+    vector<pair<int,int>> groups;
+
+    int ndim = sym.size();
+    for (int i = 0;i < ndim;)
+    {
+        int j = i;
+        while (j < ndim-1 && sym[j] != NS) j++;
+        if (j > i) groups.emplace_back(i, j-i+1);
+        i = j+1;
+    }
+
+    return groups;
+}
+
+static bool isOddPermutation(const vector<int>& perm)
+{
+    int ninv = 0;
+    for (int i = 0;i < perm.size();i++)
+        for (int j = i+1;j < perm.size();j++)
+            if (perm[i] > perm[j]) ninv++;
+    return ninv%2 == 1;
+}
+
+/*
+ * Strides of the distinct index letters of a tensor, where a repeated letter
+ * (a diagonal) has the sum of the strides of each of its positions
+ */
+static vector<int64_t> letterStrides(const string& letters, const string& idx,
+                                     const vector<int64_t>& stride)
+{
+    vector<int64_t> s(letters.size(), 0);
+    for (int i = 0;i < letters.size();i++)
+        for (int j = 0;j < idx.size();j++)
+            if (idx[j] == letters[i]) s[i] += stride[j];
+    return s;
+}
+
+/*
+ * Strides of a packed array holding the given letters in order
+ */
+static vector<int64_t> packedStrides(const string& letters, const string& packed,
+                                     const vector<int>& len)
+{
+    vector<int64_t> s(letters.size(), 0);
+    int64_t size = 1;
+    for (char c : packed)
+    {
+        int i = letters.find(c);
+        s[i] = size;
+        size *= len[i];
+    }
+    return s;
+}
+
+template <typename T>
+DenseTensor<T>::DenseTensor(const string& name, T scalar)
+: IndexableTensor< DenseTensor<T>,T >(name)
+{
+    allocate(false);
+    data[0] = scalar;
+}
+
+template <typename T>
+DenseTensor<T>::DenseTensor(const string& name, const DenseTensor<T>& A, T scalar)
+: IndexableTensor< DenseTensor<T>,T >(name)
+{
+    allocate(false);
+    data[0] = scalar;
+}
+
+template <typename T>
+DenseTensor<T>::DenseTensor(const DenseTensor<T>& A, bool copy, bool zero)
+: IndexableTensor< DenseTensor<T>,T >(A.name, A.ndim), len(A.len), sym(A.sym)
+{
+    if (copy)
+    {
+        stride = A.stride;
+        data = A.data;
+    }
+    else
+    {
+        allocate(zero);
+    }
+}
+
+template <typename T>
+DenseTensor<T>::DenseTensor(const string& name, const DenseTensor<T>& A, bool copy, bool zero)
+: IndexableTensor< DenseTensor<T>,T >(name, A.ndim), len(A.len), sym(A.sym)
+{
+    if (copy)
+    {
+        stride = A.stride;
+        data = A.data;
+    }
+    else
+    {
+        allocate(zero);
+    }
+}
+
+template <typename T>
+DenseTensor<T>::DenseTensor(const string& name, DenseTensor<T>&& A)
+: IndexableTensor< DenseTensor<T>,T >(name, A.ndim), len(move(A.len)), sym(move(A.sym)),
+  stride(move(A.stride)), data(move(A.data)) {}
+
+template <typename T>
+DenseTensor<T>::DenseTensor(const string& name, int ndim, const vector<int>& len, bool zero)
+: IndexableTensor< DenseTensor<T>,T >(name, ndim), len(len), sym(ndim, NS)
+{
+    assert(len.size() == ndim);
+    allocate(zero);
+}
+
+template <typename T>
+DenseTensor<T>::DenseTensor(const string& name, int ndim, const vector<int>& len, const vector<int>& sym,
+                            bool zero)
+: IndexableTensor< DenseTensor<T>,T >(name, ndim), len(len), sym(sym)
+{
+    assert(len.size() == ndim);
+    assert(sym.size() == ndim);
+    allocate(zero);
+}
+
+template <typename T>
+void DenseTensor<T>::allocate(bool zero)
+{
+    stride.resize(this->ndim);
+
+    int64_t size = 1;
+    for (int i = 0;i < this->ndim;i++)
+    {
+        stride[i] = size;
+        size *= len[i];
+    }
+
+    /*
+     * Symmetry-related elements must always be consistent, so the data is
+     * zeroed even if not requested
+     */
+    data.assign(size, (T)0);
+}
+
+template <typename T>
+void DenseTensor<T>::resize(int ndim, const vector<int>& len, const vector<int>& sym, bool zero)
+{
+    assert(len.size() == ndim);
+    assert(sym.size() == ndim);
+
+    this->ndim = ndim;
+    this->len = len;
+    this->sym = sym;
+
+    allocate(zero);
+}
+
+template <typename T>
+bool DenseTensor<T>::isCanonical(const vector<int>& idx) const
+{
+    for (int i = 0;i < this->ndim-1;i++)
+    {
+        if (sym[i] == SY && idx[i] > idx[i+1]) return false;
+        if ((sym[i] == AS || sym[i] == SH) && idx[i] >= idx[i+1]) return false;
+    }
+    return true;
+}
+
+template <typename T>
+vector<int> DenseTensor<T>::getIndices(int64_t key) const
+{
+    vector<int> idx(this->ndim);
+    for (int i = 0;i < this->ndim;i++)
+    {
+        idx[i] = key%len[i];
+        key /= len[i];
+    }
+    return idx;
+}
+
+template <typename T>
+void DenseTensor<T>::writeSymmetric(int64_t key, T val)
+{
+    vector<pair<int,int>> groups = symmetricGroups(sym);
+
+    if (groups.empty())
+    {
+        data[key] = val;
+        return;
+    }
+
+    vector<int> idx = getIndices(key);
+
+    vector<vector<int>> perms;
+    for (auto& g : groups)
+    {
+        perms.emplace_back(g.second);
+        iota(perms.back().begin(), perms.back().end(), 0);
+
+        if (sym[g.first] == AS || sym[g.first] == SH)
+        {
+            for (int i = g.first;i < g.first+g.second;i++)
+                for (int j = i+1;j < g.first+g.second;j++)
+                    if (idx[i] == idx[j]) val = (T)0;
+        }
+    }
+
+    /*
+     * Visit every combination of permutations of the symmetric groups
+     */
+    while (true)
+    {
+        int64_t key_p = key;
+        bool negate = false;
+
+        for (int g = 0;g < groups.size();g++)
+        {
+            int first = groups[g].first;
+            int size = groups[g].second;
+            for (int i = 0;i < size;i++)
+            {
+                key_p += (idx[first+perms[g][i]]-idx[first+i])*stride[first+i];
+            }
+            if (sym[first] == AS && isOddPermutation(perms[g])) negate = !negate;
+        }
+
+        data[key_p] = (negate ? -val : val);
+
+        int g;
+        for (g = 0;g < groups.size();g++)
+        {
+            if (next_permutation(perms[g].begin(), perms[g].end())) break;
+        }
+
+        if (g == groups.size()) break;
+    }
+}
+
+template <typename T>
+void DenseTensor<T>::slice(T alpha, bool conja, const DenseTensor<T>& A, const vector<int>& start_A,
+                           T  beta,                                      const vector<int>& start_B,
+                                                                         const vector<int>& len)
+{
+    assert(this->ndim == A.ndim);
+
+    int64_t off0_A = 0, off0_B = 0;
+    for (int i = 0;i < this->ndim;i++)
+    {
+        assert(sym[i] == A.sym[i] && sym[i] == NS);
+        assert(start_A[i] >= 0 && start_A[i]+len[i] <= A.len[i]);
+        assert(start_B[i] >= 0 && start_B[i]+len[i] <= this->len[i]);
+        off0_A += start_A[i]*A.stride[i];
+        off0_B += start_B[i]*stride[i];
+    }
+
+    const T* data_A = A.data.data()+off0_A;
+    T* data_B = data.data()+off0_B;
+
+    loop(len, A.stride, stride, true,
+    [&](int64_t off_A, int64_t off_B)
+    {
+        T val = (conja ? conj(data_A[off_A]) : data_A[off_A]);
+        data_B[off_B] = (beta == (T)0 ? alpha*val : beta*data_B[off_B] + alpha*val);
+    });
+}
+
+template <typename T>
+void DenseTensor<T>::div(T alpha, bool conja, const DenseTensor<T>& A,
+                                  bool conjb, const DenseTensor<T>& B, T beta)
+{
+    int64_t size = data.size();
+    assert(size == A.data.size());
+    assert(size == B.data.size());
+
+    #pragma omp parallel for
+    for (int64_t i = 0;i < size;i++)
+    {
+        T a = (conja ? conj(A.data[i]) : A.data[i]);
+        T b = (conjb ? conj(B.data[i]) : B.data[i]);
+        if (aquarius::abs(b) > numeric_limits<double>::min())
+        {
+            data[i] = beta*data[i] + alpha*a/b;
+        }
+    }
+}
+
+template <typename T>
+void DenseTensor<T>::invert(T alpha, bool conja, const DenseTensor<T>& A, T beta)
+{
+    int64_t size = data.size();
+    assert(size == A.data.size());
+
+    #pragma omp parallel for
+    for (int64_t i = 0;i < size;i++)
+    {
+        T a = (conja ? conj(A.data[i]) : A.data[i]);
+        if (aquarius::abs(a) > numeric_limits<double>::min())
+        {
+            data[i] = beta*data[i] + alpha/a;
+        }
+    }
+}
+
+template <typename T>
+void DenseTensor<T>::weight(const vector<const vector<T>*>& d, double shift)
+{
+    weight(d, shift, NULL);
+}
+
+template <typename T>
+void DenseTensor<T>::weightAndAdd(const vector<const vector<T>*>& d, DenseTensor<T>& B, double shift)
+{
+    assert(len == B.len && sym == B.sym);
+    weight(d, shift, B.data.data());
+}
+
+template <typename T>
+void DenseTensor<T>::weight(const vector<const vector<T>*>& d, double shift, T* sum)
+{
+    if (this->ndim == 0 || data.empty()) return;
+
+    assert(d.size() == this->ndim);
+    for (int i = 0;i < d.size();i++) assert(d[i]->size() == len[i]);
+
+    /*
+     * The denominator along the first (contiguous) dimension is added in an
+     * inner loop which can be vectorized, the rest only once per row
+     */
+    int n = len[0];
+    int64_t nrow = data.size()/n;
+    const T* d0 = d[0]->data();
+
+    #pragma omp parallel for
+    for (int64_t row = 0;row < nrow;row++)
+    {
+        T base = (T)shift;
+        int64_t k = row;
+        for (int j = 1;j < this->ndim;j++)
+        {
+            base += (*d[j])[k%len[j]];
+            k /= len[j];
+        }
+
+        T* restrict data_row = data.data()+row*n;
+
+        #pragma omp simd
+        for (int i = 0;i < n;i++)
+        {
+            T den = base+d0[i];
+            data_row[i] = (aquarius::abs(den) < 1e-4 ? (T)0 : data_row[i]/den);
+        }
+
+        if (sum)
+        {
+            T* restrict sum_row = sum+row*n;
+
+            #pragma omp simd
+            for (int i = 0;i < n;i++) sum_row[i] += data_row[i];
+        }
+    }
+}
+
+template <typename T>
+void DenseTensor<T>::print(FILE* fp, double cutoff) const
+{
+    vector<tkv_pair<T>> pairs;
+    getLocalData(pairs);
+
+    for (auto& p : pairs)
+    {
+        if (aquarius::abs(p.d) <= cutoff) continue;
+
+        vector<int> idx = getIndices(p.k);
+
+        ostringstream os;
+        os << "[";
+        for (int i = 0;i < this->ndim;i++) os << (i == 0 ? "" : ",") << idx[i];
+        os << "](" << p.k << ", <" << p.d << ">)";
+
+        fprintf(fp, "%s\n", os.str().c_str());
+    }
+}
+
+template <typename T>
+void DenseTensor<T>::compare(FILE* fp, const DenseTensor<T>& other, double cutoff) const
+{
+    assert(len == other.len && sym == other.sym);
+
+    vector<tkv_pair<T>> pairs;
+    getLocalData(pairs);
+
+    for (auto& p : pairs)
+    {
+        T val = other.data[p.k];
+        if (aquarius::abs(p.d-val) <= cutoff) continue;
+
+        vector<int> idx = getIndices(p.k);
+
+        ostringstream os;
+        os << "[";
+        for (int i = 0;i < this->ndim;i++) os << (i == 0 ? "" : ",") << idx[i];
+        os << "](" << p.k << ", <" << p.d << ">, <" << val << ">)";
+
+        fprintf(fp, "%s\n", os.str().c_str());
+    }
+}
+
+template <typename T>
+real_type_t<T> DenseTensor<T>::norm(int p) const
+{
+    vector<tkv_pair<T>> pairs;
+    getLocalData(pairs);
+
+    real_type_t<T> ans = 0;
+    for (auto& pair : pairs)
+    {
+        real_type_t<T> val = aquarius::abs(pair.d);
+        if (p == 00)
+        {
+            ans = max(ans, val);
+        }
+        else if (p == 1)
+        {
+            ans += val;
+        }
+        else if (p == 2)
+        {
+            ans += val*val;
+        }
+    }
+
+    return (p == 2 ? sqrt(ans) : ans);
+}
+
+template <typename T>
+void DenseTensor<T>::mult(T alpha, bool conja, const DenseTensor<T>& A, const string& idx_A,
+                                   bool conjb, const DenseTensor<T>& B, const string& idx_B,
+                          T  beta,                                      const string& idx_C)
+{
+    if (idx_A.size() != A.ndim || idx_B.size() != B.ndim || idx_C.size() != this->ndim)
+        throw InvalidNdimError();
+
+    /*
+     * Classify the distinct indices by the tensors they appear in:
+     *
+     * h: A, B, and C (batch)
+     * k: A and B (contracted)
+     * m: A and C
+     * n: B and C
+     * a, b: only A or B (traced)
+     * c: only C (broadcast)
+     */
+    string letters;
+    for (char l : idx_A+idx_B+idx_C)
+        if (letters.find(l) == string::npos) letters += l;
+
+    vector<int> lens(letters.size(), -1);
+    auto setLength = [&](const string& idx, const vector<int>& len)
+    {
+        for (int i = 0;i < idx.size();i++)
+        {
+            int& l = lens[letters.find(idx[i])];
+            if (l != -1 && l != len[i]) throw LengthMismatchError();
+            l = len[i];
+        }
+    };
+    setLength(idx_A, A.len);
+    setLength(idx_B, B.len);
+    setLength(idx_C, len);
+
+    string h, k, m, n, a, b, c;
+    for (char l : letters)
+    {
+        bool inA = idx_A.find(l) != string::npos;
+        bool inB = idx_B.find(l) != string::npos;
+        bool inC = idx_C.find(l) != string::npos;
+
+             if (inA && inB && inC) h += l;
+        else if (inA && inB)        k += l;
+        else if (inA && inC)        m += l;
+        else if (inB && inC)        n += l;
+        else if (inA)               a += l;
+        else if (inB)               b += l;
+        else                        c += l;
+    }
+
+    auto lengthsOf = [&](const string& s)
+    {
+        vector<int> l;
+        for (char x : s) l.push_back(lens[letters.find(x)]);
+        return l;
+    };
+
+    auto sizeOf = [&](const string& s)
+    {
+        int64_t size = 1;
+        for (char x : s) size *= lens[letters.find(x)];
+        return size;
+    };
+
+    auto stridesOf = [&](const string& s, const vector<int64_t>& strides)
+    {
+        vector<int64_t> st;
+        for (char x : s) st.push_back(strides[letters.find(x)]);
+        return st;
+    };
+
+    int64_t M = sizeOf(m), N = sizeOf(n), K = sizeOf(k), H = sizeOf(h);
+
+    vector<int64_t> stride_A = letterStrides(letters, idx_A, A.stride);
+    vector<int64_t> stride_B = letterStrides(letters, idx_B, B.stride);
+    vector<int64_t> stride_C = letterStrides(letters, idx_C, stride);
+
+    /*
+     * Transpose A to [m,k,h] and B to [k,n,h], summing over traced indices
+     * and taking diagonals of repeated indices along the way
+     */
+    vector<T> mat_A(M*K*H, (T)0);
+    vector<T> mat_B(K*N*H, (T)0);
+
+    string order_A = a+m+k+h;
+    vector<int64_t> packed_A = packedStrides(letters, m+k+h, lens);
+    loop(lengthsOf(order_A), stridesOf(order_A, stride_A), stridesOf(order_A, packed_A),
+         !(m+k+h).empty(),
+    [&](int64_t off_A, int64_t off_P)
+    {
+        mat_A[off_P] += (conja ? conj(A.data[off_A]) : A.data[off_A]);
+    });
+
+    string order_B = b+k+n+h;
+    vector<int64_t> packed_B = packedStrides(letters, k+n+h, lens);
+    loop(lengthsOf(order_B), stridesOf(order_B, stride_B), stridesOf(order_B, packed_B),
+         !(k+n+h).empty(),
+    [&](int64_t off_B, int64_t off_P)
+    {
+        mat_B[off_P] += (conjb ? conj(B.data[off_B]) : B.data[off_B]);
+    });
+
+    /*
+     * C[m,n,h] = A[m,k,h]*B[k,n,h]
+     */
+    vector<T> mat_C(M*N*H, (T)0);
+
+    if (M > 0 && N > 0 && K > 0)
+    {
+        #pragma omp parallel for if(H >= omp_get_max_threads())
+        for (int64_t i = 0;i < H;i++)
+        {
+            gemm('N', 'N', M, N, K,
+                 (T)1, mat_A.data()+i*M*K, M,
+                       mat_B.data()+i*K*N, K,
+                 (T)0, mat_C.data()+i*M*N, M);
+        }
+    }
+
+    /*
+     * Output indices from the same operand which are already symmetric
+     * there need not be symmetrized again; every other permutation within
+     * a symmetric group of C is summed over
+     */
+    vector<int> source(this->ndim);
+    for (int i = 0;i < this->ndim;i++)
+    {
+        char l = idx_C[i];
+        int pos;
+        if (m.find(l) != string::npos)
+        {
+            pos = idx_A.find(l);
+            source[i] = 0;
+            for (int j = 0;j < pos;j++) if (A.sym[j] == NS) source[i]++;
+        }
+        else if (n.find(l) != string::npos)
+        {
+            pos = idx_B.find(l);
+            source[i] = 1000;
+            for (int j = 0;j < pos;j++) if (B.sym[j] == NS) source[i]++;
+        }
+        else
+        {
+            source[i] = 2000+i;
+        }
+    }
+
+    vector<pair<int,int>> groups;
+    for (auto& g : symmetricGroups(sym))
+    {
+        for (int i = g.first+1;i < g.first+g.second;i++)
+        {
+            if (source[i] != source[g.first])
+            {
+                groups.push_back(g);
+                break;
+            }
+        }
+    }
+
+    string order_C = c+m+n+h;
+    vector<int64_t> packed_C = packedStrides(letters, m+n+h, lens);
+
+    if (groups.empty())
+    {
+        loop(lengthsOf(order_C), stridesOf(order_C, stride_C), stridesOf(order_C, packed_C), true,
+        [&](int64_t off_C, int64_t off_P)
+        {
+            data[off_C] = (beta == (T)0 ? alpha*mat_C[off_P]
+                                        : beta*data[off_C] + alpha*mat_C[off_P]);
+        });
+
+        return;
+    }
+
+    vector<T> full(data.size(), (T)0);
+
+    loop(lengthsOf(order_C), stridesOf(order_C, stride_C), stridesOf(order_C, packed_C), true,
+    [&](int64_t off_C, int64_t off_P)
+    {
+        full[off_C] = mat_C[off_P];
+    });
+
+    for (auto& g : groups)
+    {
+        vector<T> symmetrized(data.size(), (T)0);
+
+        /*
+         * Permutations among indices with the same source only reproduce the
+         * same terms, so divide them out
+         */
+        map<int,int> counts;
+        for (int i = g.first;i < g.first+g.second;i++) counts[source[i]]++;
+        double factor = 1;
+        for (auto& cnt : counts)
+            for (int i = 2;i <= cnt.second;i++) factor /= i;
+
+        vector<int> perm(g.second);
+        iota(perm.begin(), perm.end(), 0);
+
+        do
+        {
+            vector<int64_t> stride_p = stride;
+            for (int i = 0;i < g.second;i++)
+                stride_p[g.first+i] = stride[g.first+perm[i]];
+
+            T f = (T)((sym[g.first] == AS && isOddPermutation(perm)) ? -factor : factor);
+
+            loop(len, stride, stride_p, true,
+            [&](int64_t off, int64_t off_p)
+            {
+                symmetrized[off] += f*full[off_p];
+            });
+        }
+        while (next_permutation(perm.begin(), perm.end()));
+
+        full.swap(symmetrized);
+    }
+
+    int64_t size = data.size();
+    #pragma omp parallel for
+    for (int64_t i = 0;i < size;i++)
+    {
+        data[i] = (beta == (T)0 ? alpha*full[i] : beta*data[i] + alpha*full[i]);
+    }
+}
+
+template <typename T>
+void DenseTensor<T>::sum(T alpha, T beta)
+{
+    int64_t size = data.size();
+    #pragma omp parallel for
+    for (int64_t i = 0;i < size;i++)
+    {
+        data[i] = (beta == (T)0 ? alpha : beta*data[i] + alpha);
+    }
+}
+
+template <typename T>
+void DenseTensor<T>::sum(T alpha, bool conja, const DenseTensor<T>& A, const string& idx_A,
+                         T  beta,                                      const string& idx_B)
+{
+    DenseTensor<T> one("one", (T)1);
+    mult(alpha, conja, A, idx_A, false, one, "", beta, idx_B);
+}
+
+template <typename T>
+void DenseTensor<T>::scale(T alpha, const string& idx_A)
+{
+    string letters;
+    for (char l : idx_A)
+        if (letters.find(l) == string::npos) letters += l;
+
+    if (letters.size() == idx_A.size())
+    {
+        int64_t size = data.size();
+        #pragma omp parallel for
+        for (int64_t i = 0;i < size;i++) data[i] *= alpha;
+        return;
+    }
+
+    /*
+     * Only scale the diagonal given by the repeated indices
+     */
+    vector<int> lens(letters.size());
+    for (int i = 0;i < idx_A.size();i++) lens[letters.find(idx_A[i])] = len[i];
+
+    vector<int64_t> strides = letterStrides(letters, idx_A, stride);
+    loop(lens, strides, strides, true,
+    [&](int64_t off, int64_t)
+    {
+        data[off] *= alpha;
+    });
+}
+
+template <typename T>
+T DenseTensor<T>::dot(bool conja, const DenseTensor<T>& A, const string& idx_A,
+                      bool conjb,                          const string& idx_B) const
+{
+    DenseTensor<T> scalar("scalar");
+    scalar.mult((T)1, conja,     A, idx_A,
+                      conjb, *this, idx_B,
+                (T)0,                  "");
+    return scalar.data[0];
+}
+
+/*
+ * All elements are stored, so the inner product is a plain sum
+ */
+template <typename T>
+void DenseTensor<T>::localDots(bool conja, const vector<const DenseTensor<T>*>& A, bool conjb,
+                               vector<T>& scalars) const
+{
+    for (int k = 0;k < A.size();k++)
+    {
+        if (A[k]->len != len || A[k]->sym != sym)
+        {
+            scalars[k] += dot(conja, *A[k], this->implicit(), conjb, this->implicit());
+            continue;
+        }
+
+        const T* restrict a = A[k]->data.data();
+        const T* restrict b = data.data();
+        int64_t size = data.size();
+
+        T s = 0;
+        for (int64_t i = 0;i < size;i++)
+        {
+            s += (conja ? conj(a[i]) : a[i])*(conjb ? conj(b[i]) : b[i]);
+        }
+
+        scalars[k] += s;
+    }
+}
+
+template <typename T>
+DenseTensor<T>* DenseTensor<T>::intermediate(const vector<const DenseTensor<T>*>& factors,
+                                             const vector<string>& idx,
+                                             const string& idx_C)
+{
+    string name;
+    vector<int> len(idx_C.size());
+
+    for (int f = 0;f < factors.size();f++)
+    {
+        name += (f == 0 ? "" : "*") + factors[f]->name;
+
+        for (int i = 0;i < idx[f].size();i++)
+        {
+            size_t j = idx_C.find(idx[f][i]);
+            if (j != string::npos) len[j] = factors[f]->len[i];
+        }
+    }
+
+    return new DenseTensor<T>(name, idx_C.size(), len, true);
+}
+
+INSTANTIATE_ALL_SPECIALIZATIONS(DenseTensor);
+
+}
+}
@@ -0,0 +1,188 @@
+#ifndef _AQUARIUS_TENSOR_DENSE_TENSOR_HPP_
+#define _AQUARIUS_TENSOR_DENSE_TENSOR_HPP_
+
+#include "util/global.hpp"
+
+#include "indexable_tensor.hpp"
+#include "expression.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+/*
+ * A tensor stored in full (unpacked) form in the memory of a single process.
+ * Elements are laid out with the first index fastest, so that the offset of
+ * an element is the same as its key in a CTF tensor of the same shape. All
+ * symmetry-related elements are stored explicitly and kept consistent.
+ *
+ * Operations follow the same conventions as CTF: contraction runs over all
+ * values of the contracted indices, and the output is (anti)symmetrized over
+ * those permutations of symmetric output indices which are not already
+ * symmetric in the operands. Contractions are performed as
+ * transpose-transpose-GEMM-transpose.
+ */
+template <typename T>
+class DenseTensor : public IndexableTensor< DenseTensor<T>,T >
+{
+    INHERIT_FROM_INDEXABLE_TENSOR(DenseTensor<T>,T)
+
+    protected:
+        vector<int> len;
+        vector<int> sym;
+        vector<int64_t> stride;
+        vector<T> data;
+
+        void allocate(bool zero);
+
+        bool isCanonical(const vector<int>& idx) const;
+
+        vector<int> getIndices(int64_t key) const;
+
+        /*
+         * Set all elements related to key by symmetry, given the value of
+         * the element at key itself
+         */
+        void writeSymmetric(int64_t key, T val);
+
+        /*
+         * Divide each element by d[0][i]+d[1][j]+...+shift, and add the
+         * result to sum if it is not NULL
+         */
+        void weight(const vector<const vector<T>*>& d, double shift, T* sum);
+
+    public:
+        DenseTensor(const string& name, T scalar = (T)0);
+
+        DenseTensor(const string& name, const DenseTensor<T>& A, T scalar);
+
+        DenseTensor(const DenseTensor<T>& A, bool copy=true, bool zero=false);
+
+        DenseTensor(const string& name, const DenseTensor<T>& A, bool copy=true, bool zero=false);
+
+        /*
+         * Take over the storage of A under a new name
+         */
+        DenseTensor(const string& name, DenseTensor<T>&& A);
+
+        DenseTensor(const string& name, int ndim, const vector<int>& len, bool zero=true);
+
+        DenseTensor(const string& name, int ndim, const vector<int>& len, const vector<int>& sym,
+                    bool zero=true);
+
+        void resize(int ndim, const vector<int>& len, const vector<int>& sym, bool zero);
+
+        const vector<int>& getLengths() const { return len; }
+
+        int64_t getLength(int dim) const { return len[dim]; }
+
+        const vector<int>& getSymmetry() const { return sym; }
+
+        int64_t getSize() const { return data.size(); }
+
+        T* getData() { return data.data(); }
+
+        const T* getData() const { return data.data(); }
+
+        /*
+         * Return the canonical (packed) elements, as CTF would store them
+         */
+        template <typename Container>
+        void getLocalData(Container& pairs) const
+        {
+            pairs.clear();
+
+            vector<int> idx(this->ndim, 0);
+            for (int64_t key = 0;key < (int64_t)data.size();key++)
+            {
+                if (isCanonical(idx)) pairs.push_back(tkv_pair<T>(key, data[key]));
+
+                for (int i = 0;i < this->ndim;i++)
+                {
+                    if (++idx[i] < len[i]) break;
+                    idx[i] = 0;
+                }
+            }
+        }
+
+        template <typename Container>
+        void getRemoteData(Container& pairs) const
+        {
+            for (auto& p : pairs)
+            {
+                assert(p.k >= 0 && p.k < (int64_t)data.size());
+                p.d = data[p.k];
+            }
+        }
+
+        template <typename Container>
+        void writeRemoteData(const Container& pairs)
+        {
+            for (auto& p : pairs) writeSymmetric(p.k, p.d);
+        }
+
+        template <typename Container>
+        void writeRemoteData(double alpha, double beta, const Container& pairs)
+        {
+            for (auto& p : pairs) writeSymmetric(p.k, (T)beta*data[p.k] + (T)alpha*p.d);
+        }
+
+        void slice(T alpha, bool conja, const DenseTensor<T>& A, const vector<int>& start_A,
+                   T  beta,                                      const vector<int>& start_B,
+                                                                 const vector<int>& len);
+
+        void div(T alpha, bool conja, const DenseTensor<T>& A,
+                          bool conjb, const DenseTensor<T>& B, T beta);
+
+        void invert(T alpha, bool conja, const DenseTensor<T>& A, T beta);
+
+        void weight(const vector<const vector<T>*>& d, double shift = 0);
+
+        /*
+         * Weight this tensor and add the result to B in the same pass
+         */
+        void weightAndAdd(const vector<const vector<T>*>& d, DenseTensor<T>& B, double shift = 0);
+
+        void print(FILE* fp, double cutoff = -1.0) const;
+
+        void compare(FILE* fp, const DenseTensor<T>& other, double cutoff = 0.0) const;
+
+        real_type_t<T> norm(int p) const;
+
+        void mult(T alpha, bool conja, const DenseTensor<T>& A, const string& idx_A,
+                           bool conjb, const DenseTensor<T>& B, const string& idx_B,
+                  T  beta,                                      const string& idx_C);
+
+        void sum(T alpha, T beta);
+
+        void sum(T alpha, bool conja, const DenseTensor<T>& A, const string& idx_A,
+                 T  beta,                                      const string& idx_B);
+
+        void scale(T alpha, const string& idx_A);
+
+        T dot(bool conja, const DenseTensor<T>& A, const string& idx_A,
+              bool conjb,                          const string& idx_B) const;
+
+        void localDots(bool conja, const vector<const DenseTensor<T>*>& A, bool conjb,
+                       vector<T>& scalars) const;
+
+        /*
+         * Intermediates for TensorExpression, which have no symmetry
+         */
+        static bool intermediateIndices(const vector<const DenseTensor<T>*>& factors,
+                                        const vector<string>& idx,
+                                        const string& external, string& idx_C)
+        {
+            return true;
+        }
+
+        static DenseTensor<T>* intermediate(const vector<const DenseTensor<T>*>& factors,
+                                            const vector<string>& idx,
+                                            const string& idx_C);
+};
+
+}
+}
+
+#endif
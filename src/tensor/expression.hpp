@@ -0,0 +1,558 @@
+#ifndef _AQUARIUS_TENSOR_EXPRESSION_HPP_
+#define _AQUARIUS_TENSOR_EXPRESSION_HPP_
+
+#include "util/global.hpp"
+
+#include "indexable_tensor.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+/*
+ * A product of any number of indexed tensors, such as
+ *
+ * 0.5*WMNEF["mnef"]*T(1)["ei"]*T(2)["abmn"]
+ *
+ * Nothing is computed until the product is assigned to an indexed tensor
+ * (either directly or as part of a TensorExpression), at which point it is
+ * broken up into binary contractions.
+ */
+template <class Derived, typename T>
+class IndexedTensorProduct
+{
+    public:
+        struct Factor
+        {
+            const remove_const_t<Derived>* tensor;
+            string idx;
+            bool conj;
+        };
+
+        vector<Factor> factors_;
+        T factor_;
+
+        template <class Derived_, typename=enable_if_similar_t<Derived,Derived_>>
+        IndexedTensorProduct(const IndexedTensor<Derived_,T>& A)
+        : factors_{Factor{&A.tensor_, A.idx_, A.conj_}}, factor_(A.factor_) {}
+
+        template <class Derived_, typename=enable_if_similar_t<Derived,Derived_>>
+        IndexedTensorProduct(const IndexedTensorMult<Derived_,T>& AB)
+        : factors_{Factor{&AB.A_.tensor_, AB.A_.idx_, AB.A_.conj_},
+                   Factor{&AB.B_.tensor_, AB.B_.idx_, AB.B_.conj_}}, factor_(AB.factor_) {}
+
+        template <class Derived_, typename=enable_if_similar_t<Derived,Derived_>>
+        IndexedTensorProduct(const IndexedTensorProduct<Derived_,T>& other)
+        : factor_(other.factor_)
+        {
+            for (auto& f : other.factors_)
+            {
+                factors_.push_back(Factor{f.tensor, f.idx, f.conj});
+            }
+        }
+
+        /**********************************************************************
+         *
+         * Unary negation, conjugation
+         *
+         *********************************************************************/
+        IndexedTensorProduct<Derived,T> operator-() const
+        {
+            IndexedTensorProduct<Derived,T> ret(*this);
+            ret.factor_ = -ret.factor_;
+            return ret;
+        }
+
+        friend IndexedTensorProduct<Derived,T> conj(const IndexedTensorProduct<Derived,T>& other)
+        {
+            IndexedTensorProduct<Derived,T> ret(other);
+            for (auto& f : ret.factors_) f.conj = !f.conj;
+            return ret;
+        }
+
+        /**********************************************************************
+         *
+         * Binary tensor operations (multiplication)
+         *
+         *********************************************************************/
+        template <class Derived_, typename=enable_if_similar_t<Derived,Derived_>>
+        IndexedTensorProduct<Derived,T> operator*(const IndexedTensor<Derived_,T>& other) const
+        {
+            IndexedTensorProduct<Derived,T> ret(*this);
+            ret.factors_.push_back(Factor{&other.tensor_, other.idx_, other.conj_});
+            ret.factor_ *= other.factor_;
+            return ret;
+        }
+
+        /**********************************************************************
+         *
+         * Operations with scalars
+         *
+         *********************************************************************/
+        IndexedTensorProduct<Derived,T> operator*(const T factor) const
+        {
+            IndexedTensorProduct<Derived,T> ret(*this);
+            ret.factor_ *= factor;
+            return ret;
+        }
+
+        IndexedTensorProduct<Derived,T> operator/(const T factor) const
+        {
+            IndexedTensorProduct<Derived,T> ret(*this);
+            ret.factor_ /= factor;
+            return ret;
+        }
+
+        friend IndexedTensorProduct<Derived,T> operator*(const T factor, const IndexedTensorProduct<Derived,T>& other)
+        {
+            return other*factor;
+        }
+};
+
+template <class Derived1, class Derived2, class T, typename=enable_if_similar_t<Derived1,Derived2>>
+IndexedTensorProduct<Derived1,T>
+operator*(const IndexedTensorMult<Derived1,T>& t1, const IndexedTensor<Derived2,T>& t2)
+{
+    return IndexedTensorProduct<Derived1,T>(t1)*t2;
+}
+
+/*
+ * A block of tensor statements which are evaluated together, e.g.
+ *
+ * TensorExpression<SpinorbitalTensor<U>,U> expr;
+ * expr(Z(2)["abij"]) += 0.5*WMNEF["mnef"]*T(2)["efij"]*T(2)["abmn"];
+ * expr(Z(2)["abij"]) += 0.5*WMNEF["mnef"]*T(1)["ei"]*T(1)["fj"]*T(2)["abmn"];
+ * expr.evaluate();
+ *
+ * Statements are executed in order. Each product is contracted pairwise in
+ * the order which requires the fewest operations for the actual index
+ * lengths, and intermediates which are common to several products (up to
+ * renaming of indices) are computed only once. An intermediate is recomputed
+ * if a tensor it depends on is written by an intervening statement.
+ *
+ * Intermediates are created through two static functions of Derived:
+ *
+ * bool intermediateIndices(factors, idx, external, idx_C)
+ *
+ *     Check that the product of factors[i][idx[i]] can be held in a tensor
+ *     of this type with the indices idx_C, and reorder idx_C as the
+ *     tensor requires. Indices in external are free indices of the whole
+ *     statement. Orders which would require an intermediate for which
+ *     this is false are not considered.
+ *
+ * Derived* intermediate(factors, idx, idx_C)
+ *
+ *     Create a zeroed intermediate with the indices idx_C.
+ *
+ * and the member function getLength(dim), which gives the length of a
+ * dimension for the purpose of counting operations.
+ */
+template <class Derived, typename T>
+class TensorExpression
+{
+    protected:
+        typedef typename IndexedTensorProduct<const Derived,T>::Factor Factor;
+
+        struct Statement
+        {
+            Derived* tensor;
+            string idx;
+            T alpha, beta;
+            vector<Factor> factors;
+        };
+
+        struct Intermediate
+        {
+            unique_ptr<Derived> tensor;
+            string idx;
+            set<const Derived*> depends;
+        };
+
+        struct Plan
+        {
+            vector<double> cost;
+            vector<int> split;
+            vector<string> kept;
+        };
+
+        vector<Statement> statements;
+        map<string,Intermediate> cache;
+        map<string,int> uses;
+
+        static int popcount(int S)
+        {
+            int n = 0;
+            for (;S;S &= S-1) n++;
+            return n;
+        }
+
+        /*
+         * Letters of the factors in S which also appear in other factors or
+         * in the result
+         */
+        static string keptIndices(const Statement& st, int S)
+        {
+            string outside = st.idx;
+            for (int f = 0;f < st.factors.size();f++)
+            {
+                if (!(S & (1<<f))) outside += st.factors[f].idx;
+            }
+
+            string kept;
+            for (int f = 0;f < st.factors.size();f++)
+            {
+                if (!(S & (1<<f))) continue;
+
+                for (char c : st.factors[f].idx)
+                {
+                    if (contains(outside, c) && !contains(kept, c)) kept += c;
+                }
+            }
+
+            return kept;
+        }
+
+        /*
+         * A name for the product of the factors in S which is independent of
+         * the letters used for the indices, along with the map from the
+         * canonical letters back to those in the statement
+         */
+        static string key(const Statement& st, int S, map<char,char>& letters)
+        {
+            vector<int> which;
+            for (int f = 0;f < st.factors.size();f++)
+            {
+                if (S & (1<<f)) which.push_back(f);
+            }
+
+            std::stable_sort(which.begin(), which.end(),
+            [&st](int a, int b)
+            {
+                const Factor& fa = st.factors[a];
+                const Factor& fb = st.factors[b];
+                return fa.tensor < fb.tensor || (fa.tensor == fb.tensor && fa.conj < fb.conj);
+            });
+
+            map<char,char> canonical;
+            ostringstream oss;
+
+            for (int f : which)
+            {
+                const Factor& fac = st.factors[f];
+
+                string idx;
+                for (char c : fac.idx)
+                {
+                    if (canonical.find(c) == canonical.end())
+                    {
+                        char n = (char)('A'+canonical.size());
+                        canonical[c] = n;
+                        letters[n] = c;
+                    }
+                    idx += canonical[c];
+                }
+
+                oss << fac.tensor << (fac.conj ? "*" : "") << "[" << idx << "]";
+            }
+
+            string kept;
+            for (char c : keptIndices(st, S)) kept += canonical[c];
+            sort(kept.begin(), kept.end());
+
+            oss << "->";
+            for (char c : kept)
+            {
+                oss << c << (contains(st.idx, letters[c]) ? "'" : "");
+            }
+
+            return oss.str();
+        }
+
+        static string translate(const string& idx, const map<char,char>& letters)
+        {
+            string ret;
+            for (char c : idx) ret += letters.find(c)->second;
+            return ret;
+        }
+
+        bool canCreate(const Statement& st, int S, string& idx_C) const
+        {
+            vector<const Derived*> factors;
+            vector<string> idx;
+
+            for (int f = 0;f < st.factors.size();f++)
+            {
+                if (!(S & (1<<f))) continue;
+                factors.push_back(st.factors[f].tensor);
+                idx.push_back(st.factors[f].idx);
+            }
+
+            string external;
+            for (char c : idx_C)
+            {
+                if (contains(st.idx, c)) external += c;
+            }
+
+            return Derived::intermediateIndices(factors, idx, external, idx_C);
+        }
+
+        /*
+         * Find the cheapest order of binary contractions for the product in
+         * st by dynamic programming over subsets of the factors. Intermediates
+         * which are already available cost nothing, and the cost of those
+         * which will be used by later statements as well is shared among them.
+         */
+        Plan plan(const Statement& st) const
+        {
+            int n = st.factors.size();
+            int full = (1<<n)-1;
+
+            map<char,double> length;
+            for (auto& f : st.factors)
+            {
+                for (int i = 0;i < f.idx.size();i++)
+                {
+                    length[f.idx[i]] = f.tensor->getLength(i);
+                }
+            }
+
+            Plan p;
+            p.cost.assign(full+1, numeric_limits<double>::max());
+            p.split.assign(full+1, 0);
+            p.kept.resize(full+1);
+
+            for (int S = 1;S <= full;S++)
+            {
+                p.kept[S] = (S == full ? st.idx : keptIndices(st, S));
+
+                if (popcount(S) == 1)
+                {
+                    p.cost[S] = 0;
+                    continue;
+                }
+
+                double shared = 1;
+
+                if (S != full)
+                {
+                    map<char,char> letters;
+                    string k = key(st, S, letters);
+
+                    if (cache.count(k))
+                    {
+                        p.cost[S] = 0;
+                        continue;
+                    }
+
+                    string idx_C = p.kept[S];
+                    if (!canCreate(st, S, idx_C)) continue;
+
+                    auto u = uses.find(k);
+                    if (u != uses.end()) shared = max(1, u->second);
+                }
+
+                int low = S & -S;
+                for (int L = (S-1) & S;L > 0;L = (L-1) & S)
+                {
+                    if (!(L & low)) continue;
+                    int R = S^L;
+
+                    if (p.cost[L] == numeric_limits<double>::max() ||
+                        p.cost[R] == numeric_limits<double>::max()) continue;
+
+                    string letters = p.kept[L] + p.kept[R] + p.kept[S];
+                    sort(letters.begin(), letters.end());
+                    letters.erase(std::unique(letters.begin(), letters.end()), letters.end());
+
+                    double flops = 1;
+                    for (char c : letters) flops *= length[c];
+
+                    double cost = (p.cost[L]+p.cost[R]+flops)/shared;
+
+                    if (cost < p.cost[S])
+                    {
+                        p.cost[S] = cost;
+                        p.split[S] = L;
+                    }
+                }
+            }
+
+            if (p.cost[full] == numeric_limits<double>::max())
+                throw logic_error("no valid order of contraction for product");
+
+            return p;
+        }
+
+        /*
+         * Form the product of the factors in S, or find it in the cache
+         */
+        Factor contract(const Statement& st, const Plan& p, int S)
+        {
+            if (popcount(S) == 1)
+            {
+                int f = 0;
+                while (!(S & (1<<f))) f++;
+                return st.factors[f];
+            }
+
+            map<char,char> letters;
+            string k = key(st, S, letters);
+
+            auto it = cache.find(k);
+            if (it == cache.end())
+            {
+                Factor A = contract(st, p, p.split[S]);
+                Factor B = contract(st, p, S^p.split[S]);
+
+                vector<const Derived*> factors;
+                vector<string> idx;
+                for (int f = 0;f < st.factors.size();f++)
+                {
+                    if (!(S & (1<<f))) continue;
+                    factors.push_back(st.factors[f].tensor);
+                    idx.push_back(st.factors[f].idx);
+                }
+
+                string idx_C = p.kept[S];
+                bool ok = canCreate(st, S, idx_C);
+                assert(ok);
+
+                Intermediate& I = cache[k];
+                I.tensor.reset(Derived::intermediate(factors, idx, idx_C));
+                I.tensor->mult(1, A.conj, *A.tensor, A.idx,
+                                  B.conj, *B.tensor, B.idx,
+                               0,                    idx_C);
+                I.depends.insert(factors.begin(), factors.end());
+
+                map<char,char> canonical;
+                for (auto& l : letters) canonical[l.second] = l.first;
+                I.idx = translate(idx_C, canonical);
+
+                return Factor{I.tensor.get(), idx_C, false};
+            }
+
+            return Factor{it->second.tensor.get(), translate(it->second.idx, letters), false};
+        }
+
+        /*
+         * Call f with the key of every intermediate which could be used
+         * by statement st
+         */
+        template <typename Func>
+        static void forEachIntermediate(const Statement& st, Func f)
+        {
+            int n = st.factors.size();
+            set<string> seen;
+
+            for (int S = 1;S < (1<<n)-1;S++)
+            {
+                if (popcount(S) < 2) continue;
+
+                map<char,char> letters;
+                string k = key(st, S, letters);
+                if (seen.insert(k).second) f(k);
+            }
+        }
+
+    public:
+        class Target
+        {
+            protected:
+                TensorExpression<Derived,T>& expr;
+                IndexedTensor<Derived,T> C;
+
+                void add(T alpha, T beta, const IndexedTensorProduct<const Derived,T>& AB)
+                {
+                    expr.statements.push_back(Statement{&C.tensor_, C.idx_, alpha*AB.factor_, beta, AB.factors_});
+                }
+
+            public:
+                Target(TensorExpression<Derived,T>& expr, const IndexedTensor<Derived,T>& C)
+                : expr(expr), C(C) {}
+
+                void operator=(const IndexedTensorProduct<const Derived,T>& AB)
+                {
+                    add(1, 0, AB);
+                }
+
+                void operator+=(const IndexedTensorProduct<const Derived,T>& AB)
+                {
+                    add(1, C.factor_, AB);
+                }
+
+                void operator-=(const IndexedTensorProduct<const Derived,T>& AB)
+                {
+                    add(-1, C.factor_, AB);
+                }
+        };
+
+        Target operator()(const IndexedTensor<Derived,T>& C)
+        {
+            return Target(*this, C);
+        }
+
+        /*
+         * Execute the statements recorded so far
+         */
+        void evaluate()
+        {
+            map<string,int> last;
+
+            uses.clear();
+            for (int s = 0;s < statements.size();s++)
+            {
+                forEachIntermediate(statements[s],
+                [&](const string& k)
+                {
+                    uses[k]++;
+                    last[k] = s;
+                });
+            }
+
+            for (int s = 0;s < statements.size();s++)
+            {
+                const Statement& st = statements[s];
+
+                if (st.factors.size() == 1)
+                {
+                    const Factor& A = st.factors[0];
+                    st.tensor->sum(st.alpha, A.conj, *A.tensor, A.idx, st.beta, st.idx);
+                }
+                else
+                {
+                    Plan p = plan(st);
+                    int full = (1<<st.factors.size())-1;
+
+                    Factor A = contract(st, p, p.split[full]);
+                    Factor B = contract(st, p, full^p.split[full]);
+
+                    st.tensor->mult(st.alpha, A.conj, *A.tensor, A.idx,
+                                              B.conj, *B.tensor, B.idx,
+                                    st.beta,                     st.idx);
+                }
+
+                forEachIntermediate(st, [&](const string& k) { uses[k]--; });
+
+                for (auto it = cache.begin();it != cache.end();)
+                {
+                    if (it->second.depends.count(st.tensor) || last[it->first] <= s)
+                    {
+                        it = cache.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+
+            cache.clear();
+            statements.clear();
+        }
+};
+
+}
+}
+
+#endif
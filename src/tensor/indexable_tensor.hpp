@@ -13,6 +13,8 @@ namespace tensor
 template <class Derived, class T> class IndexableTensor;
 template <class Derived, class T> class IndexedTensor;
 template <class Derived, class T> class IndexedTensorMult;
+template <class Derived, class T> class IndexedTensorProduct;
+template <class Derived, class T> class TensorExpression;
 
 #define INHERIT_FROM_INDEXABLE_TENSOR(Derived,T) \
     protected: \
@@ -345,6 +347,39 @@ class IndexedTensor
             return *this;
         }
 
+        /**********************************************************************
+         *
+         * Products of more than two tensors (see expression.hpp)
+         *
+         *********************************************************************/
+
+        template <typename Derived_, typename=enable_if_similar_t<Derived,Derived_>>
+        IndexedTensor<Derived,T>& operator=(const IndexedTensorProduct<Derived_,T>& other)
+        {
+            TensorExpression<Derived,T> expr;
+            expr(*this) = other;
+            expr.evaluate();
+            return *this;
+        }
+
+        template <typename Derived_, typename=enable_if_similar_t<Derived,Derived_>>
+        IndexedTensor<Derived,T>& operator+=(const IndexedTensorProduct<Derived_,T>& other)
+        {
+            TensorExpression<Derived,T> expr;
+            expr(*this) += other;
+            expr.evaluate();
+            return *this;
+        }
+
+        template <typename Derived_, typename=enable_if_similar_t<Derived,Derived_>>
+        IndexedTensor<Derived,T>& operator-=(const IndexedTensorProduct<Derived_,T>& other)
+        {
+            TensorExpression<Derived,T> expr;
+            expr(*this) -= other;
+            expr.evaluate();
+            return *this;
+        }
+
         template <typename Derived_, typename=enable_if_similar_t<Derived,Derived_>>
         IndexedTensorMult<Derived,T> operator*(const IndexedTensor<Derived_,T>& other) const
         {
@@ -127,6 +127,9 @@ static int conv_idx(const vector<int>& cidx_A, string& iidx_A,
 template<class T>
 map<const tCTF_World<T>*,map<const PointGroup*,pair<int,SpinorbitalTensor<T>*>>> SpinorbitalTensor<T>::scalars;
 
+template<class T>
+map<string,vector<typename SpinorbitalTensor<T>::PlanStep>> SpinorbitalTensor<T>::plans;
+
 template<class T>
 SpinorbitalTensor<T>::SpinorbitalTensor(const string& name, const SpinorbitalTensor<T>& t, const T val)
 : IndexableCompositeTensor<SpinorbitalTensor<T>,SymmetryBlockedTensor<T>,T >(name, 0, 0),
@@ -442,15 +445,35 @@ template<class T>
 const SymmetryBlockedTensor<T>& SpinorbitalTensor<T>::operator()(const vector<int>& alpha_out,
                                                                  const vector<int>& alpha_in) const
 {
-    for (typename vector<SpinCase>::const_iterator sc = cases.begin();sc != cases.end();++sc)
+    return *cases[getCase(alpha_out, alpha_in)].tensor;
+}
+
+template<class T>
+string SpinorbitalTensor<T>::planKey() const
+{
+    ostringstream oss;
+    oss << spaces.size() << ':' << nout << ':' << nin << ':' << spin;
+    for (const SpinCase& sc : cases) oss << ':' << sc.alpha_out << sc.alpha_in;
+    return oss.str();
+}
+
+template<class T>
+int SpinorbitalTensor<T>::getCase(const vector<int>& alpha_out, const vector<int>& alpha_in) const
+{
+    for (int sc = 0;sc < cases.size();sc++)
     {
-        if (sc->alpha_out == alpha_out &&
-            sc->alpha_in  == alpha_in) return *(sc->tensor);
+        if (cases[sc].alpha_out == alpha_out &&
+            cases[sc].alpha_in  == alpha_in) return sc;
     }
 
     throw logic_error("spin case not found");
 }
 
+/*
+ * The spin-case expansion only depends on the index strings and on the
+ * number of indices and spin cases of each tensor, so it is done once and
+ * replayed on subsequent calls.
+ */
 template<class T>
 void SpinorbitalTensor<T>::mult(const T alpha, bool conja, const SpinorbitalTensor<T>& A, const string& idx_A,
                                                bool conjb, const SpinorbitalTensor<T>& B, const string& idx_B,
@@ -464,11 +487,91 @@ void SpinorbitalTensor<T>::mult(const T alpha, bool conja, const SpinorbitalTens
     assert(spaces == A.spaces || this->ndim == 0 || A.ndim == 0);
     assert(spaces == B.spaces || this->ndim == 0 || B.ndim == 0);
 
+    string key = "mult/" + idx_A + "/" + idx_B + "/" + idx_C + "/" +
+                 A.planKey() + "/" + B.planKey() + "/" + planKey();
+
+    auto plan = plans.find(key);
+    if (plan == plans.end())
+    {
+        plan = plans.insert(make_pair(key, planMult(A, idx_A, B, idx_B, idx_C))).first;
+    }
+
     vector<T> beta(cases.size(), beta_);
 
+    for (const PlanStep& step : plan->second)
+    {
+        cases[step.case_C].tensor->mult(alpha*step.factor, conja, *A.cases[step.case_A].tensor, step.idx_A,
+                                                           conjb, *B.cases[step.case_B].tensor, step.idx_B,
+                                                  beta[step.case_C],                            step.idx_C);
+
+        beta[step.case_C] = 1.0;
+    }
+}
+
+/*
+ * Every right-hand side shares the plan of the first, and each spin case of
+ * A is contracted once against the corresponding spin case of all of them.
+ */
+template<class T>
+void SpinorbitalTensor<T>::multMany(const T alpha, bool conja, const SpinorbitalTensor<T>& A, const string& idx_A,
+                                                   bool conjb, const vector<const SpinorbitalTensor<T>*>& B,
+                                                                                                 const string& idx_B,
+                                    const T beta_,             const vector<SpinorbitalTensor<T>*>& C,
+                                                                                                 const string& idx_C)
+{
+    assert(B.size() == C.size());
+    if (C.empty()) return;
+
+    const SpinorbitalTensor<T>& B0 = *B[0];
+    const SpinorbitalTensor<T>& C0 = *C[0];
+
+    for (int k = 0;k < C.size();k++)
+    {
+        assert(C[k]->group == A.group && B[k]->group == A.group);
+        assert(B[k]->planKey() == B0.planKey());
+        assert(C[k]->planKey() == C0.planKey());
+    }
+
+    string key = "mult/" + idx_A + "/" + idx_B + "/" + idx_C + "/" +
+                 A.planKey() + "/" + B0.planKey() + "/" + C0.planKey();
+
+    auto plan = plans.find(key);
+    if (plan == plans.end())
+    {
+        plan = plans.insert(make_pair(key, C0.planMult(A, idx_A, B0, idx_B, idx_C))).first;
+    }
+
+    vector<T> beta(C0.cases.size(), beta_);
+
+    for (const PlanStep& step : plan->second)
+    {
+        vector<const SymmetryBlockedTensor<T>*> B_;
+        vector<SymmetryBlockedTensor<T>*> C_;
+        for (int k = 0;k < C.size();k++)
+        {
+            B_.push_back(B[k]->cases[step.case_B].tensor);
+            C_.push_back(C[k]->cases[step.case_C].tensor);
+        }
+
+        SymmetryBlockedTensor<T>::multMany(alpha*step.factor, conja, *A.cases[step.case_A].tensor, step.idx_A,
+                                                              conjb,                           B_, step.idx_B,
+                                           beta[step.case_C],                                  C_, step.idx_C);
+
+        beta[step.case_C] = 1.0;
+    }
+}
+
+template<class T>
+vector<typename SpinorbitalTensor<T>::PlanStep>
+SpinorbitalTensor<T>::planMult(const SpinorbitalTensor<T>& A, const string& idx_A,
+                               const SpinorbitalTensor<T>& B, const string& idx_B,
+                                                              const string& idx_C) const
+{
+    vector<PlanStep> plan;
+
     for (int sc = 0;sc < cases.size();sc++)
     {
-        SpinCase& scC = cases[sc];
+        const SpinCase& scC = cases[sc];
 
         int nouttot_C = aquarius::sum(nout);
 
@@ -768,25 +871,13 @@ void SpinorbitalTensor<T>::mult(const T alpha, bool conja, const SpinorbitalTens
 
             if (spin_A != A.spin || spin_B != B.spin) continue;
 
-            const SymmetryBlockedTensor<T>& tensor_A = A(alpha_out_A, alpha_in_A);
-            const SymmetryBlockedTensor<T>& tensor_B = B(alpha_out_B, alpha_in_B);
-
-            if (0)
-            {
-                cout << alpha << " " << beta[sc] << " " << *t << endl;
-                cout <<    tensor_A.getSymmetry() << " " <<   alpha_out_A << " " <<   alpha_in_A << endl;
-                cout <<    tensor_B.getSymmetry() << " " <<   alpha_out_B << " " <<   alpha_in_B << endl;
-                cout << scC.tensor->getSymmetry() << " " << scC.alpha_out << " " << scC.alpha_in << endl;
-                cout << idx_A__ << " " << idx_B__ << " " << idx_C__ << endl;
-            }
-
-            scC.tensor->mult(alpha*diagFactor, conja, tensor_A, idx_A__,
-                                               conjb, tensor_B, idx_B__,
-                                     beta[sc],                  idx_C__);
-
-            beta[sc] = 1.0;
+            plan.push_back(PlanStep{sc, A.getCase(alpha_out_A, alpha_in_A),
+                                        B.getCase(alpha_out_B, alpha_in_B),
+                                    diagFactor, idx_A__, idx_B__, idx_C__});
         }
     }
+
+    return plan;
 }
 
 template<class T>
@@ -798,11 +889,35 @@ void SpinorbitalTensor<T>::sum(const T alpha, bool conja, const SpinorbitalTenso
     assert(idx_B.size() == this->ndim);
     assert(spaces == A.spaces || this->ndim == 0 || A.ndim == 0);
 
+    string key = "sum/" + idx_A + "/" + idx_B + "/" + A.planKey() + "/" + planKey();
+
+    auto plan = plans.find(key);
+    if (plan == plans.end())
+    {
+        plan = plans.insert(make_pair(key, planSum(A, idx_A, idx_B))).first;
+    }
+
     vector<T> beta(cases.size(), beta_);
 
+    for (const PlanStep& step : plan->second)
+    {
+        cases[step.case_C].tensor->sum(alpha*step.factor, conja, *A.cases[step.case_A].tensor, step.idx_A,
+                                                 beta[step.case_C],                            step.idx_C);
+
+        beta[step.case_C] = 1.0;
+    }
+}
+
+template<class T>
+vector<typename SpinorbitalTensor<T>::PlanStep>
+SpinorbitalTensor<T>::planSum(const SpinorbitalTensor<T>& A, const string& idx_A,
+                                                             const string& idx_B) const
+{
+    vector<PlanStep> plan;
+
     for (int sc = 0;sc < cases.size();sc++)
     {
-        SpinCase& scB = cases[sc];
+        const SpinCase& scB = cases[sc];
 
         int nouttot_B = aquarius::sum(this->nout);
 
@@ -1005,16 +1120,12 @@ void SpinorbitalTensor<T>::sum(const T alpha, bool conja, const SpinorbitalTenso
             conv_idx(idx_A_, idx_A__,
                      idx_B_, idx_B__);
 
-            //cout << alpha << " " << beta[sc] << " " << *t << endl;
-
-            const SymmetryBlockedTensor<T>& tensor_A = A(alpha_out_A, alpha_in_A);
-
-            scB.tensor->sum(alpha*diagFactor, conja, tensor_A, idx_A__,
-                                    beta[sc],                  idx_B__);
-
-            beta[sc] = 1.0;
+            plan.push_back(PlanStep{sc, A.getCase(alpha_out_A, alpha_in_A), -1,
+                                    diagFactor, idx_A__, "", idx_B__});
         }
     }
+
+    return plan;
 }
 
 template<class T>
@@ -1038,9 +1149,27 @@ template<class T>
 void SpinorbitalTensor<T>::weight(const vector<const vector<vector<T>>*>& da,
                                   const vector<const vector<vector<T>>*>& db,
                                   double shift)
+{
+    weight(da, db, shift, NULL);
+}
+
+template<class T>
+void SpinorbitalTensor<T>::weightAndAdd(const vector<const vector<vector<T>>*>& da,
+                                        const vector<const vector<vector<T>>*>& db,
+                                        SpinorbitalTensor<T>& B, double shift)
+{
+    weight(da, db, shift, &B);
+}
+
+template<class T>
+void SpinorbitalTensor<T>::weight(const vector<const vector<vector<T>>*>& da,
+                                  const vector<const vector<vector<T>>*>& db,
+                                  double shift, SpinorbitalTensor<T>* sum)
 {
     vector<const vector<vector<T>>*> d(this->ndim);
 
+    if (sum) assert(sum->cases.size() == cases.size());
+
     for (typename vector<SpinCase>::iterator sc = cases.begin();sc != cases.end();++sc)
     {
         int i = 0;
@@ -1055,7 +1184,14 @@ void SpinorbitalTensor<T>::weight(const vector<const vector<vector<T>>*>& da,
             for (int b = 0;b < nin[s]-sc->alpha_in[s];b++,i++) d[i] = db[s];
         }
 
-        sc->tensor->weight(d, shift);
+        if (sum)
+        {
+            sc->tensor->weightAndAdd(d, *sum->cases[sc-cases.begin()].tensor, shift);
+        }
+        else
+        {
+            sc->tensor->weight(d, shift);
+        }
     }
 }
 
@@ -1073,6 +1209,49 @@ T SpinorbitalTensor<T>::dot(bool conja, const SpinorbitalTensor<T>& A, const str
     return vals[0];
 }
 
+/*
+ * Each stored spin case stands in for all of the cases related to it by
+ * permutation of same-spin indices, as in norm
+ */
+template<class T>
+void SpinorbitalTensor<T>::localDots(bool conja, const vector<const SpinorbitalTensor<T>*>& A,
+                                     bool conjb, vector<T>& scalars) const
+{
+    string key = planKey();
+
+    vector<int> which;
+    for (int k = 0;k < A.size();k++)
+    {
+        if (A[k]->spaces == spaces && A[k]->planKey() == key)
+        {
+            which.push_back(k);
+        }
+        else
+        {
+            T val = dot(conja, *A[k], this->implicit(), conjb, this->implicit());
+            if (this->arena.rank == 0) scalars[k] += val;
+        }
+    }
+
+    for (int sc = 0;sc < cases.size();sc++)
+    {
+        double factor = 1;
+        for (int s = 0;s < spaces.size();s++)
+        {
+            factor *= binom(nout[s], cases[sc].alpha_out[s]);
+            factor *= binom( nin[s],  cases[sc].alpha_in[s]);
+        }
+
+        vector<const SymmetryBlockedTensor<T>*> A_sc;
+        for (int k : which) A_sc.push_back(A[k]->cases[sc].tensor);
+
+        vector<T> sub(A_sc.size(), (T)0);
+        cases[sc].tensor->localDots(conja, A_sc, conjb, sub);
+
+        for (int k = 0;k < which.size();k++) scalars[which[k]] += (T)factor*sub[k];
+    }
+}
+
 template<class T>
 real_type_t<T> SpinorbitalTensor<T>::norm(int p) const
 {
@@ -1108,6 +1287,147 @@ real_type_t<T> SpinorbitalTensor<T>::norm(int p) const
     return nrm;
 }
 
+template<class T>
+int64_t SpinorbitalTensor<T>::getLength(int dim) const
+{
+    assert(dim >= 0 && dim < this->ndim);
+
+    for (int s = 0;s < spaces.size();s++)
+    {
+        if (dim < nout[s]) return aquarius::sum(spaces[s].nalpha)+aquarius::sum(spaces[s].nbeta);
+        dim -= nout[s];
+    }
+
+    for (int s = 0;s < spaces.size();s++)
+    {
+        if (dim < nin[s]) return aquarius::sum(spaces[s].nalpha)+aquarius::sum(spaces[s].nbeta);
+        dim -= nin[s];
+    }
+
+    return 0;
+}
+
+template<class T>
+bool SpinorbitalTensor<T>::intermediateIndices(const vector<const SpinorbitalTensor<T>*>& factors,
+                                               const vector<string>& idx,
+                                               const string& external, string& idx_C)
+{
+    struct Occurrence
+    {
+        int factor, space;
+        bool out;
+    };
+
+    const SpinorbitalTensor<T>* first = factors[0];
+    for (auto f : factors) if (f->ndim > 0) first = f;
+    int nspaces = first->spaces.size();
+
+    int nouttot = 0, nintot = 0;
+    Representation rep = first->group.totallySymmetricIrrep();
+    map<char,vector<Occurrence>> occurrences;
+
+    for (int f = 0;f < factors.size();f++)
+    {
+        const SpinorbitalTensor<T>& t = *factors[f];
+
+        if (t.ndim > 0 && t.spaces != first->spaces) return false;
+
+        rep *= t.cases[0].tensor->getRepresentation();
+
+        int i = 0;
+        for (int s = 0;s < t.spaces.size();s++)
+            for (int j = 0;j < t.nout[s];j++)
+                occurrences[idx[f][i++]].push_back(Occurrence{f, s, true});
+        for (int s = 0;s < t.spaces.size();s++)
+            for (int j = 0;j < t.nin[s];j++)
+                occurrences[idx[f][i++]].push_back(Occurrence{f, s, false});
+    }
+
+    vector<string> groups(2*nspaces);
+
+    for (auto& o : occurrences)
+    {
+        const vector<Occurrence>& occ = o.second;
+
+        if (contains(idx_C, o.first))
+        {
+            if (occ.size() != 1) return false;
+            groups[(occ[0].out ? 0 : nspaces)+occ[0].space] += o.first;
+            (occ[0].out ? nouttot : nintot)++;
+        }
+        else
+        {
+            if (occ.size() != 2 ||
+                occ[0].factor == occ[1].factor ||
+                occ[0].space != occ[1].space ||
+                occ[0].out == occ[1].out) return false;
+        }
+    }
+
+    if (!rep.isTotallySymmetric() && nouttot != nintot) return false;
+
+    for (auto& g : groups)
+    {
+        bool single = true, allfree = true;
+
+        for (char c : g)
+        {
+            if (occurrences[c][0].factor != occurrences[g[0]][0].factor) single = false;
+            if (!contains(external, c)) allfree = false;
+        }
+
+        if (!single && !allfree) return false;
+    }
+
+    idx_C.clear();
+    for (auto& g : groups) idx_C += g;
+
+    return true;
+}
+
+template<class T>
+SpinorbitalTensor<T>* SpinorbitalTensor<T>::intermediate(const vector<const SpinorbitalTensor<T>*>& factors,
+                                                         const vector<string>& idx,
+                                                         const string& idx_C)
+{
+    const SpinorbitalTensor<T>* first = factors[0];
+    for (auto f : factors) if (f->ndim > 0) first = f;
+    int nspaces = first->spaces.size();
+
+    string name;
+    int spin = 0;
+    Representation rep = first->group.totallySymmetricIrrep();
+    vector<int> nout(nspaces, 0), nin(nspaces, 0);
+
+    for (int f = 0;f < factors.size();f++)
+    {
+        const SpinorbitalTensor<T>& t = *factors[f];
+
+        name += (f == 0 ? "" : "*") + t.name;
+        spin += t.spin;
+        rep *= t.cases[0].tensor->getRepresentation();
+
+        int i = 0;
+        for (int s = 0;s < t.spaces.size();s++)
+            for (int j = 0;j < t.nout[s];j++)
+                if (contains(idx_C, idx[f][i++])) nout[s]++;
+        for (int s = 0;s < t.spaces.size();s++)
+            for (int j = 0;j < t.nin[s];j++)
+                if (contains(idx_C, idx[f][i++])) nin[s]++;
+    }
+
+    if (rep.isTotallySymmetric())
+    {
+        return new SpinorbitalTensor<T>(name, first->arena, first->group,
+                                        first->spaces, nout, nin, spin);
+    }
+    else
+    {
+        return new SpinorbitalTensor<T>(name, first->arena, first->group, rep,
+                                        first->spaces, nout, nin, spin);
+    }
+}
+
 
 template <typename T>
 void SpinorbitalTensor<T>::register_scalar()
@@ -1157,7 +1477,7 @@ SpinorbitalTensor<T>& SpinorbitalTensor<T>::scalar() const
     return *scalars[&arena.ctf<T>()][&group].second;
 }
 
-INSTANTIATE_SPECIALIZATIONS(SpinorbitalTensor);
+INSTANTIATE_ALL_SPECIALIZATIONS(SpinorbitalTensor);
 
 }
 }
@@ -9,6 +9,7 @@
 
 #include "symblocked_tensor.hpp"
 #include "composite_tensor.hpp"
+#include "expression.hpp"
 
 namespace aquarius
 {
@@ -51,6 +52,27 @@ class SpinorbitalTensor : public IndexableCompositeTensor<SpinorbitalTensor<T>,S
 
         const symmetry::PointGroup& getGroup() const { return group; }
 
+        /*
+         * Total number of spin-orbitals in the space of dimension dim
+         */
+        int64_t getLength(int dim) const;
+
+        /*
+         * Intermediates for TensorExpression. Indices in the same space and
+         * direction (out or in) are antisymmetric, so each such group of
+         * indices of an intermediate must either come from a single factor
+         * or be free in the whole statement (in which case the result is
+         * antisymmetrized over them anyway). Contracted indices must join
+         * an outgoing and an incoming index so that the spin is definite.
+         */
+        static bool intermediateIndices(const vector<const SpinorbitalTensor<T>*>& factors,
+                                        const vector<string>& idx,
+                                        const string& external, string& idx_C);
+
+        static SpinorbitalTensor<T>* intermediate(const vector<const SpinorbitalTensor<T>*>& factors,
+                                                  const vector<string>& idx,
+                                                  const string& idx_C);
+
         SymmetryBlockedTensor<T>& operator()(const vector<int>& alpha_out,
                                              const vector<int>& alpha_in);
 
@@ -61,6 +83,17 @@ class SpinorbitalTensor : public IndexableCompositeTensor<SpinorbitalTensor<T>,S
                                  bool conjb, const SpinorbitalTensor<T>& B_, const string& idx_B,
                   const T beta_,                                             const string& idx_C);
 
+        /*
+         * C[k][idx_C] = alpha*A[idx_A]*B[k][idx_B] + beta*C[k][idx_C] for
+         * every k, reading A only once; the B[k] and C[k] must all have the
+         * same shape
+         */
+        static void multMany(const T alpha, bool conja, const SpinorbitalTensor<T>& A, const string& idx_A,
+                                            bool conjb, const vector<const SpinorbitalTensor<T>*>& B,
+                                                                                          const string& idx_B,
+                             const T beta_,             const vector<SpinorbitalTensor<T>*>& C,
+                                                                                          const string& idx_C);
+
         void sum(const T alpha, bool conja, const SpinorbitalTensor<T>& A_, const string& idx_A,
                  const T beta_,                                             const string& idx_B);
 
@@ -70,9 +103,19 @@ class SpinorbitalTensor : public IndexableCompositeTensor<SpinorbitalTensor<T>,S
                     const vector<const vector<vector<T>>*>& db,
                     double shift = 0);
 
+        /*
+         * Weight this tensor and add the result to B in the same pass
+         */
+        void weightAndAdd(const vector<const vector<vector<T>>*>& da,
+                          const vector<const vector<vector<T>>*>& db,
+                          SpinorbitalTensor<T>& B, double shift = 0);
+
         T dot(bool conja, const SpinorbitalTensor<T>& A, const string& idx_A,
               bool conjb,                                const string& idx_B) const;
 
+        void localDots(bool conja, const vector<const SpinorbitalTensor<T>*>& A, bool conjb,
+                       vector<T>& scalars) const;
+
         real_type_t<T> norm(int p) const;
 
     protected:
@@ -87,18 +130,45 @@ class SpinorbitalTensor : public IndexableCompositeTensor<SpinorbitalTensor<T>,S
                            const vector<int>& alpha_in);
         };
 
+        /*
+         * One spin-case block operation of a mult or sum:
+         * C(case_C) += factor*A(case_A)*B(case_B).
+         */
+        struct PlanStep
+        {
+            int case_C, case_A, case_B;
+            double factor;
+            string idx_A, idx_B, idx_C;
+        };
+
         const symmetry::PointGroup& group;
         vector<op::Space> spaces;
         vector<int> nout, nin;
         int spin;
         vector<SpinCase> cases;
         static map<const tCTF_World<T>*,map<const symmetry::PointGroup*,pair<int,SpinorbitalTensor<T>*>>> scalars;
+        static map<string,vector<PlanStep>> plans;
+
+        string planKey() const;
+
+        int getCase(const vector<int>& alpha_out, const vector<int>& alpha_in) const;
+
+        vector<PlanStep> planMult(const SpinorbitalTensor<T>& A, const string& idx_A,
+                                  const SpinorbitalTensor<T>& B, const string& idx_B,
+                                                                 const string& idx_C) const;
+
+        vector<PlanStep> planSum(const SpinorbitalTensor<T>& A, const string& idx_A,
+                                                                const string& idx_B) const;
 
         void register_scalar();
 
         void unregister_scalar();
 
         SpinorbitalTensor<T>& scalar() const;
+
+        void weight(const vector<const vector<vector<T>>*>& da,
+                    const vector<const vector<vector<T>>*>& db,
+                    double shift, SpinorbitalTensor<T>* sum);
 };
 
 }
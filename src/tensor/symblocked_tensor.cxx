@@ -458,6 +458,7 @@ SymmetryBlockedTensor<T>::SymmetryBlockedTensor(const SymmetryBlockedTensor<T>&
   group(other.group), rep(other.rep), len(other.len), sym(other.sym), factor(other.factor),
   reorder(other.reorder)
 {
+    setStorage(other.getStorage());
     register_scalar();
 }
 
@@ -476,6 +477,7 @@ SymmetryBlockedTensor<T>::SymmetryBlockedTensor(const string& name, const Symmet
   group(other.group), rep(other.rep), len(other.len), sym(other.sym), factor(other.factor),
   reorder(other.reorder)
 {
+    setStorage(other.getStorage());
     register_scalar();
 }
 
@@ -736,6 +738,25 @@ bool SymmetryBlockedTensor<T>::exists(const vector<int>& irreps) const
     return tensors[off] != NULL && tensors[off].isAlloced;
 }
 
+template <class T>
+void SymmetryBlockedTensor<T>::setStorage(Storage storage)
+{
+    for (auto& t : tensors)
+    {
+        if (t.isAlloced) t.tensor->setStorage(storage);
+    }
+}
+
+template <class T>
+Storage SymmetryBlockedTensor<T>::getStorage() const
+{
+    for (auto& t : tensors)
+    {
+        if (t.isAlloced) return t.tensor->getStorage();
+    }
+    return IN_CORE;
+}
+
 template <class T>
 void SymmetryBlockedTensor<T>::slice(T alpha, bool conja, const SymmetryBlockedTensor<T>& A,
                                      const vector<vector<int>>& start_A, T beta)
@@ -860,9 +881,10 @@ vector<int> SymmetryBlockedTensor<T>::getStrides(const string& indices, int ndim
 }
 
 template <class T>
-void SymmetryBlockedTensor<T>::mult(T alpha, bool conja, const SymmetryBlockedTensor<T>& A, const string& idx_A,
-                                             bool conjb, const SymmetryBlockedTensor<T>& B, const string& idx_B,
-                                    T  beta,                                                const string& idx_C)
+vector<typename SymmetryBlockedTensor<T>::BlockOp>
+SymmetryBlockedTensor<T>::blockOps(T alpha, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                            const SymmetryBlockedTensor<T>& B, const string& idx_B,
+                                                                               const string& idx_C) const
 {
     assert(group == A.group);
     assert(group == B.group);
@@ -1022,7 +1044,7 @@ void SymmetryBlockedTensor<T>::mult(T alpha, bool conja, const SymmetryBlockedTe
     //if (ndim == 6) cout << syms << endl;
     //if (ndim == 6) cout << inds << endl;
 
-    vector<T> beta_(tensors.size(), beta);
+    vector<BlockOp> ops;
 
     int off_A = 0;
     int off_B = 0;
@@ -1055,11 +1077,7 @@ void SymmetryBlockedTensor<T>::mult(T alpha, bool conja, const SymmetryBlockedTe
             int off_B_ = (B.tensors[off_B].isAlloced ? off_B : B.tensors[off_B].ref);
             int off_C_ = (  tensors[off_C].isAlloced ? off_C :   tensors[off_C].ref);
             assert(off_C_ >= 0 && off_C_ < tensors.size());
-            tensors[off_C_].tensor->mult(alpha*f1*f3/f2, conja, *A.tensors[off_A_].tensor, idx_A__,
-                                                         conjb, *B.tensors[off_B_].tensor, idx_B__,
-                                         beta_[off_C_],                                    idx_C__);
-
-            beta_[off_C_] = 1.0;
+            ops.push_back(BlockOp{off_C_, off_A_, off_B_, (T)(alpha*f1*f3/f2), idx_A__, idx_B__, idx_C__});
         }
 
         for (int i = 0;i < m;i++)
@@ -1086,11 +1104,321 @@ void SymmetryBlockedTensor<T>::mult(T alpha, bool conja, const SymmetryBlockedTe
 
         if (m == 0) done = true;
     }
+
+    return ops;
 }
 
 template <class T>
-void SymmetryBlockedTensor<T>::sum(T alpha, bool conja, const SymmetryBlockedTensor<T>& A, const string& idx_A,
-                                   T  beta,                                                const string& idx_B)
+void SymmetryBlockedTensor<T>::mult(T alpha, bool conja, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                             bool conjb, const SymmetryBlockedTensor<T>& B, const string& idx_B,
+                                    T  beta,                                                const string& idx_C)
+{
+    run(conja, A, conjb, &B, beta, blockOps(alpha, A, idx_A, B, idx_B, idx_C));
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::multMany(T alpha, bool conja, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                                 bool conjb, const vector<const SymmetryBlockedTensor<T>*>& B,
+                                                                                                    const string& idx_B,
+                                        T  beta,             const vector<SymmetryBlockedTensor<T>*>& C,
+                                                                                                    const string& idx_C)
+{
+    assert(B.size() == C.size());
+    if (C.empty()) return;
+
+    /*
+     * Right-hand sides which transform differently have different blocks,
+     * so those are done separately
+     */
+    vector<const SymmetryBlockedTensor<T>*> B_other;
+    vector<SymmetryBlockedTensor<T>*> C_other;
+    for (int k = C.size()-1;k > 0;k--)
+    {
+        assert(B[k]->group == B[0]->group && C[k]->group == C[0]->group);
+
+        if (!B[k]->rep.transformsAs(B[0]->rep) ||
+            !C[k]->rep.transformsAs(C[0]->rep))
+        {
+            B_other.push_back(B[k]);
+            C_other.push_back(C[k]);
+        }
+    }
+
+    if (!C_other.empty())
+    {
+        vector<const SymmetryBlockedTensor<T>*> B_same;
+        vector<SymmetryBlockedTensor<T>*> C_same;
+        for (int k = 0;k < C.size();k++)
+        {
+            if (!contains(C_other, C[k]))
+            {
+                B_same.push_back(B[k]);
+                C_same.push_back(C[k]);
+            }
+        }
+
+        multMany(alpha, conja, A, idx_A, conjb, B_same, idx_B, beta, C_same, idx_C);
+        multMany(alpha, conja, A, idx_A, conjb, B_other, idx_B, beta, C_other, idx_C);
+        return;
+    }
+
+    /*
+     * The block structure is now the same for every right-hand side, so
+     * the contractions are worked out once for the first
+     */
+    vector<BlockOp> ops = C[0]->blockOps(alpha, A, idx_A, *B[0], idx_B, idx_C);
+
+    vector<T> beta_(C[0]->tensors.size(), beta);
+
+    for (auto& op : ops)
+    {
+        vector<const CTFTensor<T>*> B_;
+        vector<CTFTensor<T>*> C_;
+        for (int k = 0;k < C.size();k++)
+        {
+            B_.push_back(B[k]->tensors[op.B].tensor);
+            C_.push_back(C[k]->tensors[op.C].tensor);
+        }
+
+        CTFTensor<T>::multMany(op.factor, conja, *A.tensors[op.A].tensor, op.idx_A,
+                                          conjb,                      B_, op.idx_B,
+                               beta_[op.C],                           C_, op.idx_C);
+
+        beta_[op.C] = 1.0;
+    }
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::apply(const BlockOp& op, bool conja, const CTFTensor<T>& A,
+                                                        bool conjb, const CTFTensor<T>* B,
+                                     T beta, CTFTensor<T>& C)
+{
+    if (B)
+    {
+        C.mult(op.factor, conja, A, op.idx_A,
+                          conjb, *B, op.idx_B,
+                     beta,           op.idx_C);
+    }
+    else
+    {
+        C.sum(op.factor, conja, A, op.idx_A,
+                   beta,           op.idx_C);
+    }
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::run(bool conja, const SymmetryBlockedTensor<T>& A,
+                                   bool conjb, const SymmetryBlockedTensor<T>* B,
+                                   T beta, const vector<BlockOp>& ops)
+{
+    if (!concurrent || ops.size() <= 1)
+    {
+        runSerial(conja, A, conjb, B, beta, ops);
+    }
+    else if (arena.size > 1)
+    {
+        runConcurrent(conja, A, conjb, B, beta, ops);
+    }
+    else if (&A != this && B != this)
+    {
+        runThreaded(conja, A, conjb, B, beta, ops);
+    }
+    else
+    {
+        runSerial(conja, A, conjb, B, beta, ops);
+    }
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::runSerial(bool conja, const SymmetryBlockedTensor<T>& A,
+                                         bool conjb, const SymmetryBlockedTensor<T>* B,
+                                         T beta, const vector<BlockOp>& ops)
+{
+    vector<T> beta_(tensors.size(), beta);
+
+    for (auto& op : ops)
+    {
+        apply(op, conja, *A.tensors[op.A].tensor,
+                  conjb, (B ? B->tensors[op.B].tensor : NULL),
+              beta_[op.C], *tensors[op.C].tensor);
+
+        beta_[op.C] = 1.0;
+    }
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::runThreaded(bool conja, const SymmetryBlockedTensor<T>& A,
+                                           bool conjb, const SymmetryBlockedTensor<T>* B,
+                                           T beta, const vector<BlockOp>& ops)
+{
+    map<int,vector<const BlockOp*>> byC;
+    for (auto& op : ops) byC[op.C].push_back(&op);
+
+    auto runBlock = [&](const vector<const BlockOp*>& block)
+    {
+        T beta_ = beta;
+        for (const BlockOp* op : block)
+        {
+            apply(*op, conja, *A.tensors[op->A].tensor,
+                       conjb, (B ? B->tensors[op->B].tensor : NULL),
+                  beta_, *tensors[op->C].tensor);
+            beta_ = 1.0;
+        }
+    };
+
+    /*
+     * Neither CTF nor the paging of out-of-core tensors may be used by
+     * several threads at once
+     */
+    vector<const vector<const BlockOp*>*> threaded;
+    for (auto& c : byC)
+    {
+        bool dense = tensors[c.first].tensor->isDense();
+        for (const BlockOp* op : c.second)
+        {
+            dense = dense && A.tensors[op->A].tensor->isDense() &&
+                    (!B || B->tensors[op->B].tensor->isDense());
+        }
+
+        if (dense) threaded.push_back(&c.second);
+        else runBlock(c.second);
+    }
+
+    #pragma omp parallel
+    #pragma omp single
+    for (auto block : threaded)
+    {
+        #pragma omp task firstprivate(block)
+        runBlock(*block);
+    }
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::runConcurrent(bool conja, const SymmetryBlockedTensor<T>& A,
+                                             bool conjb, const SymmetryBlockedTensor<T>* B,
+                                             T beta, const vector<BlockOp>& ops)
+{
+    /*
+     * Estimate the cost of each output block as the sum over its
+     * operations of the product of the lengths of all distinct indices
+     */
+    map<int,double> cost;
+    for (auto& op : ops)
+    {
+        map<char,int> lens;
+        const CTFTensor<T>& tA = *A.tensors[op.A].tensor;
+        const CTFTensor<T>& tC = *  tensors[op.C].tensor;
+        for (int i = 0;i < tA.getDimension();i++) lens[op.idx_A[i]] = tA.getLengths()[i];
+        for (int i = 0;i < tC.getDimension();i++) lens[op.idx_C[i]] = tC.getLengths()[i];
+        if (B)
+        {
+            const CTFTensor<T>& tB = *B->tensors[op.B].tensor;
+            for (int i = 0;i < tB.getDimension();i++) lens[op.idx_B[i]] = tB.getLengths()[i];
+        }
+
+        double c = 1;
+        for (auto& l : lens) c *= l.second;
+        cost[op.C] += c;
+    }
+
+    /*
+     * Assign blocks to groups greedily, most expensive first
+     */
+    int ngroup = min((int)cost.size(), arena.size);
+
+    vector<pair<double,int>> order;
+    for (auto& c : cost) order.emplace_back(c.second, c.first);
+    sort(order.begin(), order.end(), std::greater<pair<double,int>>());
+
+    vector<double> load(ngroup, 0.0);
+    map<int,int> owner;
+    for (auto& o : order)
+    {
+        int g = min_element(load.begin(), load.end())-load.begin();
+        load[g] += o.first;
+        owner[o.second] = g;
+    }
+
+    /*
+     * Give each group at least one process and share out the rest in
+     * proportion to the load
+     */
+    double total = aquarius::sum(load);
+    int left = arena.size-ngroup;
+
+    vector<int> sizes(ngroup, 1);
+    vector<pair<double,int>> remainder;
+    for (int g = 0;g < ngroup;g++)
+    {
+        double share = (total > 0 ? left*load[g]/total : (double)left/ngroup);
+        sizes[g] += (int)share;
+        remainder.emplace_back(share-(int)share, g);
+    }
+    sort(remainder.begin(), remainder.end(), std::greater<pair<double,int>>());
+    for (int i = 0, n = aquarius::sum(sizes);n < arena.size;i++, n++) sizes[remainder[i].second]++;
+
+    Arena sub = arena.split(sizes);
+
+    int mygroup = 0;
+    for (int first = 0;first+sizes[mygroup] <= arena.rank;first += sizes[mygroup++]);
+
+    /*
+     * Copy the blocks each group needs onto its sub-arena. A block needed by
+     * several groups is read from the full arena once, with each process
+     * asking for the elements of its own group's copy. Every process takes
+     * part in every copy, so the order must be the same everywhere.
+     */
+    map<int,set<int>> groups_A, groups_B, groups_C;
+    for (auto& op : ops)
+    {
+        groups_A[op.A].insert(owner[op.C]);
+        if (B) groups_B[op.B].insert(owner[op.C]);
+        groups_C[op.C].insert(owner[op.C]);
+    }
+
+    map<int,unique_ptr<CTFTensor<T>>> sub_A, sub_B, sub_C;
+
+    auto copyIn = [&](const CTFTensor<T>& block, map<int,unique_ptr<CTFTensor<T>>>& blocks,
+                      int which, const set<int>& groups, bool copy)
+    {
+        CTFTensor<T>* local = NULL;
+        if (groups.count(mygroup))
+        {
+            local = new CTFTensor<T>(block.name, sub, block.getDimension(),
+                                     block.getLengths(), block.getSymmetry(), true);
+            blocks[which].reset(local);
+        }
+
+        if (copy) block.copyTo(local);
+    };
+
+    for (auto& g : groups_A) copyIn(*A.tensors[g.first].tensor, sub_A, g.first, g.second, true);
+    for (auto& g : groups_B) copyIn(*B->tensors[g.first].tensor, sub_B, g.first, g.second, true);
+    for (auto& g : groups_C) copyIn(*  tensors[g.first].tensor, sub_C, g.first, g.second, beta != (T)0);
+
+    vector<T> beta_(tensors.size(), beta);
+
+    for (auto& op : ops)
+    {
+        if (owner[op.C] != mygroup) continue;
+
+        apply(op, conja, *sub_A[op.A],
+                  conjb, (B ? sub_B[op.B].get() : NULL),
+              beta_[op.C], *sub_C[op.C]);
+
+        beta_[op.C] = 1.0;
+    }
+
+    for (auto& o : owner)
+    {
+        tensors[o.first].tensor->copyFrom(o.second == mygroup ? sub_C[o.first].get() : NULL);
+    }
+}
+
+template <class T>
+vector<typename SymmetryBlockedTensor<T>::BlockOp>
+SymmetryBlockedTensor<T>::sumOps(T alpha, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                                                             const string& idx_B) const
 {
     assert(group == A.group);
 
@@ -1176,7 +1504,7 @@ void SymmetryBlockedTensor<T>::sum(T alpha, bool conja, const SymmetryBlockedTen
     stride_A.resize(m);
     stride_B.resize(m);
 
-    vector<T> beta_(tensors.size(), beta);
+    vector<BlockOp> ops;
 
     int off_A = 0;
     int off_B = 0;
@@ -1191,11 +1519,10 @@ void SymmetryBlockedTensor<T>::sum(T alpha, bool conja, const SymmetryBlockedTen
             for (int i = 0;i < A.ndim;i++) idx_A__[i] = idx_A_[A.reorder[off_A][i]];
             for (int i = 0;i <   ndim;i++) idx_B__[i] = idx_B_[  reorder[off_B][i]];
 
-            int off_B_ = (tensors[off_B].isAlloced ? off_B : tensors[off_B].ref);
+            int off_A_ = (A.tensors[off_A].isAlloced ? off_A : A.tensors[off_A].ref);
+            int off_B_ = (  tensors[off_B].isAlloced ? off_B :   tensors[off_B].ref);
             assert(off_B_ >= 0 && off_B_ < tensors.size());
-            tensors[off_B].tensor->sum(   alpha*f*f3, conja, *A.tensors[off_A].tensor, idx_A__,
-                                       beta_[off_B_],                                  idx_B__);
-            beta_[off_B_] = 1.0;
+            ops.push_back(BlockOp{off_B_, off_A_, -1, (T)(alpha*f*f3), idx_A__, "", idx_B__});
         }
 
         for (int i = 0;i < m;i++)
@@ -1220,6 +1547,15 @@ void SymmetryBlockedTensor<T>::sum(T alpha, bool conja, const SymmetryBlockedTen
 
         if (m == 0) done = true;
     }
+
+    return ops;
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::sum(T alpha, bool conja, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                   T  beta,                                                const string& idx_B)
+{
+    run(conja, A, false, NULL, beta, sumOps(alpha, A, idx_A, idx_B));
 }
 
 template <class T>
@@ -1279,6 +1615,20 @@ T SymmetryBlockedTensor<T>::dot(bool conja, const SymmetryBlockedTensor<T>& A, c
 template <class T>
 void SymmetryBlockedTensor<T>::weight(const vector<const vector<vector<T>>*>& d,
                                       double shift)
+{
+    weight(d, shift, NULL);
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::weightAndAdd(const vector<const vector<vector<T>>*>& d,
+                                            SymmetryBlockedTensor<T>& B, double shift)
+{
+    weight(d, shift, &B);
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::weight(const vector<const vector<vector<T>>*>& d,
+                                      double shift, SymmetryBlockedTensor<T>* sum)
 {
     int n = group.getNumIrreps();
 
@@ -1293,7 +1643,16 @@ void SymmetryBlockedTensor<T>::weight(const vector<const vector<vector<T>>*>& d,
         if (tensors[off_A] != NULL && tensors[off_A].isAlloced)
         {
             for (int i = 0;i < this->ndim;i++) dsub[i] = &((*d[i])[iA[i]]);
-            tensors[off_A].tensor->weight(dsub, shift);
+
+            if (sum)
+            {
+                assert(sum->tensors[off_A] != NULL && sum->tensors[off_A].isAlloced);
+                tensors[off_A].tensor->weightAndAdd(dsub, *sum->tensors[off_A].tensor, shift);
+            }
+            else
+            {
+                tensors[off_A].tensor->weight(dsub, shift);
+            }
         }
 
         for (int i = 0;i < this->ndim;i++)
@@ -1317,6 +1676,77 @@ void SymmetryBlockedTensor<T>::weight(const vector<const vector<vector<T>>*>& d,
     }
 }
 
+template <class T>
+double SymmetryBlockedTensor<T>::blockFactor(int off) const
+{
+    double factor = 1;
+    const vector<int>& subsym = tensors[off].tensor->getSymmetry();
+    for (int i = 0;i < ndim;)
+    {
+        int j; for (j = i;sym[j] != NS;j++); j++;
+
+        int m = j-i;
+        for (int k = i;k < j;)
+        {
+            int l; for (l = k;subsym[l] != NS;l++); l++;
+            int o = l-k;
+            factor *= binom(m,o);
+            m -= o;
+            k = l;
+        }
+
+        i = j;
+    }
+
+    return factor;
+}
+
+/*
+ * Only the allocated blocks are visited, each standing in for blockFactor
+ * blocks of the full tensor. Tensors with a different block structure are
+ * contracted in full and counted on only one process.
+ */
+template <class T>
+void SymmetryBlockedTensor<T>::localDots(bool conja, const vector<const SymmetryBlockedTensor<T>*>& A,
+                                         bool conjb, vector<T>& scalars) const
+{
+    vector<int> which;
+    for (int k = 0;k < A.size();k++)
+    {
+        bool same = &A[k]->group == &group && A[k]->len == len && A[k]->sym == sym &&
+                    A[k]->tensors.size() == tensors.size();
+
+        for (int off = 0;same && off < tensors.size();off++)
+        {
+            same = A[k]->tensors[off].isAlloced == tensors[off].isAlloced;
+        }
+
+        if (same)
+        {
+            which.push_back(k);
+        }
+        else
+        {
+            T val = dot(conja, *A[k], this->implicit(), conjb, this->implicit());
+            if (this->arena.rank == 0) scalars[k] += val;
+        }
+    }
+
+    for (int off = 0;off < tensors.size();off++)
+    {
+        if (tensors[off] == NULL || !tensors[off].isAlloced) continue;
+
+        vector<const CTFTensor<T>*> A_off;
+        for (int k : which) A_off.push_back(A[k]->tensors[off].tensor);
+
+        vector<T> sub(A_off.size(), (T)0);
+        tensors[off].tensor->localDots(conja, A_off, conjb, sub);
+
+        double factor = blockFactor(off);
+        for (int k = 0;k < which.size();k++) scalars[which[k]] += (T)factor*sub[k];
+    }
+}
+
 template <class T>
 real_type_t<T> SymmetryBlockedTensor<T>::norm(int p) const
 {
@@ -1334,25 +1764,7 @@ real_type_t<T> SymmetryBlockedTensor<T>::norm(int p) const
     {
         if (tensors[off_A] != NULL && tensors[off_A].isAlloced)
         {
-            double factor = 1;
-            const vector<int>& subsym = tensors[off_A].tensor->getSymmetry();
-            for (int i = 0;i < ndim;)
-            {
-                int j; for (j = i;sym[j] != NS;j++); j++;
-
-                int m = j-i;
-                for (int k = i;k < j;)
-                {
-                    int l; for (l = k;subsym[l] != NS;l++); l++;
-                    int o = l-k;
-                    factor *= binom(m,o);
-                    m -= o;
-                    k = l;
-                }
-
-                i = j;
-            }
-
+            double factor = blockFactor(off_A);
             real_type_t<T> subnrm = tensors[off_A].tensor->norm(p);
 
             if (p == 2)
@@ -1397,9 +1809,21 @@ real_type_t<T> SymmetryBlockedTensor<T>::norm(int p) const
 template<class T>
 map<const tCTF_World<T>*,map<const PointGroup*,pair<int,SymmetryBlockedTensor<T>*>>> SymmetryBlockedTensor<T>::scalars;
 
+template<class T>
+bool SymmetryBlockedTensor<T>::concurrent = false;
+
+template <typename T>
+recursive_mutex& SymmetryBlockedTensor<T>::scalarsMutex()
+{
+    static recursive_mutex m;
+    return m;
+}
+
 template <typename T>
 void SymmetryBlockedTensor<T>::register_scalar()
 {
+    lock_guard<recursive_mutex> lock(scalarsMutex());
+
     if (scalars.find(&arena.ctf<T>()) == scalars.end() ||
         scalars[&arena.ctf<T>()].find(&group) == scalars[&arena.ctf<T>()].end())
     {
@@ -1418,6 +1842,8 @@ void SymmetryBlockedTensor<T>::register_scalar()
 template <typename T>
 void SymmetryBlockedTensor<T>::unregister_scalar()
 {
+    lock_guard<recursive_mutex> lock(scalarsMutex());
+
     /*
      * The last tensor (besides the scalar in scalars)
      * will delete the entry, so if it does not exist
@@ -1442,10 +1868,11 @@ void SymmetryBlockedTensor<T>::unregister_scalar()
 template <typename T>
 SymmetryBlockedTensor<T>& SymmetryBlockedTensor<T>::scalar() const
 {
+    lock_guard<recursive_mutex> lock(scalarsMutex());
     return *scalars[&arena.ctf<T>()][&group].second;
 }
 
-INSTANTIATE_SPECIALIZATIONS(SymmetryBlockedTensor);
+INSTANTIATE_ALL_SPECIALIZATIONS(SymmetryBlockedTensor);
 
 }
 }
@@ -28,6 +28,24 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
         vector<double> factor;
         vector<vector<int>> reorder;
         static map<const tCTF_World<T>*,map<const symmetry::PointGroup*,pair<int,SymmetryBlockedTensor<T>*>>> scalars;
+        static bool concurrent;
+
+        /*
+         * Guards scalars, which tensors created on other threads also use
+         */
+        static recursive_mutex& scalarsMutex();
+
+        /*
+         * A single block contraction C[idx_C] = factor*A[idx_A]*B[idx_B], or
+         * sum C[idx_C] = factor*A[idx_A] if B is -1 (+ beta*C[idx_C] the
+         * first time block C is written)
+         */
+        struct BlockOp
+        {
+            int C, A, B;
+            T factor;
+            string idx_A, idx_B, idx_C;
+        };
 
         static vector<int> getStrides(const string& indices, int ndim,
                                       int len, const string& idx_A);
@@ -40,7 +58,74 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
 
         SymmetryBlockedTensor<T>& scalar() const;
 
+        void weight(const vector<const vector<vector<T>>*>& d,
+                    double shift, SymmetryBlockedTensor<T>* sum);
+
+        /*
+         * The number of blocks (including this one) related to the
+         * allocated block off by permutation of symmetric indices
+         */
+        double blockFactor(int off) const;
+
+        /*
+         * The block contractions making up C[idx_C] = alpha*A[idx_A]*B[idx_B]
+         * with this tensor as C
+         */
+        vector<BlockOp> blockOps(T alpha, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                          const SymmetryBlockedTensor<T>& B, const string& idx_B,
+                                                                             const string& idx_C) const;
+
+        /*
+         * The block sums making up B[idx_B] = alpha*A[idx_A] with this
+         * tensor as B
+         */
+        vector<BlockOp> sumOps(T alpha, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                                                           const string& idx_B) const;
+
+        static void apply(const BlockOp& op, bool conja, const CTFTensor<T>& A,
+                                             bool conjb, const CTFTensor<T>* B,
+                          T beta, CTFTensor<T>& C);
+
+        /*
+         * Perform the block operations (contractions, or sums if B is NULL)
+         * in the way chosen by setConcurrent
+         */
+        void run(bool conja, const SymmetryBlockedTensor<T>& A,
+                 bool conjb, const SymmetryBlockedTensor<T>* B,
+                 T beta, const vector<BlockOp>& ops);
+
+        void runSerial(bool conja, const SymmetryBlockedTensor<T>& A,
+                       bool conjb, const SymmetryBlockedTensor<T>* B,
+                       T beta, const vector<BlockOp>& ops);
+
+        /*
+         * Partition the output blocks among groups of processes, balancing
+         * the estimated cost of each group, and perform the operations
+         * for different groups simultaneously. Blocks are redistributed to
+         * and from the sub-arenas as needed.
+         */
+        void runConcurrent(bool conja, const SymmetryBlockedTensor<T>& A,
+                           bool conjb, const SymmetryBlockedTensor<T>* B,
+                           T beta, const vector<BlockOp>& ops);
+
+        /*
+         * On a single process, perform the operations into each output
+         * block as a separate OpenMP task. Output blocks which involve a
+         * block that is not dense (see CTFTensor::isDense) are done first,
+         * by the calling thread.
+         */
+        void runThreaded(bool conja, const SymmetryBlockedTensor<T>& A,
+                         bool conjb, const SymmetryBlockedTensor<T>* B,
+                         T beta, const vector<BlockOp>& ops);
+
     public:
+        /*
+         * Execute the contractions and sums between independent symmetry
+         * blocks concurrently, on subsets of the processes or, on a single
+         * process, on separate threads, rather than one after another.
+         */
+        static void setConcurrent(bool c) { concurrent = c; }
+
         CTFTensor<T>& operator()(const vector<int>& irreps);
 
         const CTFTensor<T>& operator()(const vector<int>& irreps) const;
@@ -71,12 +156,23 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
 
         const symmetry::PointGroup& getGroup() const { return group; }
 
+        const symmetry::Representation& getRepresentation() const { return rep; }
+
         const vector<vector<int>>& getLengths() const { return len; }
 
         const vector<int>& getSymmetry() const { return sym; }
 
         bool exists(const vector<int>& irreps) const;
 
+        /*
+         * Keep each block on disk or in single precision whenever it is not
+         * in use (see CTFTensor::setStorage). Copies are kept the same way
+         * as the original.
+         */
+        void setStorage(Storage storage);
+
+        Storage getStorage() const;
+
         T* getRawData(const vector<int>& irreps, int64_t& size)
         {
             return (*this)(irreps).getRawData(size);
@@ -143,6 +239,28 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
             (*this)(irreps).getAllData(rank);
         }
 
+        /*
+         * Every process receives all of the packed elements of each of the
+         * given blocks, with one collective for all of them
+         */
+        void getAllData(const vector<vector<int>>& irreps, vector<vector<T>>& vals) const
+        {
+            vector<const CTFTensor<T>*> blocks;
+            for (auto& irrep : irreps) blocks.push_back(&(*this)(irrep));
+            CTFTensor<T>::getAllData(blocks, vals);
+        }
+
+        /*
+         * Sum the packed elements of each of the given blocks over all
+         * processes and write the result, with one collective for all of them
+         */
+        void sumAllData(const vector<vector<int>>& irreps, const vector<vector<T>>& vals)
+        {
+            vector<CTFTensor<T>*> blocks;
+            for (auto& irrep : irreps) blocks.push_back(&(*this)(irrep));
+            CTFTensor<T>::sumAllData(blocks, vals);
+        }
+
         void slice(T alpha, bool conja, const SymmetryBlockedTensor<T>& A,
                    const vector<vector<int>>& start_A, T beta);
 
@@ -158,6 +276,16 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
                                    bool conjb, const SymmetryBlockedTensor<T>& B, const string& idx_B,
                           T beta,                                                 const string& idx_C);
 
+        /*
+         * C[k][idx_C] = alpha*A[idx_A]*B[k][idx_B] + beta*C[k][idx_C] for all
+         * k, with each block of A contracted once against all of the B[k]
+         */
+        static void multMany(T alpha, bool conja, const SymmetryBlockedTensor<T>& A, const string& idx_A,
+                                      bool conjb, const vector<const SymmetryBlockedTensor<T>*>& B,
+                                                                                         const string& idx_B,
+                             T  beta,             const vector<SymmetryBlockedTensor<T>*>& C,
+                                                                                         const string& idx_C);
+
         virtual void sum(T alpha, bool conja, const SymmetryBlockedTensor<T>& A, const string& idx_A,
                          T beta,                                                 const string& idx_B);
 
@@ -169,6 +297,15 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
         void weight(const vector<const vector<vector<T>>*>& d,
                     double shift = 0);
 
+        /*
+         * Weight this tensor and add the result to B in the same pass
+         */
+        void weightAndAdd(const vector<const vector<vector<T>>*>& d,
+                          SymmetryBlockedTensor<T>& B, double shift = 0);
+
+        void localDots(bool conja, const vector<const SymmetryBlockedTensor<T>*>& A, bool conjb,
+                       vector<T>& scalars) const;
+
         real_type_t<T> norm(int p) const;
 };
 
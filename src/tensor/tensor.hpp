@@ -26,6 +26,13 @@ class SymmetryMismatchError;
 class InvalidSymmetryError;
 class InvalidStartError;
 
+/*
+ * Where the elements of a tensor are kept while it is not in use: in
+ * memory, on disk, or in memory in single precision (in which case they are
+ * converted back to full precision whenever the tensor is used)
+ */
+enum Storage {IN_CORE, ON_DISK, SINGLE_PRECISION};
+
 #define INHERIT_FROM_TENSOR(Derived,T) \
     public: \
         using aquarius::tensor::Tensor< Derived,T >::getDerived; \
@@ -358,6 +365,26 @@ class Tensor
          * scalar = A*this
          */
         virtual T dot(bool conja, const Derived& A, bool conjb) const = 0;
+
+        /*
+         * scalars[i] += A[i]*this, summed over the data held by this process
+         * only, so that many inner products can share a single reduction
+         * (see dots)
+         */
+        virtual void localDots(bool conja, const vector<const Derived*>& A, bool conjb,
+                               vector<T>& scalars) const = 0;
+
+        /*
+         * scalars[i] = A[i]*this, with one reduction over processes for all
+         * of the inner products
+         */
+        vector<T> dots(bool conja, const vector<const Derived*>& A, bool conjb) const
+        {
+            vector<T> scalars(A.size(), (T)0);
+            localDots(conja, A, conjb, scalars);
+            getDerived().arena.comm().Allreduce(scalars.data(), scalars.size(), MPI_SUM);
+            return scalars;
+        }
 };
 
 template <class Derived, typename T>
@@ -0,0 +1,307 @@
+#include "ledger.hpp"
+
+#include "task/task.hpp"
+
+using namespace aquarius::task;
+
+namespace aquarius
+{
+namespace time
+{
+
+string LedgerEntry::expression() const
+{
+    string expr = names[0] + "[" + indices[0] + "] = ";
+
+    for (int i = 1;i < names.size();i++)
+    {
+        if (i > 1) expr += "*";
+        expr += names[i] + "[" + indices[i] + "]";
+    }
+
+    return expr;
+}
+
+map<string,Ledger::Site>& Ledger::sites()
+{
+    static map<string,Site> sites_;
+    return sites_;
+}
+
+map<pair<string,int>,Ledger::Totals>& Ledger::iterations()
+{
+    static map<pair<string,int>,Totals> iterations_;
+    return iterations_;
+}
+
+deque<LedgerEntry>& Ledger::trace()
+{
+    static deque<LedgerEntry> trace_;
+    return trace_;
+}
+
+string& Ledger::task()
+{
+    static string task_;
+    return task_;
+}
+
+int& Ledger::iteration()
+{
+    static int iteration_ = 0;
+    return iteration_;
+}
+
+mutex& Ledger::mutex_()
+{
+    static mutex m;
+    return m;
+}
+
+void Ledger::setIteration(const string& task, int iter)
+{
+    lock_guard<mutex> lock(mutex_());
+    Ledger::task() = task;
+    iteration() = iter;
+}
+
+void Ledger::add(LedgerEntry&& entry)
+{
+    lock_guard<mutex> lock(mutex_());
+
+    Site& s = sites()[entry.site + ": " + entry.expression()];
+    if (s.count == 0) s.example = entry;
+    s.add(entry);
+
+    if (entry.iteration > 0)
+    {
+        iterations()[make_pair(entry.task, entry.iteration)].add(entry);
+    }
+
+    if (trace().size() == MAX_TRACE_EVENTS) trace().pop_front();
+    trace().push_back(move(entry));
+}
+
+void Ledger::clear()
+{
+    lock_guard<mutex> lock(mutex_());
+    sites().clear();
+    iterations().clear();
+    trace().clear();
+}
+
+void Ledger::printReport(const Arena& arena)
+{
+    /*
+     * Take a copy so that the ledger is not locked during communication
+     */
+    map<string,Site> sites;
+    map<string,Totals> iterations;
+    {
+        lock_guard<mutex> lock(mutex_());
+        sites = Ledger::sites();
+        for (auto& it : Ledger::iterations())
+        {
+            iterations[str("%s iteration %5d", it.first.first.c_str(), it.first.second)] = it.second;
+        }
+    }
+
+    set<string> local;
+    for (auto& s : sites) local.insert(s.first);
+    set<string> keys = gatherKeys(arena, local);
+
+    int nkey = keys.size();
+    vector<double> seconds(nkey);
+    vector<int64_t> flops(nkey), counts(nkey);
+
+    int i = 0;
+    for (auto& key : keys)
+    {
+        auto it = sites.find(key);
+        if (it != sites.end())
+        {
+            seconds[i] = it->second.seconds;
+            flops[i] = it->second.flops;
+            counts[i] = it->second.count;
+        }
+        i++;
+    }
+
+    arena.comm().Allreduce(seconds, MPI_MAX);
+    arena.comm().Allreduce(flops, MPI_SUM);
+    arena.comm().Allreduce(counts, MPI_MAX);
+
+    vector<pair<double,int>> order;
+    double total = 0;
+    for (int i = 0;i < nkey;i++)
+    {
+        order.emplace_back(seconds[i], i);
+        total += seconds[i];
+    }
+    sort(order.begin(), order.end(),
+         [](const pair<double,int>& a, const pair<double,int>& b) { return a.first > b.first; });
+
+    vector<string> names(keys.begin(), keys.end());
+
+    Logger::log(arena) << "Tensor operations by call site:" << endl;
+    Logger::log(arena) << printos("%13s %7s %10s %11s  %s\n", "time (s)", "%", "calls",
+                                  "gflops/sec", "site") << endl;
+
+    for (auto& o : order)
+    {
+        int k = o.second;
+        double gflops = (seconds[k] > 0 ? (double)flops[k]/1e9/seconds[k] : 0.0);
+
+        Logger::log(arena) << printos("%13.6f %7.3f %10ld %11.6f  %s\n", seconds[k],
+                                      (total > 0 ? 100*seconds[k]/total : 0.0),
+                                      counts[k], gflops, names[k].c_str()) << endl;
+
+        auto it = sites.find(names[k]);
+        if (it != sites.end())
+        {
+            const LedgerEntry& e = it->second.example;
+
+            string shape;
+            for (int j = 0;j < e.names.size();j++)
+            {
+                shape += (j == 0 ? "" : ", ") + e.names[j] + " ";
+                for (int d = 0;d < e.lens[j].size();d++)
+                {
+                    shape += (d == 0 ? "" : "x") + str(e.lens[j][d]);
+                }
+                shape += " (";
+                for (int d = 0;d < e.syms[j].size();d++)
+                {
+                    static const char* symnames[] = {"NS", "SY", "AS", "SH"};
+                    shape += string(d == 0 ? "" : ",") + symnames[e.syms[j][d]];
+                }
+                shape += ")";
+            }
+
+            Logger::log(arena) << printos("%13s %7s %10s %11s    %s\n", "", "", "", "",
+                                          shape.c_str()) << endl;
+        }
+    }
+
+    /*
+     * Tasks may run concurrently on different processes, so take the union
+     * of the iterations as for the call sites
+     */
+    local.clear();
+    for (auto& it : iterations) local.insert(it.first);
+    keys = gatherKeys(arena, local);
+
+    if (!keys.empty())
+    {
+        nkey = keys.size();
+        seconds.assign(nkey, 0.0);
+        flops.assign(nkey, 0);
+        counts.assign(nkey, 0);
+
+        i = 0;
+        for (auto& key : keys)
+        {
+            auto it = iterations.find(key);
+            if (it != iterations.end())
+            {
+                seconds[i] = it->second.seconds;
+                flops[i] = it->second.flops;
+                counts[i] = it->second.count;
+            }
+            i++;
+        }
+
+        arena.comm().Allreduce(seconds, MPI_MAX);
+        arena.comm().Allreduce(flops, MPI_SUM);
+        arena.comm().Allreduce(counts, MPI_MAX);
+
+        Logger::log(arena) << "Tensor operations by iteration:" << endl;
+
+        i = 0;
+        for (auto& key : keys)
+        {
+            Logger::log(arena) << printos("%s: %13.6f s %10ld ops %11.6f gflops/sec\n",
+                                          key.c_str(), seconds[i], counts[i],
+                                          (seconds[i] > 0 ? (double)flops[i]/1e9/seconds[i] : 0.0)) << endl;
+            i++;
+        }
+    }
+}
+
+static string escape(const string& s)
+{
+    string e;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') e += '\\';
+        e += c;
+    }
+    return e;
+}
+
+void Ledger::writeTrace(const string& file, const Arena& arena)
+{
+    if (arena.rank != 0) return;
+
+    lock_guard<mutex> lock(mutex_());
+
+    ofstream ofs(file);
+
+    double t0 = (trace().empty() ? 0.0 : trace().front().start);
+
+    ofs << "{\"traceEvents\":[" << endl;
+
+    for (int i = 0;i < trace().size();i++)
+    {
+        const LedgerEntry& e = trace()[i];
+
+        ofs << (i == 0 ? "" : ",\n");
+        ofs << "{\"name\":\"" << escape(e.expression()) << "\","
+            << "\"cat\":\"" << e.op << "\","
+            << "\"ph\":\"X\","
+            << "\"ts\":" << fixed << setprecision(3) << (e.start-t0)*1e6 << ","
+            << "\"dur\":" << e.seconds*1e6 << ","
+            << "\"pid\":0,\"tid\":0,"
+            << "\"args\":{\"site\":\"" << escape(e.site) << "\","
+            << "\"task\":\"" << escape(e.task) << "\","
+            << "\"iteration\":" << e.iteration << ","
+            << "\"flops\":" << e.flops << "}}";
+    }
+
+    ofs << endl << "]}" << endl;
+}
+
+LedgerScope::LedgerScope(const string& op,
+                         const vector<string>& names,
+                         const vector<string>& indices,
+                         const vector<vector<int>>& lens,
+                         const vector<vector<int>>& syms)
+{
+    entry.op = op;
+    entry.site = ProfileSection::currentPath();
+    entry.names = names;
+    entry.indices = indices;
+    entry.lens = lens;
+    entry.syms = syms;
+    {
+        lock_guard<mutex> lock(Ledger::mutex_());
+        entry.task = Ledger::task();
+        entry.iteration = Ledger::iteration();
+    }
+    entry.start = Interval::time().seconds();
+
+    timer.start();
+}
+
+LedgerScope::~LedgerScope()
+{
+    timer.stop();
+
+    entry.seconds = timer.seconds();
+    entry.flops = timer.flops;
+
+    Ledger::add(move(entry));
+}
+
+}
+}
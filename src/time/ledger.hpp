@@ -0,0 +1,125 @@
+#ifndef _AQUARIUS_TIME_LEDGER_HPP_
+#define _AQUARIUS_TIME_LEDGER_HPP_
+
+#include "util/global.hpp"
+
+#include "time.hpp"
+
+namespace aquarius
+{
+namespace time
+{
+
+/*
+ * Record of a single tensor operation. The output tensor comes first in
+ * names, indices, lens and syms, followed by the operands.
+ */
+struct LedgerEntry
+{
+    string op;
+    string site;
+    vector<string> names;
+    vector<string> indices;
+    vector<vector<int>> lens;
+    vector<vector<int>> syms;
+    string task;
+    int iteration;
+    double start;
+    double seconds;
+    int64_t flops;
+
+    string expression() const;
+};
+
+/*
+ * Collects the cost of every tensor contraction and summation so that the
+ * cost of individual terms can be examined after the run. Operations are
+ * aggregated by call site, which is the enclosing ProfileSection path
+ * together with the tensors and indices involved, and by task and solver
+ * iteration. Only the most recent operations are kept individually, for the
+ * trace.
+ */
+class Ledger
+{
+    friend class LedgerScope;
+
+    protected:
+        struct Totals
+        {
+            double seconds = 0;
+            int64_t flops = 0;
+            int64_t count = 0;
+
+            void add(const LedgerEntry& e)
+            {
+                seconds += e.seconds;
+                flops += e.flops;
+                count++;
+            }
+        };
+
+        struct Site : Totals
+        {
+            LedgerEntry example;
+        };
+
+        /*
+         * All of the below may only be used while holding mutex_()
+         */
+        static map<string,Site>& sites();
+
+        static map<pair<string,int>,Totals>& iterations();
+
+        static deque<LedgerEntry>& trace();
+
+        static string& task();
+
+        static int& iteration();
+
+        static mutex& mutex_();
+
+        static void add(LedgerEntry&& entry);
+
+    public:
+        static const int MAX_TRACE_EVENTS = 65536;
+
+        static void setIteration(const string& task, int iter);
+
+        /*
+         * Print the call sites sorted by total time (maximum over processes)
+         * followed by the time spent in each solver iteration of each task.
+         */
+        static void printReport(const Arena& arena);
+
+        /*
+         * Write the last MAX_TRACE_EVENTS operations performed on the root
+         * process as a trace which can be loaded in chrome://tracing.
+         */
+        static void writeTrace(const string& file, const Arena& arena);
+
+        static void clear();
+};
+
+/*
+ * Times one operation and adds it to the ledger when it goes out of scope.
+ */
+class LedgerScope
+{
+    protected:
+        LedgerEntry entry;
+        Timer timer;
+
+    public:
+        LedgerScope(const string& op,
+                    const vector<string>& names,
+                    const vector<string>& indices,
+                    const vector<vector<int>>& lens,
+                    const vector<vector<int>>& syms);
+
+        ~LedgerScope();
+};
+
+}
+}
+
+#endif
@@ -161,47 +161,195 @@ double Interval::gflops(const Arena& arena) const
     return (double)fl/1e9/seconds(arena);
 }
 
-vector<Timer> Timer::timers;
+ProfileNode& ProfileNode::child(const string& name)
+{
+    auto it = children.find(name);
+    if (it != children.end()) return *it->second;
+
+    ProfileNode* node = new ProfileNode(name, this);
+    children[name].reset(node);
+    return *node;
+}
 
-Timer& Timer::timer(const string& name)
+void ProfileNode::flatten(const string& path, map<string,Totals>& totals) const
 {
-    for (vector<Timer>::iterator it = timers.begin();it != timers.end();++it)
+    for (auto& c : children)
+    {
+        string p = path + "/" + c.first;
+
+        Totals& t = totals[p];
+        t.dt += c.second->dt;
+        t.flops += c.second->flops;
+        t.count += c.second->count;
+
+        c.second->flatten(p, totals);
+    }
+}
+
+void ProfileNode::clear()
+{
+    dt = 0;
+    flops = 0;
+    count = 0;
+
+    for (auto& c : children) c.second->clear();
+}
+
+ProfileNode*& ProfileNode::current()
+{
+    static thread_local ProfileNode* cur = NULL;
+
+    if (cur == NULL)
     {
-        if (it->name == name) return *it;
+        cur = new ProfileNode("", NULL);
+        lock_guard<mutex> lock(rootsMutex());
+        roots().emplace_back(cur);
     }
 
-    timers.push_back(Timer(name));
-    return timers.back();
+    return cur;
+}
+
+vector<unique_ptr<ProfileNode>>& ProfileNode::roots()
+{
+    static vector<unique_ptr<ProfileNode>> roots_;
+    return roots_;
+}
+
+mutex& ProfileNode::rootsMutex()
+{
+    static mutex m;
+    return m;
+}
+
+ProfileSection::ProfileSection(const string& name)
+: running(true)
+{
+    ProfileNode*& cur = ProfileNode::current();
+
+    node = &cur->child(name);
+    cur = node;
+
+    timer.start();
+}
+
+void ProfileSection::stop()
+{
+    if (!running) return;
+    running = false;
+
+    timer.stop();
+
+    node->dt += timer.seconds();
+    node->flops += timer.flops;
+    node->count++;
+
+    ProfileNode::current() = node->parent;
+}
+
+string ProfileSection::currentPath()
+{
+    string path;
+    for (ProfileNode* node = ProfileNode::current();node && node->parent;node = node->parent)
+    {
+        path = "/" + node->name + path;
+    }
+
+    return path;
+}
+
+set<string> gatherKeys(const Arena& arena, const set<string>& keys)
+{
+    string local;
+    for (auto& key : keys) local += key + '\n';
+
+    vector<MPI_Int> lens(arena.size);
+    lens[arena.rank] = local.size();
+    arena.comm().Allgather(lens);
+
+    vector<MPI_Int> displs(arena.size, 0);
+    for (int i = 1;i < arena.size;i++) displs[i] = displs[i-1]+lens[i-1];
+
+    vector<char> all(displs.back()+lens.back());
+    copy(local.begin(), local.end(), all.begin()+displs[arena.rank]);
+    arena.comm().Allgather(all, lens, displs);
+
+    set<string> keys_all;
+    istringstream iss(string(all.begin(), all.end()));
+    for (string key;getline(iss, key);) keys_all.insert(key);
+
+    return keys_all;
 }
 
 void Timer::printTimers(const Arena& arena)
 {
+    /*
+     * Merge the trees of all threads, keyed by the path from the root
+     */
+    map<string,ProfileNode::Totals> nodes;
+    {
+        lock_guard<mutex> lock(ProfileNode::rootsMutex());
+        for (auto& root : ProfileNode::roots()) root->flatten("", nodes);
+    }
+
+    /*
+     * Not every process necessarily entered the same sections, so take the
+     * union of the paths over all processes
+     */
+    set<string> local;
+    for (auto& n : nodes) local.insert(n.first);
+    set<string> paths = gatherKeys(arena, local);
+
+    int npath = paths.size();
+    vector<double> tmin(npath), tavg(npath), tmax(npath);
+    vector<int64_t> counts(npath), flops(npath);
+
+    int i = 0;
+    for (auto& path : paths)
+    {
+        auto it = nodes.find(path);
+        double dt = (it == nodes.end() ? 0.0 : it->second.dt);
+        tmin[i] = tavg[i] = tmax[i] = dt;
+        counts[i] = (it == nodes.end() ? 0 : it->second.count);
+        flops[i] = (it == nodes.end() ? 0 : it->second.flops);
+        i++;
+    }
+
+    arena.comm().Allreduce(tmin, MPI_MIN);
+    arena.comm().Allreduce(tavg, MPI_SUM);
+    arena.comm().Allreduce(tmax, MPI_MAX);
+    arena.comm().Allreduce(counts, MPI_SUM);
+    arena.comm().Allreduce(flops, MPI_SUM);
+
     int max_len = 0;
-    for (vector<Timer>::iterator it = timers.begin();it != timers.end();++it)
+    for (auto& path : paths)
     {
-        max_len = max(max_len, (int)it->name.size());
+        int depth = std::count(path.begin(), path.end(), '/');
+        int len = 2*(depth-1) + path.size()-path.rfind('/')-1;
+        max_len = max(max_len, len);
     }
 
-    sort(timers.begin(), timers.end());
+    Logger::log(arena) << printos("%-*s %13s %13s %13s %10s %11s\n", max_len+1, "",
+                                  "min (s)", "avg (s)", "max (s)", "calls", "gflops/sec") << endl;
 
-    for (vector<Timer>::iterator it = timers.begin();it != timers.end();++it)
+    i = 0;
+    for (auto& path : paths)
     {
-        double tot = it->seconds(arena);
-        int64_t count = it->count;
-        arena.comm().Allreduce(&count, 1, MPI_SUM);
-        double gflops = it->gflops(arena);
-        Logger::log(arena) << printos("%s:%*s %13.6f s %10ld x %11.6f gflops/sec\n", it->name.c_str(), (int)(max_len-it->name.size()), "", tot, count, gflops) << endl;
+        int depth = std::count(path.begin(), path.end(), '/');
+        string name = string(2*(depth-1), ' ') + path.substr(path.rfind('/')+1);
+        double gflops = (tmax[i] > 0 ? (double)flops[i]/1e9/tmax[i] : 0.0);
+
+        Logger::log(arena) << printos("%s:%*s %13.6f %13.6f %13.6f %10ld %11.6f\n",
+                                      name.c_str(), (int)(max_len-name.size()), "",
+                                      tmin[i], tavg[i]/arena.size, tmax[i],
+                                      counts[i], gflops) << endl;
+        i++;
     }
 }
 
 void Timer::clearTimers(const Arena& arena)
 {
-    for (vector<Timer>::iterator it = timers.begin();it != timers.end();++it)
-    {
-        it->dt = 0;
-        it->flops = 0;
-        it->count = 0;
-    }
+    lock_guard<mutex> lock(ProfileNode::rootsMutex());
+    for (auto& root : ProfileNode::roots()) root->clear();
 }
 
 void tic()
@@ -7,10 +7,11 @@
 
 #define PROFILE_SECTION(name) \
 { \
-static time::Timer __timer = time::Timer::(name); \
-__timer.start();
+aquarius::time::ProfileSection __timer(#name);
 
-#define PROFILE_FUNCTION PROFILE_SECTION(__func__)
+#define PROFILE_FUNCTION \
+{ \
+aquarius::time::ProfileSection __timer(__func__);
 
 #define PROFILE_STOP \
 __timer.stop(); \
@@ -46,6 +47,8 @@ class Timer;
 class Interval
 {
     friend class Timer;
+    friend class ProfileSection;
+    friend class LedgerScope;
     friend void do_flops(int64_t flops);
     friend Interval toc();
     friend Interval cputoc();
@@ -100,21 +103,19 @@ Interval cputoc();
 
 void do_flops(int64_t flops);
 
+/*
+ * Union of the keys on all processes in the arena.
+ */
+set<string> gatherKeys(const Arena& arena, const set<string>& keys);
+
 class Timer : public Interval
 {
     protected:
-        static vector<Timer> timers;
-
-        string name;
         int64_t count;
         CTF_Flop_Counter ctfflops;
 
-        Timer(const string& name) : name(name), count(0) {}
-
     public:
-        Timer() : name(), count(0) {}
-
-        static Timer& timer(const string& name);
+        Timer() : count(0) {}
 
         void start()
         {
@@ -124,28 +125,100 @@ class Timer : public Interval
 
         void stop()
         {
-            #ifdef _OPENMP
-            if (!omp_in_parallel())
-            {
-                *this += toc();//*omp_get_max_threads();
-                count++;
-                flops += ctfflops.count();
-            }
-            else
-            #pragma omp critical
-            #endif
-            {
-                *this += toc();
-                count++;
-                flops += ctfflops.count();
-            }
+            *this += toc();
+            count++;
+            flops += ctfflops.count();
         }
 
+        int64_t calls() const { return count; }
+
+        /*
+         * Print the call tree of profiled sections, with the minimum, average
+         * and maximum time over all processes in the arena.
+         */
         static void printTimers(const Arena& arena);
 
         static void clearTimers(const Arena& arena);
 };
 
+/*
+ * A node in the call tree of profiled sections. Each thread builds its own
+ * tree, so entering and leaving a section only synchronizes the first time
+ * on each thread; the trees are merged by path when they are printed.
+ */
+class ProfileNode
+{
+    friend class ProfileSection;
+    friend class Timer;
+
+    protected:
+        string name;
+        ProfileNode* parent;
+        map<string,unique_ptr<ProfileNode>> children;
+        double dt;
+        int64_t flops;
+        int64_t count;
+
+        struct Totals
+        {
+            double dt = 0;
+            int64_t flops = 0;
+            int64_t count = 0;
+        };
+
+        ProfileNode(const string& name, ProfileNode* parent)
+        : name(name), parent(parent), dt(0), flops(0), count(0) {}
+
+        ProfileNode& child(const string& name);
+
+        /*
+         * Add the totals of every section below this one to totals, keyed
+         * by path, leaving the tree itself untouched
+         */
+        void flatten(const string& path, map<string,Totals>& totals) const;
+
+        void clear();
+
+        /*
+         * Innermost open section on the calling thread, creating and
+         * registering the thread's tree on first use
+         */
+        static ProfileNode*& current();
+
+        /*
+         * The trees of all threads which have entered a section, which may
+         * only be used while holding rootsMutex()
+         */
+        static vector<unique_ptr<ProfileNode>>& roots();
+
+        static mutex& rootsMutex();
+};
+
+/*
+ * Times a section of code as a child of the innermost enclosing section on
+ * the same thread. The section ends when stop is called or when the object
+ * goes out of scope.
+ */
+class ProfileSection
+{
+    protected:
+        ProfileNode* node;
+        Timer timer;
+        bool running;
+
+    public:
+        ProfileSection(const string& name);
+
+        ~ProfileSection() { stop(); }
+
+        void stop();
+
+        /*
+         * Path of the innermost open section on the calling thread.
+         */
+        static string currentPath();
+};
+
 }
 }
 
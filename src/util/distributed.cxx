@@ -3,6 +3,29 @@
 namespace aquarius
 {
 
+Arena Arena::split(const vector<int>& sizes) const
+{
+    assert(aquarius::sum(sizes) == size);
+
+    for (auto it = subarenas->begin();it != subarenas->end();++it)
+    {
+        if (it->first == sizes)
+        {
+            subarenas->splice(subarenas->begin(), *subarenas, it);
+            return *subarenas->front().second;
+        }
+    }
+
+    int color = 0;
+    for (int first = 0;first+sizes[color] <= rank;first += sizes[color++]);
+
+    shared_ptr<Arena> sub(new Arena(comm_->split(color, rank)));
+    subarenas->emplace_front(sizes, sub);
+    if (subarenas->size() > MAX_SUBARENAS) subarenas->pop_back();
+
+    return *sub;
+}
+
 const Arena& world()
 {
     static Arena world_;
@@ -28,18 +28,22 @@ template <typename T> class SpinorbitalTensor;
 class Arena
 {
     protected:
-        //global_ptr<tCTF_World<float>> ctfs;
+        global_ptr<tCTF_World<float>> ctfs;
         global_ptr<tCTF_World<double>> ctfd;
         //global_ptr<tCTF_World<complex<float>>> ctfc;
-        //global_ptr<tCTF_World<complex<double>>> ctfz;
+        global_ptr<tCTF_World<complex<double>>> ctfz;
         shared_ptr<Intracomm> comm_;
+        shared_ptr<list<pair<vector<int>,shared_ptr<Arena>>>> subarenas;
 
     public:
         const int rank;
         const int size;
 
+        static const int MAX_SUBARENAS = 8;
+
         Arena(Intracomm&& comm)
-        : comm_(new Intracomm(move(comm))), rank(comm.rank), size(comm.size) {}
+        : comm_(new Intracomm(move(comm))), subarenas(new list<pair<vector<int>,shared_ptr<Arena>>>()),
+          rank(comm.rank), size(comm.size) {}
 
         Arena() : Arena(Intracomm::world()) {}
 
@@ -47,6 +51,17 @@ class Arena
 
         const Intracomm& comm() const { return *comm_; }
 
+        /*
+         * Split the arena into consecutive groups of processes with the given
+         * sizes and return the group containing this process. The last
+         * MAX_SUBARENAS partitions are cached along with their CTF worlds, so
+         * repeated splits are cheap; older ones are dropped, and their
+         * communicators freed once no tensor refers to them. Collective
+         * whenever the partition is not cached, which is the same on every
+         * process as long as all of them make the same sequence of splits.
+         */
+        Arena split(const vector<int>& sizes) const;
+
         template <typename T>
         tCTF_World<T>& ctf();
 
@@ -57,14 +72,12 @@ class Arena
         }
 };
 
-/*
 template <>
 inline tCTF_World<float>& Arena::ctf<float>()
 {
-    if (!ctfs) ctfs = new tCTF_World<float>(*comm_);
+    if (!ctfs) ctfs.set(new tCTF_World<float>(*comm_));
     return *ctfs;
 }
-*/
 
 template <>
 inline tCTF_World<double>& Arena::ctf<double>()
@@ -80,14 +93,14 @@ inline tCTF_World<complex<float>>& Arena::ctf<complex<float>>()
     if (!ctfc) ctfc = new tCTF_World<complex<float>>(*comm_);
     return *ctfc;
 }
+*/
 
 template <>
 inline tCTF_World<complex<double>>& Arena::ctf<complex<double>>()
 {
-    if (!ctfz) ctfz = new tCTF_World<complex<double>>(*comm_);
+    if (!ctfz) ctfz.set(new tCTF_World<complex<double>>(*comm_));
     return *ctfz;
 }
-*/
 
 class Distributed
 {
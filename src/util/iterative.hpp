@@ -2,6 +2,7 @@
 #define _AQUARIUS_UTIL_ITERATIVE_HPP_
 
 #include "time/time.hpp"
+#include "time/ledger.hpp"
 #include "task/task.hpp"
 
 #include "distributed.hpp"
@@ -23,6 +24,9 @@ class Iterative : public task::Task
         int iter_;
         int maxiter;
         int nsolution_;
+        bool mixed;
+        bool single_;
+        double single_convtol;
 
         static ConvergenceType getConvType(const input::Config& config)
         {
@@ -46,6 +50,61 @@ class Iterative : public task::Task
         }
 
     protected:
+        /*
+         * Save or load the iteration count, energies, and convergence, for
+         * use by derived tasks which checkpoint a converged solution
+         */
+        void saveIterations(const string& path, const Arena& arena)
+        {
+            if (arena.rank != 0) return;
+
+            ofstream ofs(path + ".iter", std::ios::binary);
+            ofs.write(reinterpret_cast<char*>(&iter_), sizeof(int));
+            ofs.write(reinterpret_cast<char*>(&nsolution_), sizeof(int));
+            ofs.write(reinterpret_cast<char*>(energy_.data()), sizeof(U)*nsolution_);
+            ofs.write(reinterpret_cast<char*>(conv_.data()), sizeof(double)*nsolution_);
+        }
+
+        bool loadIterations(const string& path, const Arena& arena)
+        {
+            int ok = 0;
+            int iter = 0, nsolution = 0;
+            vector<U> energy;
+            vector<double> conv;
+
+            if (arena.rank == 0)
+            {
+                ifstream ifs(path + ".iter", std::ios::binary);
+                ifs.read(reinterpret_cast<char*>(&iter), sizeof(int));
+                ifs.read(reinterpret_cast<char*>(&nsolution), sizeof(int));
+                if (ifs && nsolution > 0)
+                {
+                    energy.resize(nsolution);
+                    conv.resize(nsolution);
+                    ifs.read(reinterpret_cast<char*>(energy.data()), sizeof(U)*nsolution);
+                    ifs.read(reinterpret_cast<char*>(conv.data()), sizeof(double)*nsolution);
+                    ok = (bool)ifs;
+                }
+            }
+
+            arena.comm().Bcast(&ok, 1, 0);
+            if (!ok) return false;
+
+            arena.comm().Bcast(&iter, 1, 0);
+            arena.comm().Bcast(&nsolution, 1, 0);
+            energy.resize(nsolution);
+            conv.resize(nsolution);
+            arena.comm().Bcast(energy, 0);
+            arena.comm().Bcast(conv, 0);
+
+            iter_ = iter;
+            nsolution_ = nsolution;
+            energy_.swap(energy);
+            conv_.swap(conv);
+
+            return true;
+        }
+
         const ConvergenceType convtype;
 
         U& energy()
@@ -108,12 +167,44 @@ class Iterative : public task::Task
 
         virtual void iterate(const Arena& arena) = 0;
 
+        /*
+         * Save or load whatever is needed to continue iterating from the
+         * current point (amplitudes, DIIS history, ...). Tasks which do not
+         * override these are not checkpointed during the solve.
+         */
+        virtual bool saveState(const string& path, const Arena& arena) { return false; }
+
+        virtual bool loadState(const string& path, const Arena& arena) { return false; }
+
+        /*
+         * In a mixed precision solve, the first iterations are performed in
+         * single precision until the convergence reaches single_convergence,
+         * after which switchPrecision is called to copy the single precision
+         * solution into the double precision one, and iterations continue in
+         * double precision to full convergence.
+         */
+        bool isMixedPrecision() const
+        {
+            return mixed;
+        }
+
+        bool isSinglePrecision() const
+        {
+            return single_;
+        }
+
+        virtual void switchPrecision(const Arena& arena) {}
+
     public:
         Iterative(const string& name, input::Config& config)
         : Task(name, config),
           convtol(config.get<double>("convergence")),
           maxiter(config.get<int>("max_iterations")),
           nsolution_(0),
+          mixed(config.exists("mixed_precision") && config.get<bool>("mixed_precision")),
+          single_(false),
+          single_convtol(config.exists("single_convergence") ?
+                         config.get<double>("single_convergence") : 0.0),
           convtype(getConvType(config)) {}
 
         virtual ~Iterative() {}
@@ -129,12 +220,32 @@ class Iterative : public task::Task
             energy_.resize(nsolution);
             conv_.assign(nsolution, numeric_limits<double>::max());
 
-            for (iter_ = 1;iter_ <= maxiter && !isConverged();iter_++)
+            string state;
+            if (!dag.getCheckpointDirectory().empty() && dag.getCheckpointInterval() > 0)
+            {
+                state = dag.getCheckpointPath(*this) + ".state";
+            }
+
+            int first = 1;
+            single_ = mixed;
+            if (!state.empty() && dag.isCheckpointed(*this, state, arena) &&
+                loadIterations(state, arena) && loadState(state, arena))
+            {
+                first = iter_+1;
+                single_ = false;
+                log(arena) << "Resuming from iteration " << iter_ << endl;
+            }
+
+            for (iter_ = first;iter_ <= maxiter && !isConverged();iter_++)
             {
+                time::Ledger::setIteration(name, iter_);
+                time::ProfileSection section("iterate");
                 time::Timer timer;
                 timer.start();
                 iterate(arena);
                 timer.stop();
+                section.stop();
+                time::Ledger::setIteration(name, 0);
                 double dt = timer.seconds(arena);
 
                 log(arena) << "Iteration " << iter_ << " took " << fixed <<
@@ -155,6 +266,28 @@ class Iterative : public task::Task
                                       ", convergence = " << scientific << setprecision(3) << conv_[i] << endl;
                     }
                 }
+
+                if (single_ && *max_element(conv_.begin(), conv_.end()) < max(single_convtol, convtol))
+                {
+                    log(arena) << "Switching to double precision" << endl;
+                    switchPrecision(arena);
+                    single_ = false;
+                    conv_.assign(nsolution, numeric_limits<double>::max());
+                    continue;
+                }
+
+                if (!single_ && !state.empty() && iter_%dag.getCheckpointInterval() == 0 &&
+                    saveState(state, arena))
+                {
+                    saveIterations(state, arena);
+                    dag.markCheckpointed(*this, state, arena);
+                }
+            }
+
+            if (single_)
+            {
+                switchPrecision(arena);
+                single_ = false;
             }
 
             if (!isConverged())
@@ -24,12 +24,15 @@
 #include <locale>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <ostream>
 #include <random>
 #include <set>
 #include <sstream>
 #include <stack>
 #include <tuple>
+#include <typeinfo>
 #include <utility>
 #include <regex>
 #include <stdexcept>
@@ -49,6 +52,15 @@
 #define INSTANTIATE_SPECIALIZATIONS(name) \
 template class name<double>;
 
+/*
+ * For classes which are also needed in single precision (mixed precision
+ * solvers) and complex arithmetic (response and Green's function solvers)
+ */
+#define INSTANTIATE_ALL_SPECIALIZATIONS(name) \
+template class name<float>; \
+template class name<double>; \
+template class name<complex<double>>;
+
 #define INSTANTIATE_SPECIALIZATIONS_2(name,extra1) \
 template class name<double,extra1>;
 
@@ -113,10 +125,16 @@ namespace aquarius
 
     using std::unique_ptr;
     using std::shared_ptr;
+    using std::weak_ptr;
     using std::make_shared;
 
+    using std::mutex;
+    using std::recursive_mutex;
+    using std::lock_guard;
+
     using std::runtime_error;
     using std::logic_error;
+    using std::bad_alloc;
 
     using std::move;
     using std::forward;